@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+/*
+    Shared pieces of the benchmark scenarios (one source file per scenario)
+*/
+
+struct BenchOptions {
+    // Timed repetitions per measurement (0 = the scenario's default)
+    int iterations = 0;
+
+    // JPEG quality for scenarios that encode
+    float quality = 0.8f;
+};
+
+// Mean wall-clock milliseconds per call of work, after one untimed warm-up call
+double benchMeanMs(int iterations, const function<void()>& work);
+
+// Camera-like RGB frame: gradients, hard-edged blocks that move with the seed, and sensor noise
+void benchCameraFrame(int seed, int width, int height, vector<unsigned char>& rgb);
+
+// Scenarios; each prints its own table and returns the process exit code
+int benchYuv(const BenchOptions& options);
+int benchLoop(const BenchOptions& options);
+int benchCoroutine(const BenchOptions& options);
+int benchEncoded(const BenchOptions& options);
+int benchContent(const BenchOptions& options);
+
+// Runs the stand-in server that benchLoop starts in a child process (ollama_bench --stand-in <port>)
+int benchStandIn(int port);
@@ -0,0 +1,154 @@
+#include "Bench.h"
+
+#include <OllamaClient/OllamaContentEncoder.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+// Small deterministic generator, so every run encodes the same sets
+struct BenchRandom {
+    unsigned int state;
+
+    explicit BenchRandom(unsigned int seed) : state(seed * 2654435761u + 1u) {}
+
+    int next(int bound) {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<int>((state >> 8) % static_cast<unsigned int>(bound));
+    }
+};
+
+static void fillRect(vector<unsigned char>& pixels, int width, int height, int channels, int x0, int y0, int x1, int y1, const unsigned char* color) {
+    for (int y = max(0, y0); y < min(height, y1); y++) {
+        for (int x = max(0, x0); x < min(width, x1); x++) {
+            unsigned char* pixel = &pixels[(static_cast<size_t>(y) * width + x) * channels];
+            for (int c = 0; c < channels; c++) pixel[c] = color[c];
+        }
+    }
+}
+
+// Pen strokes on a white RGBA canvas, as from a drawing app; every sixth sketch has one red stroke
+static void makeSketch(int seed, int size, vector<unsigned char>& rgba) {
+    rgba.assign(static_cast<size_t>(size) * size * 4, 255);
+    BenchRandom random(seed);
+    const unsigned char ink[4] = { 30, 30, 30, 255 };
+    const unsigned char red[4] = { 200, 40, 40, 255 };
+
+    int strokes = 12 + random.next(12);
+    for (int s = 0; s < strokes; s++) {
+        const unsigned char* color = seed % 6 == 5 && s == 0 ? red : ink;
+        int x = random.next(size);
+        int y = random.next(size);
+        int segments = 20 + random.next(40);
+        for (int i = 0; i < segments; i++) {
+            int nx = min(size - 1, max(0, x + random.next(21) - 10));
+            int ny = min(size - 1, max(0, y + random.next(21) - 10));
+            for (int step = 0; step <= 8; step++) {
+                int px = x + (nx - x) * step / 8;
+                int py = y + (ny - y) * step / 8;
+                fillRect(rgba, size, size, 4, px - 1, py - 1, px + 2, py + 2, color);
+            }
+            x = nx;
+            y = ny;
+        }
+    }
+}
+
+// Window chrome, panels, buttons and lines of glyph-sized marks; every fourth one shows a photo
+static void makeScreenshot(int seed, int width, int height, vector<unsigned char>& rgb) {
+    rgb.assign(static_cast<size_t>(width) * height * 3, 244);
+    BenchRandom random(seed + 100);
+    const unsigned char titleBar[3] = { 45, 90, 160 };
+    const unsigned char panel[3] = { 226, 228, 232 };
+    const unsigned char text[3] = { 40, 40, 48 };
+    const unsigned char button[3] = { 70, 140, 90 };
+
+    fillRect(rgb, width, height, 3, 0, 0, width, 36, titleBar);
+    fillRect(rgb, width, height, 3, 0, 36, 260, height, panel);
+
+    for (int line = 0; line < (height - 60) / 22; line++) {
+        int y = 50 + line * 22;
+        int left = line % 5 == 0 ? 20 : 290;
+        int x = left + random.next(20);
+        int end = left == 20 ? 240 : width - 40 - random.next(300);
+        while (x < end) {
+            int glyph = 5 + random.next(4);
+            fillRect(rgb, width, height, 3, x, y + random.next(3), x + glyph, y + 11, text);
+            x += glyph + 2 + (random.next(6) == 0 ? 8 : 0);
+        }
+    }
+    for (int b = 0; b < 3; b++) {
+        int x = width - 140 * (b + 1);
+        fillRect(rgb, width, height, 3, x, height - 60, x + 120, height - 28, button);
+    }
+
+    if (seed % 4 == 3) {
+        vector<unsigned char> photo;
+        benchCameraFrame(seed, 480, 320, photo);
+        for (int y = 0; y < 320; y++) {
+            copy(&photo[static_cast<size_t>(y) * 480 * 3], &photo[static_cast<size_t>(y + 1) * 480 * 3],
+                &rgb[(static_cast<size_t>(y + 200) * width + 500) * 3]);
+        }
+    }
+}
+
+struct ContentSet {
+    const char* name;
+    int width;
+    int height;
+    int channels;
+    int count;
+    void (*make)(int seed, int width, int height, vector<unsigned char>& pixels);
+};
+
+static const ContentSet kSets[] = {
+    { "Sketches", 512, 512, 4, 12, [](int seed, int width, int, vector<unsigned char>& pixels) { makeSketch(seed, width, pixels); } },
+    { "Screenshots", 1280, 800, 3, 8, makeScreenshot },
+    { "Camera frames", 1280, 720, 3, 8, benchCameraFrame },
+};
+
+int benchContent(const BenchOptions& options) {
+    int iterations = options.iterations > 0 ? options.iterations : 3;
+    const OllamaContentFormat fixed[] = { OllamaContentFormat::ColorJpeg, OllamaContentFormat::GrayJpeg, OllamaContentFormat::Png };
+
+    printf("Mean per image at quality %.2f: payload before base64, encode time\n", options.quality);
+    printf("%-24s %-19s %-19s %-19s %s\n", "set", "color-jpeg", "gray-jpeg", "png", "content-aware");
+    for (const ContentSet& set : kSets) {
+        vector<vector<unsigned char>> images(set.count);
+        for (int i = 0; i < set.count; i++) {
+            set.make(i, set.width, set.height, images[i]);
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "%s, %dx%d", set.name, set.width, set.height);
+        printf("%-24s", label);
+
+        for (OllamaContentFormat format : fixed) {
+            size_t bytes = 0;
+            double ms = benchMeanMs(iterations, [&]() {
+                bytes = 0;
+                for (const vector<unsigned char>& image : images) {
+                    bytes += OllamaContentEncoder::encodeAs(OllamaPixelView(image.data(), set.width, set.height, set.channels), format, options.quality).size();
+                }
+            }) / set.count;
+
+            char cell[32];
+            snprintf(cell, sizeof(cell), "%.1f KB, %.1f ms", bytes / 1024.0 / set.count, ms);
+            printf(" %-19s", cell);
+        }
+
+        size_t bytes = 0;
+        int chosen[3] = { 0, 0, 0 };
+        double ms = benchMeanMs(iterations, [&]() {
+            bytes = 0;
+            fill(begin(chosen), end(chosen), 0);
+            for (const vector<unsigned char>& image : images) {
+                OllamaContentEncodeResult result = OllamaContentEncoder::encode(OllamaPixelView(image.data(), set.width, set.height, set.channels), options.quality);
+                bytes += result.bytes.size();
+                chosen[static_cast<int>(result.format)]++;
+            }
+        }) / set.count;
+        printf(" %.1f KB, %.1f ms (%d color JPEG, %d gray JPEG, %d PNG)\n", bytes / 1024.0 / set.count, ms, chosen[0], chosen[1], chosen[2]);
+    }
+    return 0;
+}
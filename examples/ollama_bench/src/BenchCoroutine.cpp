@@ -0,0 +1,133 @@
+#include "Bench.h"
+
+#include <OllamaClient/OllamaCoroutine.h>
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <thread>
+#include <cstdio>
+
+// Runs posted work in order on its own thread, like a loop thread or an app's main thread
+class BenchWorker {
+public:
+    BenchWorker() : mThread([this]() { run(); }) {}
+
+    ~BenchWorker() {
+        {
+            lock_guard<mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mWake.notify_one();
+        mThread.join();
+    }
+
+    void post(function<void()> work) {
+        {
+            lock_guard<mutex> lock(mMutex);
+            mQueue.push_back(move(work));
+        }
+        mWake.notify_one();
+    }
+
+private:
+    mutex mMutex;
+    condition_variable mWake;
+    deque<function<void()>> mQueue;
+    bool mStopping = false;
+    thread mThread;     // Last, so the queue exists before it starts
+
+    void run() {
+        for (;;) {
+            function<void()> work;
+            {
+                unique_lock<mutex> lock(mMutex);
+                mWake.wait(lock, [this]() { return mStopping || !mQueue.empty(); });
+                if (mQueue.empty()) {
+                    return;
+                }
+                work = move(mQueue.front());
+                mQueue.pop_front();
+            }
+            work();
+        }
+    }
+};
+
+// Awaits count requests in a row and adds up the result sizes
+static OllamaTask<size_t> awaitChain(int count, OllamaResultAwaitable::Starter start, OllamaExecutor executor) {
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        total += (co_await OllamaAwait::call(start, executor)).size();
+    }
+    co_return total;
+}
+
+// The same chain with plain callbacks: each completion hops to the executor and starts the next request
+static void callbackChain(int remaining, const OllamaResultAwaitable::Starter& start, const OllamaExecutor& executor, function<void()> done) {
+    start([remaining, &start, &executor, done](const string&, void*) {
+        executor([remaining, &start, &executor, done]() {
+            if (remaining > 1) {
+                callbackChain(remaining - 1, start, executor, done);
+            }
+            else {
+                done();
+            }
+        });
+    });
+}
+
+// Mean nanoseconds per request of a whole chain, awaited or with callbacks
+static double chainNs(int count, const OllamaResultAwaitable::Starter& start, const OllamaExecutor& executor, bool awaited) {
+    double ms = benchMeanMs(1, [&]() {
+        promise<void> finished;
+        if (awaited) {
+            awaitChain(count, start, executor).start([&finished](size_t) { finished.set_value(); });
+        }
+        else {
+            callbackChain(count, start, executor, [&finished]() { finished.set_value(); });
+        }
+        finished.get_future().wait();
+    });
+    return ms * 1e6 / count;
+}
+
+int benchCoroutine(const BenchOptions& options) {
+    BenchWorker completer;
+    BenchWorker resumer;
+
+    // The result is there before the await suspends, as with a cache hit
+    OllamaResultAwaitable::Starter immediate = [](OllamaClientBase::InferenceCallback callback) {
+        callback("ok", nullptr);
+    };
+
+    // Completed on one thread and resumed on another, as with a request on the event loop
+    // that resumes through OllamaResumeQueue or loop->post()
+    OllamaResultAwaitable::Starter onCompleter = [&completer](OllamaClientBase::InferenceCallback callback) {
+        completer.post([callback]() { callback("ok", nullptr); });
+    };
+    OllamaExecutor onResumer = [&resumer](function<void()> resume) {
+        resumer.post(move(resume));
+    };
+
+    int syncCount = options.iterations > 0 ? options.iterations : 1000000;
+    int crossCount = options.iterations > 0 ? options.iterations : 100000;
+
+    // A synchronous callback returns before the next call, so a loop is the callback equivalent
+    double syncCallbackNs = benchMeanMs(1, [&]() {
+        size_t total = 0;
+        for (int i = 0; i < syncCount; i++) {
+            immediate([&total](const string& result, void*) { total += result.size(); });
+        }
+    }) * 1e6 / syncCount;
+    double syncAwaitNs = chainNs(syncCount, immediate, nullptr, true);
+
+    double crossCallbackNs = chainNs(crossCount, onCompleter, onResumer, false);
+    double crossAwaitNs = chainNs(crossCount, onCompleter, onResumer, true);
+
+    printf("%-26s %12s %12s %12s\n", "completion", "callback ns", "await ns", "extra ns");
+    printf("%-26s %12.0f %12.0f %12.0f\n", "synchronous", syncCallbackNs, syncAwaitNs, syncAwaitNs - syncCallbackNs);
+    printf("%-26s %12.0f %12.0f %12.0f\n", "other thread, resume hop", crossCallbackNs, crossAwaitNs, crossAwaitNs - crossCallbackNs);
+    return 0;
+}
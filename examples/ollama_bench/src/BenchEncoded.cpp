@@ -0,0 +1,84 @@
+#include "Bench.h"
+
+#include <OllamaClient/OllamaClientBase.h>
+#include <OllamaClient/OllamaEncodedImage.h>
+#include <OllamaClient/OllamaJpeg.h>
+
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+
+static const int kFrameWidth = 1920;
+static const int kFrameHeight = 1080;
+static const int kFrameCount = 8;
+
+int benchEncoded(const BenchOptions& options) {
+    int iterations = options.iterations > 0 ? options.iterations : 20;
+
+    // Write the set to the working directory, as a camera or an earlier capture run would have
+    vector<string> paths;
+    vector<vector<unsigned char>> frames(kFrameCount);
+    size_t fileBytes = 0;
+    for (int i = 0; i < kFrameCount; i++) {
+        benchCameraFrame(i, kFrameWidth, kFrameHeight, frames[i]);
+        string jpeg = OllamaJpegEncoder::encode(OllamaPixelView(frames[i].data(), kFrameWidth, kFrameHeight, 3), options.quality);
+        string path = "ollama_bench_encoded_" + to_string(i) + ".jpg";
+        ofstream file(path, ios::binary);
+        file.write(jpeg.data(), jpeg.size());
+        if (!file) {
+            fprintf(stderr, "Could not write %s\n", path.c_str());
+            return 1;
+        }
+        paths.push_back(path);
+        fileBytes += jpeg.size();
+    }
+
+    // Each path goes from the file (or, for re-encoding, its decoded pixels) to the base64 text of the request
+    size_t payloadBytes = 0;
+    int failures = 0;
+    double readMs = benchMeanMs(iterations, [&]() {
+        payloadBytes = 0;
+        for (const string& path : paths) {
+            ifstream file(path, ios::binary);
+            string bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+            payloadBytes += OllamaClientBase::base64_encode(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size()).size();
+        }
+    }) / kFrameCount;
+
+    double mappedMs = benchMeanMs(iterations, [&]() {
+        for (const string& path : paths) {
+            OllamaMappedFile file(path);
+            OllamaEncodedImageInfo info;
+            if (!file.isOpen() || !OllamaEncodedImage::inspect(file.getData(), file.getSize(), info)) {
+                failures++;
+                continue;
+            }
+            OllamaClientBase::base64_encode(file.getData(), file.getSize());
+        }
+    }) / kFrameCount;
+
+    size_t reencodedBytes = 0;
+    double reencodeMs = benchMeanMs(iterations, [&]() {
+        reencodedBytes = 0;
+        for (const vector<unsigned char>& frame : frames) {
+            string jpeg = OllamaJpegEncoder::encode(OllamaPixelView(frame.data(), kFrameWidth, kFrameHeight, 3), options.quality);
+            reencodedBytes += OllamaClientBase::base64_encode(reinterpret_cast<const unsigned char*>(jpeg.data()), jpeg.size()).size();
+        }
+    }) / kFrameCount;
+
+    for (const string& path : paths) {
+        remove(path.c_str());
+    }
+    if (failures > 0) {
+        fprintf(stderr, "%d mapped files failed to open or inspect\n", failures);
+        return 1;
+    }
+
+    printf("%d camera JPEGs at %dx%d, %.1f KB each\n", kFrameCount, kFrameWidth, kFrameHeight, fileBytes / 1024.0 / kFrameCount);
+    printf("%-34s %10s %12s\n", "path", "ms/image", "payload KB");
+    printf("%-34s %10.2f %12.1f\n", "read + base64", readMs, payloadBytes / 1024.0 / kFrameCount);
+    printf("%-34s %10.2f %12.1f\n", "mapped + inspect + base64", mappedMs, payloadBytes / 1024.0 / kFrameCount);
+    printf("%-34s %10.2f %12.1f\n", "re-encode decoded pixels + base64", reencodeMs, reencodedBytes / 1024.0 / kFrameCount);
+    return 0;
+}
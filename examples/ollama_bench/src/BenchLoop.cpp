@@ -0,0 +1,208 @@
+#include "Bench.h"
+
+#include <OllamaClient/OllamaClientBase.h>
+#include <OllamaClient/OllamaEventLoop.h>
+#include <OllamaClient/OllamaStandInServer.h>
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <TlHelp32.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+
+static const int kStandInPort = 11439;
+static const double kStandInDelayMs = 300.0;
+
+// Text prompts only; the scenario never sends images
+class BenchClient : public OllamaClientBase {
+public:
+    using OllamaClientBase::OllamaClientBase;
+
+    string convertImageToBase64Jpeg(const void*, float) override { return ""; }
+
+    void sendImageForInference(const void*, const string&, InferenceCallback callback, void * userData) override {
+        callback(string(kErrorPrefix) + "images are not used by this benchmark", userData);
+    }
+
+    string sendImageForInferenceSync(const void*, const string&) override {
+        return string(kErrorPrefix) + "images are not used by this benchmark";
+    }
+};
+
+// Threads of this process right now
+static int processThreadCount() {
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) return 0;
+
+    DWORD processId = GetCurrentProcessId();
+    THREADENTRY32 entry = {};
+    entry.dwSize = sizeof(entry);
+    int count = 0;
+    for (BOOL more = Thread32First(snapshot, &entry); more; more = Thread32Next(snapshot, &entry)) {
+        if (entry.th32OwnerProcessID == processId) count++;
+    }
+    CloseHandle(snapshot);
+    return count;
+}
+
+static double workingSetMb() {
+    PROCESS_MEMORY_COUNTERS counters = {};
+    counters.cb = sizeof(counters);
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0.0;
+    return counters.WorkingSetSize / (1024.0 * 1024.0);
+}
+
+// User plus kernel time of this process
+static double processCpuMs() {
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0.0;
+
+    auto ticks = [](const FILETIME& time) {
+        return (static_cast<unsigned long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return (ticks(kernel) + ticks(user)) / 10000.0;
+}
+
+// The stand-in runs in its own process, so its thread per connection does not count against the client
+static bool startStandIn(PROCESS_INFORMATION& process) {
+    wchar_t path[MAX_PATH];
+    if (!GetModuleFileNameW(nullptr, path, MAX_PATH)) return false;
+
+    wstring commandLine = L"\"" + wstring(path) + L"\" --stand-in " + to_wstring(kStandInPort);
+    STARTUPINFOW startup = {};
+    startup.cb = sizeof(startup);
+    process = {};
+    return CreateProcessW(path, &commandLine[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &process) != FALSE;
+}
+
+static void stopStandIn(PROCESS_INFORMATION& process) {
+    TerminateProcess(process.hProcess, 0);
+    WaitForSingleObject(process.hProcess, INFINITE);
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+}
+
+struct LoopRun {
+    int succeeded = 0;
+    double wallMs = 0.0;
+    double cpuMs = 0.0;
+    int peakThreads = 0;
+    double addedMb = 0.0;   // Peak working set above the one before the first send
+};
+
+// Sends every prompt at once and samples the process until the last callback has run
+static LoopRun runConcurrent(OllamaClientBase& client, int requests) {
+    mutex lock;
+    condition_variable finished;
+    int done = 0;
+    LoopRun run;
+
+    double baseMb = workingSetMb();
+    double peakMb = baseMb;
+    double startCpu = processCpuMs();
+    auto start = chrono::steady_clock::now();
+
+    for (int i = 0; i < requests; i++) {
+        client.sendPrompt("ping", [&](const string& result, void*) {
+            lock_guard<mutex> guard(lock);
+            done++;
+            if (!OllamaClientBase::isErrorResult(result)) run.succeeded++;
+            finished.notify_all();
+        }, nullptr);
+    }
+
+    unique_lock<mutex> guard(lock);
+    while (done < requests) {
+        finished.wait_for(guard, chrono::milliseconds(10));
+        run.peakThreads = max(run.peakThreads, processThreadCount());
+        peakMb = max(peakMb, workingSetMb());
+    }
+    run.wallMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    run.cpuMs = processCpuMs() - startCpu;
+    run.addedMb = peakMb - baseMb;
+    return run;
+}
+
+int benchStandIn(int port) {
+    OllamaStandInServer server([](const string&, const string&, const string&) {
+        OllamaStandInServer::Response response;
+        response.chunks.push_back({ kStandInDelayMs, "{\"message\":{\"role\":\"assistant\",\"content\":\"ok\"},\"done\":true}" });
+        return response;
+    });
+    if (!server.start(port)) {
+        fprintf(stderr, "Could not listen on port %d\n", port);
+        return 1;
+    }
+
+    // Serves until the benchmark terminates this process
+    for (;;) {
+        this_thread::sleep_for(chrono::seconds(1));
+    }
+}
+
+int benchLoop(const BenchOptions&) {
+    const int levels[] = { 100, 1000 };
+    int loopThreads = 1;
+
+    PROCESS_INFORMATION standIn;
+    if (!startStandIn(standIn)) {
+        fprintf(stderr, "Could not start the stand-in server\n");
+        return 1;
+    }
+
+    // Wait until the stand-in answers
+    {
+        BenchClient probe("127.0.0.1", kStandInPort);
+        bool ready = false;
+        for (int attempt = 0; attempt < 50 && !ready; attempt++) {
+            ready = !OllamaClientBase::isErrorResult(probe.sendPromptSync("ping"));
+            if (!ready) this_thread::sleep_for(chrono::milliseconds(100));
+        }
+        if (!ready) {
+            fprintf(stderr, "The stand-in server did not answer on port %d\n", kStandInPort);
+            stopStandIn(standIn);
+            return 1;
+        }
+    }
+
+    printf("Each request is answered after %.0f ms by a stand-in server in a separate process\n", kStandInDelayMs);
+    printf("%-9s %-19s %6s %9s %8s %9s %8s %8s\n", "requests", "executor", "ok", "wall ms", "req/s", "CPU ms", "threads", "+MB");
+    for (int requests : levels) {
+        for (int mode = 0; mode < 2; mode++) {
+            BenchClient client("127.0.0.1", kStandInPort);
+            OllamaResilienceOptions resilience;
+            resilience.maxRetries = 0;
+            resilience.breakerFailureThreshold = 0;
+            client.setResilienceOptions(resilience);
+
+            string executor = "thread per request";
+            if (mode == 1) {
+                client.setEventLoop(make_shared<OllamaEventLoop>(loopThreads));
+                executor = "event loop x" + to_string(loopThreads);
+            }
+
+            LoopRun run = runConcurrent(client, requests);
+            printf("%-9d %-19s %6d %9.0f %8.0f %9.0f %8d %8.1f\n", requests, executor.c_str(), run.succeeded,
+                run.wallMs, requests * 1000.0 / run.wallMs, run.cpuMs, run.peakThreads, run.addedMb);
+
+            // Let finished request threads exit before the next run samples the process
+            client.setEventLoop(nullptr);
+            this_thread::sleep_for(chrono::milliseconds(500));
+        }
+    }
+
+    stopStandIn(standIn);
+    return 0;
+}
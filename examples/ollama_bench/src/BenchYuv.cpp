@@ -0,0 +1,110 @@
+#include "Bench.h"
+
+#include <OllamaClient/OllamaClientBase.h>
+#include <OllamaClient/OllamaJpeg.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+// Camera-like test frame: smooth gradients, a few hard edges and sensor noise, in video range
+static void makeNv12(int width, int height, vector<unsigned char>& y, vector<unsigned char>& uv) {
+    y.resize(static_cast<size_t>(width) * height);
+    uv.resize(static_cast<size_t>(width) * (height / 2));
+    unsigned int noise = 12345;
+
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            noise = noise * 1664525u + 1013904223u;
+            int value = 40 + 150 * col / width + 30 * row / height;
+            if ((col / 160 + row / 120) % 3 == 0) value += 25;
+            value += static_cast<int>(noise >> 28) - 8;
+            y[static_cast<size_t>(row) * width + col] = static_cast<unsigned char>(min(235, max(16, value)));
+        }
+    }
+    for (int row = 0; row < height / 2; row++) {
+        for (int col = 0; col < width / 2; col++) {
+            unsigned char* pair = &uv[static_cast<size_t>(row) * width + col * 2];
+            pair[0] = static_cast<unsigned char>(128 + 40 * col / (width / 2) - 20);
+            pair[1] = static_cast<unsigned char>(128 + 30 * row / (height / 2) - 15);
+        }
+    }
+}
+
+// The same frame as YUY2 (4:2:2, chroma repeated on both rows of each 4:2:0 pair)
+static void nv12ToYuy2(int width, int height, const vector<unsigned char>& y, const vector<unsigned char>& uv, vector<unsigned char>& yuy2) {
+    yuy2.resize(static_cast<size_t>(width) * height * 2);
+    for (int row = 0; row < height; row++) {
+        const unsigned char* luma = &y[static_cast<size_t>(row) * width];
+        const unsigned char* chroma = &uv[static_cast<size_t>(row / 2) * width];
+        unsigned char* out = &yuy2[static_cast<size_t>(row) * width * 2];
+        for (int col = 0; col < width; col += 2) {
+            out[0] = luma[col];
+            out[1] = chroma[col];
+            out[2] = luma[col + 1];
+            out[3] = chroma[col + 1];
+            out += 4;
+        }
+    }
+}
+
+// BT.601 video range to RGB in integer math, as capture code does before handing frames to an RGB encoder
+static void nv12ToRgb(int width, int height, const unsigned char* y, const unsigned char* uv, unsigned char* rgb) {
+    for (int row = 0; row < height; row++) {
+        const unsigned char* luma = y + static_cast<size_t>(row) * width;
+        const unsigned char* chroma = uv + static_cast<size_t>(row / 2) * width;
+        unsigned char* out = rgb + static_cast<size_t>(row) * width * 3;
+        for (int col = 0; col < width; col++) {
+            int c = 298 * (luma[col] - 16);
+            int d = chroma[col & ~1] - 128;
+            int e = chroma[col | 1] - 128;
+            out[0] = static_cast<unsigned char>(min(255, max(0, (c + 409 * e + 128) >> 8)));
+            out[1] = static_cast<unsigned char>(min(255, max(0, (c - 100 * d - 208 * e + 128) >> 8)));
+            out[2] = static_cast<unsigned char>(min(255, max(0, (c + 516 * d + 128) >> 8)));
+            out += 3;
+        }
+    }
+}
+
+int benchYuv(const BenchOptions& options) {
+    const int sizes[][2] = { { 1280, 720 }, { 1920, 1080 } };
+    int iterations = options.iterations > 0 ? options.iterations : 50;
+
+    printf("%-11s %-26s %10s %10s %10s\n", "frame", "path", "ms/frame", "KB", "vs RGB");
+    for (const auto& size : sizes) {
+        int width = size[0];
+        int height = size[1];
+        vector<unsigned char> y, uv, yuy2;
+        makeNv12(width, height, y, uv);
+        nv12ToYuy2(width, height, y, uv, yuy2);
+        vector<unsigned char> rgb(static_cast<size_t>(width) * height * 3);
+
+        // Each path goes from the camera buffer to the base64 text that goes into the request
+        string payload;
+        double convertMs = benchMeanMs(iterations, [&]() { nv12ToRgb(width, height, y.data(), uv.data(), rgb.data()); });
+        double rgbMs = benchMeanMs(iterations, [&]() {
+            nv12ToRgb(width, height, y.data(), uv.data(), rgb.data());
+            string jpeg = OllamaJpegEncoder::encode(OllamaPixelView(rgb.data(), width, height, 3), options.quality);
+            payload = OllamaClientBase::base64_encode(reinterpret_cast<const unsigned char*>(jpeg.data()), jpeg.size());
+        });
+        size_t rgbBytes = payload.size() * 3 / 4;
+
+        double nv12Ms = benchMeanMs(iterations, [&]() {
+            payload = OllamaClientBase::yuvToBase64Jpeg(OllamaYuvView::nv12(y.data(), uv.data(), width, height), options.quality);
+        });
+        size_t nv12Bytes = payload.size() * 3 / 4;
+
+        double yuy2Ms = benchMeanMs(iterations, [&]() {
+            payload = OllamaClientBase::yuvToBase64Jpeg(OllamaYuvView::yuy2(yuy2.data(), width, height), options.quality);
+        });
+        size_t yuy2Bytes = payload.size() * 3 / 4;
+
+        char frame[32];
+        snprintf(frame, sizeof(frame), "%dx%d", width, height);
+        printf("%-11s %-26s %10.2f %10s %10s\n", frame, "NV12 -> RGB (conversion)", convertMs, "", "");
+        printf("%-11s %-26s %10.2f %10.1f %9.2fx\n", frame, "NV12 -> RGB -> JPEG", rgbMs, rgbBytes / 1024.0, 1.0);
+        printf("%-11s %-26s %10.2f %10.1f %9.2fx\n", frame, "NV12 direct", nv12Ms, nv12Bytes / 1024.0, nv12Ms / rgbMs);
+        printf("%-11s %-26s %10.2f %10.1f %9.2fx\n", frame, "YUY2 direct", yuy2Ms, yuy2Bytes / 1024.0, yuy2Ms / rgbMs);
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "Bench.h"
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+struct BenchScenario {
+    const char* name;
+    const char* description;
+    int (*run)(const BenchOptions& options);
+};
+
+static const BenchScenario kScenarios[] = {
+    { "yuv", "Per-frame time of direct YUV encoding vs NV12 -> RGB -> JPEG at 720p and 1080p", benchYuv },
+    { "loop", "Threads, memory and CPU of thread-per-request vs the event loop at 100 and 1,000 concurrent prompts", benchLoop },
+    { "await", "Per-request overhead of co_await against a plain callback, completed inline and on another thread", benchCoroutine },
+    { "content", "Payload size and encode time of color JPEG, gray JPEG, PNG and content-aware encoding on three image sets", benchContent },
+    { "encoded", "Sending 1080p JPEG files as stored (read or mapped) vs encoding their pixels again", benchEncoded },
+};
+
+double benchMeanMs(int iterations, const function<void()>& work) {
+    work();
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        work();
+    }
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / max(1, iterations);
+}
+
+void benchCameraFrame(int seed, int width, int height, vector<unsigned char>& rgb) {
+    rgb.resize(static_cast<size_t>(width) * height * 3);
+    unsigned int noise = 12345u + seed;
+
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            noise = noise * 1664525u + 1013904223u;
+            int grain = static_cast<int>(noise >> 28) - 8;
+            int block = ((col + seed * 40) / 160 + row / 120) % 3 == 0 ? 30 : 0;
+            unsigned char* pixel = &rgb[(static_cast<size_t>(row) * width + col) * 3];
+            pixel[0] = static_cast<unsigned char>(min(255, max(0, 60 + 140 * col / width + block + grain)));
+            pixel[1] = static_cast<unsigned char>(min(255, max(0, 50 + 120 * row / height + block / 2 + grain)));
+            pixel[2] = static_cast<unsigned char>(min(255, max(0, 90 + 60 * (col + row) / (width + height) + grain)));
+        }
+    }
+}
+
+static void printUsage() {
+    cout << "Usage: ollama_bench <scenario>... [options]\n"
+        << "  --iterations <n>       Timed repetitions per measurement (default depends on the scenario)\n"
+        << "  --quality <q>          JPEG quality from 0 to 1 (default 0.8)\n"
+        << "\nScenarios:\n";
+    for (const BenchScenario& scenario : kScenarios) {
+        cout << "  " << scenario.name << string(23 - string(scenario.name).size(), ' ') << scenario.description << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    vector<const BenchScenario*> selected;
+
+    if (argc == 3 && string(argv[1]) == "--stand-in") {
+        return benchStandIn(atoi(argv[2]));
+    }
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--help" || arg == "-h") { printUsage(); return 0; }
+
+        if (arg.compare(0, 2, "--") != 0) {
+            const BenchScenario* match = nullptr;
+            for (const BenchScenario& scenario : kScenarios) {
+                if (arg == scenario.name) match = &scenario;
+            }
+            if (!match) { printUsage(); return 1; }
+            selected.push_back(match);
+            continue;
+        }
+
+        if (value.empty()) { printUsage(); return 1; }
+        i++;
+        if (arg == "--iterations") options.iterations = atoi(value.c_str());
+        else if (arg == "--quality") options.quality = static_cast<float>(atof(value.c_str()));
+        else { printUsage(); return 1; }
+    }
+
+    if (selected.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    int exitCode = 0;
+    for (const BenchScenario* scenario : selected) {
+        cout << "== " << scenario->name << ": " << scenario->description << endl;
+        exitCode = max(exitCode, scenario->run(options));
+        cout << endl;
+    }
+    return exitCode;
+}
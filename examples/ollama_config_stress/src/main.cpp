@@ -0,0 +1,178 @@
+#include <OllamaClient/OllamaClientBase.h>
+#include <OllamaClient/OllamaStandInServer.h>
+#include <OllamaClient/OllamaEventLoop.h>
+#include <OllamaClient/OllamaJson.h>
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+
+/*
+    Stress test for the client configuration snapshots
+
+    Two stand-in servers each accept only requests built from their own
+    snapshot: its model, its token limit and its backend (Ollama on one,
+    OpenAI-compatible on the other). While the configuration flips between
+    them, worker threads send sync requests, an event loop sends async ones
+    and another thread keeps calling the individual setters. A request that
+    mixes two snapshots, or a lost or failed request, fails the run.
+    The exit code is 0 only if every request was consistent.
+*/
+
+// Text-only client; images are not part of this test
+class OllamaClientHeadless : public OllamaClientBase {
+public:
+    using OllamaClientBase::OllamaClientBase;
+
+    string convertImageToBase64Jpeg(const void*, float) override { return ""; }
+    void sendImageForInference(const void*, const string&, InferenceCallback callback, void * userData) override {
+        callback("Error: Images are not supported", userData);
+    }
+    string sendImageForInferenceSync(const void*, const string&) override { return "Error: Images are not supported"; }
+};
+
+static void printUsage() {
+    cout << "Usage: ollama_config_stress [options]\n"
+        << "  --threads <n>          Threads sending sync requests (default 8)\n"
+        << "  --requests <n>         Sync requests per thread (default 150)\n"
+        << "  --async <n>            Requests sent through the event loop (default 1200)\n"
+        << "  --loop-threads <n>     Event loop threads (default 2)\n";
+}
+
+int main(int argc, char* argv[]) {
+    int threads = 8;
+    int requestsPerThread = 150;
+    int asyncRequests = 1200;
+    int loopThreads = 2;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--help" || arg == "-h" || value.empty()) { printUsage(); return arg == "--help" || arg == "-h" ? 0 : 1; }
+
+        i++;
+        if (arg == "--threads") threads = atoi(value.c_str());
+        else if (arg == "--requests") requestsPerThread = atoi(value.c_str());
+        else if (arg == "--async") asyncRequests = atoi(value.c_str());
+        else if (arg == "--loop-threads") loopThreads = atoi(value.c_str());
+        else { printUsage(); return 1; }
+    }
+
+    // Server id accepts model "m<id>" with a token limit of id + 1, in its own backend's format
+    atomic<int> mixed{ 0 };
+    atomic<int> served[2] = { { 0 }, { 0 } };
+    auto makeHandler = [&mixed, &served](int id) {
+        return [&mixed, &served, id](const string&, const string&, const string& body) {
+            string model;
+            double limit = -1.0;
+            OllamaJson::findString(body, "model", model);
+            OllamaJson::findNumber(body, id == 0 ? "num_predict" : "max_tokens", limit);
+            if (model != "m" + to_string(id) || static_cast<int>(limit) != id + 1) {
+                mixed++;
+            }
+            served[id]++;
+
+            OllamaStandInServer::Response response;
+            response.chunks.push_back({ 0.0, id == 0 ? "{\"message\":{\"role\":\"assistant\",\"content\":\"ok\"},\"done\":true}"
+                : "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"ok\"}}]}" });
+            return response;
+        };
+    };
+
+    OllamaStandInServer server0(makeHandler(0));
+    OllamaStandInServer server1(makeHandler(1));
+    if (!server0.start() || !server1.start()) {
+        cerr << "Could not start the stand-in servers" << endl;
+        return 1;
+    }
+
+    OllamaClientConfig configs[2];
+    for (int id = 0; id < 2; id++) {
+        configs[id].host = "127.0.0.1";
+        configs[id].port = id == 0 ? server0.getPort() : server1.getPort();
+        configs[id].chatModel = "m" + to_string(id);
+        configs[id].visionModel = configs[id].chatModel;
+        configs[id].options.numPredict = id + 1;
+        configs[id].backend = id == 0 ? shared_ptr<OllamaBackend>(make_shared<OllamaChatBackend>()) : make_shared<OllamaOpenAIBackend>();
+    }
+
+    OllamaResilienceOptions resilience;
+    resilience.maxInFlight = 0;
+    resilience.breakerFailureThreshold = 0;
+
+    OllamaClientHeadless syncClient("127.0.0.1", server0.getPort());
+    syncClient.setResilienceOptions(resilience);
+    syncClient.setConfig(configs[0]);
+
+    shared_ptr<OllamaEventLoop> loop = make_shared<OllamaEventLoop>(loopThreads);
+    OllamaClientHeadless asyncClient("127.0.0.1", server0.getPort());
+    asyncClient.setResilienceOptions(resilience);
+    asyncClient.setEventLoop(loop);
+    asyncClient.setConfig(configs[0]);
+
+    // Whole snapshots flip while single setters race them (text requests use the chat model, so the vision model is free)
+    atomic<bool> stop{ false };
+    atomic<int> flips{ 0 };
+    thread flipper([&]() {
+        for (int i = 1; !stop; i++) {
+            syncClient.setConfig(configs[i % 2]);
+            asyncClient.setConfig(configs[i % 2]);
+            flips++;
+            this_thread::yield();
+        }
+    });
+    thread setter([&]() {
+        for (int i = 0; !stop; i++) {
+            syncClient.setVisionModel("v" + to_string(i));
+            asyncClient.setVisionModel(syncClient.getVisionModel());
+            this_thread::yield();
+        }
+    });
+
+    atomic<int> failed{ 0 };
+    atomic<int> pending{ asyncRequests };
+    for (int i = 0; i < asyncRequests; i++) {
+        asyncClient.sendPrompt("hi", [&failed, &pending](const string& result, void*) {
+            if (result != "ok") {
+                failed++;
+            }
+            pending--;
+        }, nullptr);
+    }
+
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < requestsPerThread; i++) {
+                if (syncClient.sendPromptSync("hi") != "ok") {
+                    failed++;
+                }
+            }
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    while (pending > 0) {
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+
+    stop = true;
+    flipper.join();
+    setter.join();
+    loop->stop();
+    server0.stop();
+    server1.stop();
+
+    int total = threads * requestsPerThread + asyncRequests;
+    cout << "Requests:        " << total << " (" << threads * requestsPerThread << " sync, " << asyncRequests << " event loop)" << endl;
+    cout << "Served:          " << served[0] << " / " << served[1] << endl;
+    cout << "Config flips:    " << flips << endl;
+    cout << "Mixed snapshots: " << mixed << endl;
+    cout << "Failed:          " << failed << endl;
+
+    bool passed = mixed == 0 && failed == 0 && served[0] + served[1] == total;
+    cout << (passed ? "PASSED" : "FAILED") << endl;
+    return passed ? 0 : 1;
+}
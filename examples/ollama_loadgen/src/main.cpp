@@ -0,0 +1,166 @@
+#include <OllamaClient/OllamaClientBase.h>
+#include <OllamaClient/OllamaLoadTest.h>
+#include <OllamaClient/OllamaEventLoop.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+// Client without a framework; the load generator sends prebuilt request bodies, images go in as OllamaPixelView
+class OllamaClientHeadless : public OllamaClientBase {
+public:
+    using OllamaClientBase::OllamaClientBase;
+
+    string convertImageToBase64Jpeg(const void* imageData, float jpegQuality = 0.8f) override {
+        return encodePixelViewToBase64Jpeg(*static_cast<const OllamaPixelView*>(imageData), jpegQuality);
+    }
+
+    // Encodes on the calling thread, so the caller's buffer is free again on return
+    void sendImageForInference(const void* imageData, const string& prompt, InferenceCallback callback, void * userData) override {
+        sendRawRequest(buildRequestPayload(prompt, convertImageToBase64Jpeg(imageData)), callback, userData);
+    }
+
+    string sendImageForInferenceSync(const void* imageData, const string& prompt) override {
+        return sendImageForInferenceInternal(convertImageToBase64Jpeg(imageData), prompt);
+    }
+};
+
+static vector<double> parseList(const string& text) {
+    vector<double> values;
+    stringstream list(text);
+    string item;
+    while (getline(list, item, ',')) {
+        if (!item.empty()) {
+            values.push_back(atof(item.c_str()));
+        }
+    }
+    return values;
+}
+
+static void printUsage() {
+    cout << "Usage: ollama_loadgen [options]\n"
+        << "  --host <name>          Ollama host (default localhost)\n"
+        << "  --port <n>             Ollama port (default 11434)\n"
+        << "  --mock                 Run against a local stand-in that emulates Ollama's timing\n"
+        << "  --mock-parallel <n>    Requests the stand-in processes at once (default 4)\n"
+        << "  --model <name>         Chat model (default llama3)\n"
+        << "  --vision-model <name>  Vision model (default granite3.2-vision)\n"
+        << "  --prompt <text>        Prompt for every request\n"
+        << "  --image <file>         Also run every scenario with this image attached\n"
+        << "  --rates <list>         Open-loop arrival rates in requests/s (default 0.5,1,2,4)\n"
+        << "  --users <list>         Closed-loop scenarios with this many requests in flight\n"
+        << "  --duration <s>         Seconds per scenario (default 30)\n"
+        << "  --warmup <s>           Seconds at the start of a scenario that are not measured (default 5)\n"
+        << "  --uniform              Evenly spaced arrivals instead of a Poisson process\n"
+        << "  --event-loop <n>       Send through an event loop with n threads instead of a thread per request\n"
+        << "  --max-in-flight <n>    Client in-flight limit (default 256)\n";
+}
+
+int main(int argc, char* argv[]) {
+    string host = "localhost";
+    int port = 11434;
+    bool mock = false;
+    OllamaMockServerOptions mockOptions;
+    string chatModel = "llama3";
+    string visionModel = "granite3.2-vision";
+    OllamaLoadScenario base;
+    string imagePath;
+    vector<double> rates = { 0.5, 1.0, 2.0, 4.0 };
+    vector<double> users;
+    int loopThreads = 0;
+    int maxInFlight = 256;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--mock") { mock = true; continue; }
+        if (arg == "--uniform") { base.poisson = false; continue; }
+        if (arg == "--help" || arg == "-h" || value.empty()) { printUsage(); return arg == "--help" || arg == "-h" ? 0 : 1; }
+
+        i++;
+        if (arg == "--host") host = value;
+        else if (arg == "--port") port = atoi(value.c_str());
+        else if (arg == "--mock-parallel") mockOptions.parallel = atoi(value.c_str());
+        else if (arg == "--model") chatModel = value;
+        else if (arg == "--vision-model") visionModel = value;
+        else if (arg == "--prompt") base.prompt = value;
+        else if (arg == "--image") imagePath = value;
+        else if (arg == "--rates") rates = parseList(value);
+        else if (arg == "--users") users = parseList(value);
+        else if (arg == "--duration") base.durationSec = atof(value.c_str());
+        else if (arg == "--warmup") base.warmupSec = atof(value.c_str());
+        else if (arg == "--event-loop") loopThreads = atoi(value.c_str());
+        else if (arg == "--max-in-flight") maxInFlight = atoi(value.c_str());
+        else { printUsage(); return 1; }
+    }
+
+    OllamaStandInServer server(OllamaLoadGenerator::makeMockHandler(mockOptions));
+    if (mock) {
+        if (!server.start()) {
+            cerr << "Could not start the stand-in server" << endl;
+            return 1;
+        }
+        host = "127.0.0.1";
+        port = server.getPort();
+        cout << "Stand-in server on port " << port << " (" << mockOptions.parallel << " parallel)" << endl;
+    }
+
+    OllamaClientHeadless client(host, port, visionModel, chatModel);
+    OllamaResilienceOptions resilience;
+    resilience.maxInFlight = maxInFlight;
+    client.setResilienceOptions(resilience);
+    if (loopThreads > 0) {
+        client.setEventLoop(make_shared<OllamaEventLoop>(loopThreads));
+    }
+
+    string base64Image;
+    if (!imagePath.empty()) {
+        ifstream file(imagePath, ios::binary);
+        string bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        if (bytes.empty()) {
+            cerr << "Could not read " << imagePath << endl;
+            return 1;
+        }
+        base64Image = OllamaClientBase::base64_encode(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size());
+    }
+
+    // Every rate and user count, as text and (with --image) as image requests
+    vector<OllamaLoadScenario> scenarios;
+    for (int withImage = 0; withImage < (base64Image.empty() ? 1 : 2); withImage++) {
+        string kind = withImage ? "image" : "text";
+        for (double rate : rates) {
+            OllamaLoadScenario scenario = base;
+            ostringstream name;
+            name << kind << " @" << rate << "/s";
+            scenario.name = name.str();
+            scenario.ratePerSecond = rate;
+            scenario.base64Image = withImage ? base64Image : "";
+            scenarios.push_back(scenario);
+        }
+        for (double count : users) {
+            OllamaLoadScenario scenario = base;
+            ostringstream name;
+            name << kind << " x" << static_cast<int>(count) << " users";
+            scenario.name = name.str();
+            scenario.ratePerSecond = 0.0;
+            scenario.concurrency = static_cast<int>(count);
+            scenario.base64Image = withImage ? base64Image : "";
+            scenarios.push_back(scenario);
+        }
+    }
+
+    vector<OllamaLoadReport> reports;
+    for (const OllamaLoadScenario& scenario : scenarios) {
+        cout << "Running " << scenario.name << " for " << scenario.durationSec << " s..." << endl;
+        reports.push_back(OllamaLoadGenerator::run(client, scenario));
+    }
+
+    cout << endl << OllamaLoadGenerator::formatTable(reports);
+
+    if (OllamaEventLoop* loop = client.getEventLoop().get()) {
+        loop->stop();
+    }
+    server.stop();
+    return 0;
+}
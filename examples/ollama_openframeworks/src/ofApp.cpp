@@ -20,6 +20,10 @@ void ofApp::setup() {
     //font.load("arial.ttf", 14);
 
     // Initialize Ollama client (default: localhost:11434, llava:7b)
+    // The canvas holds a line drawing on white: send it as PNG or single-channel JPEG, whichever is smaller
+    OllamaContentEncodingOptions content;
+    content.enabled = true;
+    ollama.setContentEncodingOptions(content);
     ofLogNotice() << "OllamaClient initialized";
     ofLogNotice() << "Draw with mouse, press SPACE to analyze, C to clear";
 }
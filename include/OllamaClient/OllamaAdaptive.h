@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <chrono>
+
+using namespace std;
+
+/*
+    Closed-loop JPEG quality and resolution control for live frames
+
+    Each request reports its end-to-end latency (encoding included) and payload
+    size. The controller smooths the latency and moves along a ladder of
+    operating points to keep it under the target:
+
+    level 0            maxQuality at maxScale
+    ...                quality lowered by qualityStep down to minQuality
+    ...                then the resolution scaled by scaleStep down to minScale
+
+    It steps down as soon as the smoothed latency exceeds the target, and steps
+    up only once it has stayed below target * (1 - hysteresis). After every
+    change it waits for fresh measurements at the new point (downgradeSamples
+    before stepping down again, the longer upgradeSamples before stepping up),
+    so it settles instead of oscillating. A level that had to be left again
+    right after stepping up to it doubles its upgrade wait (up to 32x), so a
+    budget that sits between two levels is not probed over and over. Results
+    of requests encoded at an older point are recorded in the history but do
+    not drive decisions.
+
+    Usage:
+    OllamaAdaptiveOptions adaptive;
+    adaptive.enabled = true;
+    adaptive.targetLatencyMs = 800.0;
+    client.setAdaptiveOptions(adaptive);
+
+    OllamaOperatingPoint point = client.getOperatingPoint();
+    cout << point.quality << " @ " << point.scale << "x, " << point.smoothedLatencyMs << " ms" << endl;
+*/
+
+struct OllamaAdaptiveOptions {
+    bool enabled = false;
+
+    // Latency budget per frame, from encoding to the parsed answer
+    double targetLatencyMs = 1000.0;
+
+    // Quality bounds on the 0-1 encoder scale
+    float maxQuality = 0.9f;
+    float minQuality = 0.4f;
+    float qualityStep = 0.1f;
+
+    // Resolution bounds as a fraction of the frame size; each step multiplies by scaleStep
+    float maxScale = 1.0f;
+    float minScale = 0.25f;
+    float scaleStep = 0.75f;
+
+    // Step up only below targetLatencyMs * (1 - hysteresis)
+    double hysteresis = 0.25;
+
+    // Weight of the newest sample in the smoothed latency
+    double smoothing = 0.3;
+
+    // Samples at the current point needed before the next step down / up
+    int downgradeSamples = 3;
+    int upgradeSamples = 10;
+
+    // Samples kept in the history
+    size_t historySize = 200;
+};
+
+// Current settings and the measurements behind them
+struct OllamaOperatingPoint {
+    int level = 0;                      // 0 = best quality, grows as the controller backs off
+    float quality = 0.9f;
+    float scale = 1.0f;
+
+    double smoothedLatencyMs = 0.0;     // 0 until the first sample at this point
+    double meanPayloadBytes = 0.0;      // Encoded image size at this point (base64)
+    int samples = 0;                    // Samples measured at this point
+    unsigned long long changes = 0;     // Steps taken so far (also tells points at the same level apart)
+};
+
+struct OllamaAdaptiveSample {
+    double timeMs = 0.0;                // Since the controller was created or reset
+    int level = 0;
+    float quality = 0.0f;
+    float scale = 0.0f;
+    size_t payloadBytes = 0;
+    double latencyMs = 0.0;
+    double smoothedLatencyMs = 0.0;     // Controller state after this sample
+};
+
+class OllamaAdaptiveController {
+public:
+    OllamaAdaptiveController();
+
+    // Changing the options restarts at the best point
+    void setOptions(const OllamaAdaptiveOptions& options);
+    OllamaAdaptiveOptions getOptions();
+
+    // Point to encode the next frame with (false if disabled)
+    bool acquire(OllamaOperatingPoint& point);
+
+    // Measurement of a request encoded at point
+    void record(const OllamaOperatingPoint& point, size_t payloadBytes, double latencyMs);
+
+    OllamaOperatingPoint getOperatingPoint();
+    vector<OllamaAdaptiveSample> getHistory();
+    void reset();
+
+    // Quality and scale of a ladder level (clamped to the last level)
+    static void levelToSettings(const OllamaAdaptiveOptions& options, int level, float& quality, float& scale);
+    static int getLevelCount(const OllamaAdaptiveOptions& options);
+
+private:
+    mutex mMutex;
+    OllamaAdaptiveOptions mOptions;
+    OllamaOperatingPoint mPoint;
+    deque<OllamaAdaptiveSample> mHistory;
+    chrono::steady_clock::time_point mStart;
+
+    // Upgrade wait multiplier per level and whether the last step went up
+    vector<int> mUpgradeBackoff;
+    bool mSteppedUp = false;
+
+    void moveTo(int level);
+};
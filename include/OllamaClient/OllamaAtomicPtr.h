@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <utility>
+
+using namespace std;
+
+/*
+    shared_ptr that one thread can replace while others read it
+    Used for the client's configuration, trace recorder and event loop
+
+    Built on atomic<shared_ptr<T>> where the standard library has it (C++20)
+    and on a mutex otherwise; the atomic_load / atomic_store overloads for
+    shared_ptr are deprecated in C++20. A replaced value is released after the
+    swap, so its destructor (closing a trace, joining loop threads) never
+    runs under the lock.
+*/
+
+template<typename T>
+class OllamaAtomicPtr {
+public:
+    OllamaAtomicPtr() = default;
+    explicit OllamaAtomicPtr(shared_ptr<T> value) : mValue(move(value)) {}
+    OllamaAtomicPtr(const OllamaAtomicPtr&) = delete;
+    OllamaAtomicPtr& operator=(const OllamaAtomicPtr&) = delete;
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+    shared_ptr<T> load() const {
+        return mValue.load();
+    }
+
+    void store(shared_ptr<T> value) {
+        shared_ptr<T> previous = mValue.exchange(move(value));
+    }
+
+    // Stores desired if the value is still expected; otherwise expected receives the current value
+    bool compareExchange(shared_ptr<T>& expected, shared_ptr<T> desired) {
+        return mValue.compare_exchange_strong(expected, move(desired));
+    }
+
+private:
+    atomic<shared_ptr<T>> mValue;
+#else
+    shared_ptr<T> load() const {
+        lock_guard<mutex> lock(mMutex);
+        return mValue;
+    }
+
+    void store(shared_ptr<T> value) {
+        lock_guard<mutex> lock(mMutex);
+        mValue.swap(value);
+    }
+
+    // Stores desired if the value is still expected; otherwise expected receives the current value
+    bool compareExchange(shared_ptr<T>& expected, shared_ptr<T> desired) {
+        shared_ptr<T> stale;
+        lock_guard<mutex> lock(mMutex);
+        if (mValue != expected) {
+            stale = move(expected);
+            expected = mValue;
+            return false;
+        }
+        mValue.swap(desired);
+        return true;
+    }
+
+private:
+    mutable mutex mMutex;
+    shared_ptr<T> mValue;
+#endif
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include "OllamaOptions.h"
+
+using namespace std;
+
+/*
+    Server backends: where requests go, how they are built and how answers are read
+
+    OllamaChatBackend   - Ollama's /api/chat (the default)
+    OllamaOpenAIBackend - OpenAI-compatible /v1/chat/completions, e.g. llama.cpp's llama-server
+
+    For llama-server the OpenAI backend also sends llama.cpp's prompt cache
+    extensions. cache_prompt lets a slot reuse the KV cache of the prompt
+    prefix it processed last. With slotCount set, requests that start with the
+    same text (a repeated system prompt, or the history of one session) are
+    pinned with id_slot to the slot that last processed that prefix, so they
+    land where it is still cached. A new prefix goes to the slot that was used
+    least recently, evicting whatever it held. Pinning trades parallelism for
+    cache hits: requests with the same prefix wait for their slot even when
+    another one is idle.
+
+    Cache hits are counted from the timings llama-server returns (cache_n,
+    prompt_n, prompt_ms), or from usage.prompt_tokens_details.cached_tokens
+    on other OpenAI-compatible servers (without the time saved).
+
+    Usage:
+    OllamaOpenAIOptions openai;
+    openai.slotCount = 4;                       // llama-server --parallel 4
+    client.setBackend(make_shared<OllamaOpenAIBackend>(openai));
+
+    OllamaPromptCacheStats stats = client.getBackend()->getPromptCacheStats();
+    cout << stats.getTokenHitRate() * 100 << "% of prompt tokens cached, " << stats.getSavedMs() << " ms saved" << endl;
+*/
+
+struct OllamaPromptCacheStats {
+    unsigned long long responses = 0;           // Responses that reported prompt processing
+    unsigned long long cacheHits = 0;           // ... of which reused at least one cached token
+    unsigned long long cachedTokens = 0;        // Prompt tokens taken from the cache
+    unsigned long long evaluatedTokens = 0;     // Prompt tokens the server had to process
+    double promptEvalMs = 0.0;                  // Time spent processing them
+
+    // Processing time the cached tokens would have cost, at each response's own per-token rate
+    double savedMs = 0.0;
+
+    double getHitRate() const { return responses > 0 ? static_cast<double>(cacheHits) / responses : 0.0; }
+    double getTokenHitRate() const {
+        return cachedTokens + evaluatedTokens > 0 ? static_cast<double>(cachedTokens) / (cachedTokens + evaluatedTokens) : 0.0;
+    }
+    double getSavedMs() const { return savedMs; }
+};
+
+class OllamaBackend {
+public:
+    virtual ~OllamaBackend() = default;
+
+    // Request path, e.g. "/api/chat"
+    virtual string getEndpoint() const = 0;
+
+    // Request body for one user message (base64Image may be empty for text-only prompts)
+    virtual string buildChatPayload(const string& model, const string& prompt, const string& base64Image, const OllamaOptions& options) = 0;
+
+    // Message content of a response body, or "Error: ..."
+    virtual string parseResponseContent(const string& response) = 0;
+
+    // Prompt cache statistics (all zero if the server does not report them)
+    virtual OllamaPromptCacheStats getPromptCacheStats() { return OllamaPromptCacheStats(); }
+    virtual void resetPromptCacheStats() {}
+};
+
+class OllamaChatBackend : public OllamaBackend {
+public:
+    string getEndpoint() const override { return "/api/chat"; }
+    string buildChatPayload(const string& model, const string& prompt, const string& base64Image, const OllamaOptions& options) override;
+    string parseResponseContent(const string& response) override;
+};
+
+struct OllamaOpenAIOptions {
+    string endpoint = "/v1/chat/completions";
+
+    // llama.cpp extensions (turn off for other OpenAI-compatible servers)
+    bool cachePrompt = true;
+
+    // Slots of the server (llama-server --parallel); 0 = let the server pick a slot
+    int slotCount = 0;
+
+    // Leading prompt characters that decide the slot; requests that share them share a slot
+    size_t affinityPrefixChars = 256;
+};
+
+class OllamaOpenAIBackend : public OllamaBackend {
+public:
+    explicit OllamaOpenAIBackend(const OllamaOpenAIOptions& options = OllamaOpenAIOptions());
+
+    string getEndpoint() const override { return mOptions.endpoint; }
+    string buildChatPayload(const string& model, const string& prompt, const string& base64Image, const OllamaOptions& options) override;
+    string parseResponseContent(const string& response) override;
+
+    OllamaPromptCacheStats getPromptCacheStats() override;
+    void resetPromptCacheStats() override;
+
+    // Slot for a request (-1 if slots are not pinned); marks the slot as holding the request's prefix
+    int pickSlot(const string& model, const string& prompt);
+
+private:
+    struct Slot {
+        unsigned long long prefix = 0;          // Hash of the prefix the slot processed last
+        bool used = false;
+        unsigned long long lastUsed = 0;
+    };
+
+    OllamaOpenAIOptions mOptions;
+
+    mutex mMutex;
+    vector<Slot> mSlots;
+    unsigned long long mTick = 0;
+    OllamaPromptCacheStats mStats;
+
+    void recordTimings(const string& response);
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <set>
+#include <functional>
+
+using namespace std;
+
+/*
+    Offline batch inference over image files (archives, directories, frame dumps)
+
+    Three stages connected by a bounded window:
+    load    - loadThreads workers read and JPEG/base64-encode inputs in parallel
+    request - up to maxInFlight requests are kept in flight to the server
+    write   - results are appended to a JSONL file in input order
+
+    At most maxBuffered inputs are loaded but not yet written, so memory stays
+    bounded however long the batch is. Every line is flushed when written; with
+    resume enabled, inputs that already have a result in the output file are skipped.
+
+    Usage:
+    OllamaBatchOptions options;
+    options.outputPath = "captions.jsonl";
+    options.maxInFlight = 4;
+
+    vector<string> files = OllamaBatch::listImageFiles("C:/captures");
+    OllamaBatchReport report = client.sendBatchForInferenceSync(files, "Describe this frame.", options);
+    cout << report.imagesPerSecond << " images/s" << endl;
+
+    Output (one line per input):
+    {"file":"C:/captures/0001.jpg","response":"A person at a desk.","loadMs":4.1,"requestMs":812.5}
+    {"file":"C:/captures/0002.jpg","error":"Error: Failed to load image","loadMs":0.2,"requestMs":0.0}
+*/
+
+struct OllamaBatchOptions {
+    // JSONL results file
+    string outputPath;
+
+    // Threads loading and encoding inputs (0 = one per hardware thread)
+    int loadThreads = 0;
+
+    // Requests in flight at once (also limited by the client's resilience maxInFlight)
+    int maxInFlight = 4;
+
+    // Inputs loaded but not yet written (bounds memory between the stages)
+    int maxBuffered = 16;
+
+    float jpegQuality = 0.8f;
+
+    // Skip inputs that already have a successful result in outputPath (otherwise it is overwritten)
+    bool resume = true;
+
+    // Custom loader for other input formats, e.g. raw frame dumps: returns base64 JPEG or "" on failure
+    // (empty = the client's image file loader)
+    function<string(const string& input, float jpegQuality)> loadInput;
+
+    // Called from the writing thread after each result is written
+    function<void(size_t written, size_t total)> onProgress;
+};
+
+struct OllamaBatchReport {
+    // Inputs given, skipped because a result already existed, and processed now
+    size_t total = 0;
+    size_t skipped = 0;
+    size_t succeeded = 0;
+    size_t failed = 0;
+
+    double wallClockMs = 0.0;
+    double imagesPerSecond = 0.0;
+
+    // Threads per stage and their summed busy time
+    int loadThreads = 0;
+    int requestThreads = 0;
+    double loadBusyMs = 0.0;
+    double requestBusyMs = 0.0;
+    double writeBusyMs = 0.0;
+
+    // Set if the batch could not run at all (e.g. the output file could not be opened)
+    string error;
+
+    // Fraction of the wall-clock time each stage's threads were busy (0-1)
+    double getLoadUtilization() const { return utilization(loadBusyMs, loadThreads); }
+    double getRequestUtilization() const { return utilization(requestBusyMs, requestThreads); }
+    double getWriteUtilization() const { return utilization(writeBusyMs, 1); }
+
+private:
+    double utilization(double busyMs, int threads) const {
+        return wallClockMs > 0.0 && threads > 0 ? busyMs / (wallClockMs * threads) : 0.0;
+    }
+};
+
+class OllamaBatch {
+public:
+    // Image files (.jpg, .jpeg, .png, .bmp) in a directory, sorted by name
+    static vector<string> listImageFiles(const string& directory);
+
+    // Inputs with a successful result in a JSONL output file
+    static set<string> readCompleted(const string& outputPath);
+
+    // One JSONL result line (without the newline)
+    static string formatResult(const string& input, const string& result, double loadMs, double requestMs);
+};
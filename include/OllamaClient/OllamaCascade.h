@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <functional>
+#include <mutex>
+
+using namespace std;
+
+/*
+    Model cascade: answer with a small fast model first, escalate when needed
+
+    With a cascade configured, chat and vision requests go to the small model
+    first. Its answer is checked against the acceptance rule; only answers that
+    fail (and errors) are sent again to the client's regular model. Statistics
+    show how often that happens and how much latency the cascade saves.
+
+    Every check that is configured must pass:
+    confidenceField - numeric field in a JSON answer (use a format schema), at least minConfidence
+    acceptPattern   - regular expression the answer must contain
+    rejectPattern   - regular expression the answer must not contain (e.g. "not sure|cannot tell")
+    minLength/maxLength - answer length in bytes
+    accept          - custom rule
+
+    Usage:
+    OllamaCascadeOptions cascade;
+    cascade.visionModel = "moondream";
+    cascade.confidenceField = "confidence";
+    cascade.minConfidence = 0.7;
+    client.setCascadeOptions(cascade);
+*/
+
+struct OllamaCascadeOptions {
+    // Small models tried first (empty = no cascade for that kind of request)
+    string chatModel;
+    string visionModel;
+
+    string confidenceField;
+    double minConfidence = 0.0;
+
+    // ECMAScript syntax, searched anywhere in the answer; an invalid pattern always escalates
+    string acceptPattern;
+    string rejectPattern;
+
+    size_t minLength = 1;
+    size_t maxLength = 0;       // 0 = no limit
+
+    function<bool(const string& answer)> accept;
+};
+
+struct OllamaCascadeStats {
+    unsigned long long requests = 0;        // Requests that went to a small model first
+    unsigned long long accepted = 0;        // Answered by the small model
+    unsigned long long escalated = 0;       // Sent on to the regular model
+
+    double smallModelMs = 0.0;              // Summed latency of the small model calls
+    double largeModelMs = 0.0;              // Summed latency of the escalated calls
+
+    double getEscalationRate() const { return requests > 0 ? static_cast<double>(escalated) / requests : 0.0; }
+
+    // Average end-to-end latency of cascaded requests
+    double getMeanLatencyMs() const { return requests > 0 ? (smallModelMs + largeModelMs) / requests : 0.0; }
+
+    // Estimated time saved against sending everything to the regular model: accepted answers
+    // save a regular call (mean of the escalated ones), every small call costs its own latency
+    double getSavedMs() const {
+        return escalated > 0 ? accepted * (largeModelMs / escalated) - smallModelMs : 0.0;
+    }
+};
+
+class OllamaCascade {
+public:
+    // Whether the small model's answer passes the rule (error results never do)
+    static bool isAccepted(const OllamaCascadeOptions& options, const string& answer);
+
+    void recordAccepted(double smallMs);
+    void recordEscalated(double smallMs, double largeMs);
+
+    OllamaCascadeStats getStats();
+    void resetStats();
+
+private:
+    mutex mMutex;
+    OllamaCascadeStats mStats;
+};
@@ -3,13 +3,45 @@
 #include <string>
 #include <functional>
 #include <thread>
+#include <mutex>
+#include <atomic>
 #include <algorithm>
+#include <memory>
+
+#include "OllamaAtomicPtr.h"
+#include "OllamaOptions.h"
+#include "OllamaResilience.h"
+#include "OllamaImage.h"
+#include "OllamaTiling.h"
+#include "OllamaBatch.h"
+#include "OllamaMapReduce.h"
+#include "OllamaCascade.h"
+#include "OllamaAdaptive.h"
+#include "OllamaSingleFlight.h"
+#include "OllamaBackend.h"
+#include "OllamaEncodedImage.h"
+#include "OllamaContentEncoder.h"
 
 // Forward declarations to avoid including Windows headers in the header file
 typedef void* HINTERNET;
 
+class OllamaTraceRecorder;
+class OllamaEventLoop;
+
 using namespace std;
 
+// Where and how requests are sent. The client publishes it as an immutable snapshot:
+// each request reads one snapshot without locking and keeps it through its retries,
+// so a change applies to requests started after it and never to one half-way through.
+struct OllamaClientConfig {
+    string host = "localhost";
+    int port = 11434;
+    string visionModel;
+    string chatModel;
+    OllamaOptions options;
+    shared_ptr<OllamaBackend> backend;      // Never null in a published snapshot
+};
+
 /*
     Generic Ollama client base class
     Framework-independent HTTP communication with Ollama API
@@ -22,6 +54,18 @@ public:
     // Callback type for inference results
     using InferenceCallback = function<void(const string& result, void * userData)>;
 
+    // Callback type for tiled inference results
+    using TiledCallback = function<void(const OllamaTiledResult& result, void * userData)>;
+
+    // Callback type for batch results
+    using BatchCallback = function<void(const OllamaBatchReport& report, void * userData)>;
+
+    // Callback type for raw exchanges: the parsed result and the response body as received (empty if nothing was received)
+    using ExchangeCallback = function<void(const string& result, const string& rawResponse, void * userData)>;
+
+    // Callback type for map-reduce results
+    using MapReduceCallback = function<void(const OllamaMapReduceResult& result, void * userData)>;
+
     OllamaClientBase(const string& host = "localhost", int port = 11434, const string& visionModel = "granite3.2-vision", const string& chatModel = "llama3");
     virtual ~OllamaClientBase() = default;
 
@@ -29,25 +73,236 @@ public:
     void sendPrompt(const string& prompt, InferenceCallback callback, void * userData);
     string sendPromptSync(const string& prompt);
 
+    // Long documents: the prompt runs on context-sized chunks concurrently, then the answers are reduced to one
+    // (the async version copies the text first)
+    void sendMapReduce(const string& text, const string& prompt, const OllamaMapReduceOptions& options, MapReduceCallback callback, void * userData);
+    OllamaMapReduceResult sendMapReduceSync(const string& text, const string& prompt, const OllamaMapReduceOptions& options);
+
+    // Tiled inference on a raw pixel buffer (the async version copies the pixels first)
+    void sendTiledForInference(const OllamaPixelView& pixels, const string& prompt, const OllamaTileOptions& options, TiledCallback callback, void * userData);
+    OllamaTiledResult sendTiledForInferenceSync(const OllamaPixelView& pixels, const string& prompt, const OllamaTileOptions& options);
+
+    // YUV camera frames (I420, NV12, YUY2) encoded straight from their planes without an RGB round-trip
+    // (the async version copies the frame first)
+    void sendYuvForInference(const OllamaYuvView& frame, const string& prompt, InferenceCallback callback, void * userData);
+    string sendYuvForInferenceSync(const OllamaYuvView& frame, const string& prompt);
+
+    // Already-encoded JPEG or PNG images, sent as stored: no decode and no re-encode (see OllamaEncodedImage.h)
+    // Files are memory-mapped and base64-encoded from the mapping; the async byte version copies the bytes first
+    void sendEncodedImageForInference(const string& path, const string& prompt, InferenceCallback callback, void * userData);
+    string sendEncodedImageForInferenceSync(const string& path, const string& prompt);
+    void sendEncodedImageForInference(const unsigned char* data, size_t size, const string& prompt, InferenceCallback callback, void * userData);
+    string sendEncodedImageForInferenceSync(const unsigned char* data, size_t size, const string& prompt);
+
+    // Batch inference over image files with results written to a JSONL file
+    void sendBatchForInference(const vector<string>& inputs, const string& prompt, const OllamaBatchOptions& options, BatchCallback callback, void * userData);
+    OllamaBatchReport sendBatchForInferenceSync(const vector<string>& inputs, const string& prompt, const OllamaBatchOptions& options);
+
+    // Configuration snapshot (never null); setters publish a new snapshot and never block requests in flight
+    shared_ptr<const OllamaClientConfig> getConfig();
+    void setConfig(const OllamaClientConfig& config);
+    void setHost(const string& host, int port);
+
     // Model management
     void setVisionModel(const string& visionModel);
     string getVisionModel();
+    void setChatModel(const string& chatModel);
+    string getChatModel();
+
+    // Generation options serialized into every request
+    void setOptions(const OllamaOptions& options);
+    OllamaOptions getOptions();
+
+    // Server API the requests are written for (null = Ollama's /api/chat, the default)
+    // e.g. OllamaOpenAIBackend for llama.cpp's llama-server with prompt cache slot pinning
+    void setBackend(shared_ptr<OllamaBackend> backend);
+    shared_ptr<OllamaBackend> getBackend();
+
+    // Overload protection: in-flight limit, retry with backoff and circuit breaker
+    void setResilienceOptions(const OllamaResilienceOptions& options);
+    OllamaResilienceOptions getResilienceOptions();
+    OllamaResilienceStats getResilienceStats();
+
+    // Model cascade: try a small model first and escalate only answers that fail the acceptance rule
+    void setCascadeOptions(const OllamaCascadeOptions& options);
+    OllamaCascadeOptions getCascadeOptions();
+    OllamaCascadeStats getCascadeStats();
+    void resetCascadeStats();
+
+    // Adaptive JPEG quality and resolution for live frames (pixels, textures, surfaces, YUV frames)
+    void setAdaptiveOptions(const OllamaAdaptiveOptions& options);
+    OllamaAdaptiveOptions getAdaptiveOptions();
+    OllamaOperatingPoint getOperatingPoint();
+    vector<OllamaAdaptiveSample> getAdaptiveHistory();
+
+    // Content-aware encoding of pixels, textures, surfaces and tiles (off by default): grayscale and sparse images
+    // (drawings, screenshots) go out as single-channel JPEG or PNG when smaller, everything else as color JPEG
+    void setContentEncodingOptions(const OllamaContentEncodingOptions& options);
+    OllamaContentEncodingOptions getContentEncodingOptions();
+    OllamaContentEncodingStats getContentEncodingStats();
+    void resetContentEncodingStats();
+
+    // Coalesce identical requests in flight: one goes to the server, all callers get its result (off by default)
+    void setDeduplication(bool enabled);
+    bool getDeduplication();
+    OllamaSingleFlightStats getDeduplicationStats();
+
+    // Send a prebuilt /api/chat request body as-is (used to replay traces)
+    void sendRawRequest(const string& payload, InferenceCallback callback, void * userData);
+    string sendRawRequestSync(const string& payload);
+
+    // Like sendRawRequest, but also hands over the raw response body, e.g. for the server's timing fields
+    // (never coalesced with identical requests)
+    void sendRawExchange(const string& payload, ExchangeCallback callback, void * userData);
+
+    // Request body the client sends to its regular model for a prompt (with an image: the vision model)
+    string buildRequestPayload(const string& prompt, const string& base64Image = "");
+
+    // Append every request/response exchange to a trace file (see OllamaTrace.h)
+    bool startTraceRecording(const string& path);
+    void stopTraceRecording();
+
+    // Run the async requests on a shared non-blocking event loop instead of a thread each (null = thread per request)
+    // The loop may be released from one of its own callbacks; its threads finish shutting down after the callback returns
+    void setEventLoop(shared_ptr<OllamaEventLoop> loop);
+    shared_ptr<OllamaEventLoop> getEventLoop();
 
     // Simple base64 encoder
     static string base64_encode(const unsigned char* data, size_t input_length);
 
+    // Base64 JPEG from a YUV frame using the built-in encoder
+    static string yuvToBase64Jpeg(const OllamaYuvView& frame, float jpegQuality = 0.8f);
+
+    // Simple base64 decoder (stops at the first non-base64 character)
+    static string base64_decode(const string& input);
+
+    // Failed requests report a result starting with "Error:" instead of the answer
+    static const char* const kErrorPrefix;
+    static bool isErrorResult(const string& result);
+
 protected:
-    // Connection parameters
-    string mHost;
-    int mPort;
-    string mEndpoint;
-    string mVisionModel;
-    string mChatModel;
-
-    // Core HTTP functionality
-    string sendJSONPayload(const string payload);
+    // Connection, models, options and backend; replaced whole, never changed in place
+    OllamaAtomicPtr<const OllamaClientConfig> mConfig;
+
+    // Overload protection state
+    mutex mResilienceMutex;
+    OllamaResilienceOptions mResilienceOptions;
+    OllamaAdmissionController mAdmission;
+    OllamaCircuitBreaker mBreaker;
+    atomic<unsigned long long> mRetries{ 0 };
+
+    // Model cascade configuration and statistics
+    mutex mCascadeMutex;
+    OllamaCascadeOptions mCascadeOptions;
+    OllamaCascade mCascade;
+
+    // Encoding settings for live frames, adjusted from measured latency
+    OllamaAdaptiveController mAdaptive;
+
+    // Content-aware encoding configuration and statistics
+    mutex mContentMutex;
+    OllamaContentEncodingOptions mContentOptions;
+    OllamaContentEncodingStats mContentStats;
+
+    // Identical requests in flight, shared when deduplication is on
+    atomic<bool> mDeduplicate{ false };
+    OllamaSingleFlight mSingleFlight;
+
+    // Active trace recorder (null when not recording)
+    OllamaAtomicPtr<OllamaTraceRecorder> mTraceRecorder;
+
+    // Executor for async requests (null = thread per request)
+    OllamaAtomicPtr<OllamaEventLoop> mEventLoop;
+
+    // Run a request on a worker thread (or reject it at once if no slot is free) and report through the callback
+    void runAsync(function<string()> work, InferenceCallback callback, void * userData);
+    // Run a request on the calling thread under the same admission control
+    string runSync(function<string()> work);
+    // Build a request body and send it asynchronously: on the event loop if one is set, otherwise through runAsync
+    // (buildOnWorker = false builds cheap requests, such as text, on the calling thread instead of a worker)
+    void runAsyncRequest(function<string()> buildPayload, InferenceCallback callback, void * userData, bool buildOnWorker = true);
+
+    // One /api/chat call before the model is picked (the cascade may try a small model first)
+    struct ChatRequest {
+        bool vision = false;        // Vision model, otherwise the chat model
+        string prompt;
+        string base64Image;
+
+        // Live frame encoded at the adaptive controller's operating point, measured from startedAt to the answer
+        bool adaptive = false;
+        OllamaOperatingPoint operatingPoint;
+        chrono::steady_clock::time_point startedAt;
+    };
+
+    // Starts the clock and picks the encoding settings for a live frame (false if adaptive encoding is off)
+    bool acquireOperatingPoint(ChatRequest& request);
+    void recordOperatingPoint(const ChatRequest& request, const string& result);
+
+    ChatRequest buildYuvRequest(const OllamaYuvView& frame, const string& prompt);
+
+    // Vision request for encoded image bytes or a file; throws if they are not a complete JPEG or PNG
+    ChatRequest buildEncodedImageRequest(const unsigned char* data, size_t size, const string& prompt);
+    ChatRequest buildEncodedImageRequest(const string& path, const string& prompt);
+
+    // Send a chat request, through the cascade if one is configured
+    string sendChat(const ChatRequest& request);
+    void runAsyncChat(function<ChatRequest()> buildRequest, InferenceCallback callback, void * userData, bool buildOnWorker = true);
+
+    // Outcome of a single HTTP exchange, used for retry and circuit breaker decisions
+    struct HttpOutcome {
+        int statusCode = 0;         // HTTP status, 0 if no response was received
+        bool connectFailed = false; // Connection refused or server unreachable
+        bool timedOut = false;      // No response within requestTimeoutMs
+        string rawResponse;         // Response body as received
+    };
+
+    // Publish a copy of the current snapshot with change applied (retried if another change got in first)
+    void updateConfig(function<void(OllamaClientConfig& config)> change);
+
+    // Core HTTP functionality; every attempt of a request goes to the host and backend of the snapshot it was built from
+    string sendJSONPayload(shared_ptr<const OllamaClientConfig> config, const string payload);
+    string sendJSONPayloadTraced(shared_ptr<const OllamaClientConfig> config, const string& payload, string* rawResponse = nullptr);
+    string sendJSONPayloadWithRetry(const OllamaClientConfig& config, const string& payload, HttpOutcome& outcome);
+    string sendJSONPayloadOnce(const OllamaClientConfig& config, const string& payload, const OllamaResilienceOptions& options, HttpOutcome& outcome);
+
+    // Event loop path: an exchange runs on a loop thread and calls done, which releases the admission slot and calls back
+    using LoopExchange = function<void(function<void(const string& result)> done)>;
+
+    // Admission (never waiting on a loop thread), then prepare() builds the request off the loop: on a worker thread,
+    // or on the calling thread if prepareOnWorker is false. Only the exchange it returns is posted to the loop
+    void runOnEventLoop(shared_ptr<OllamaEventLoop> loop, function<LoopExchange()> prepare, bool prepareOnWorker,
+        InferenceCallback callback, void * userData);
+    void sendTracedOnEventLoop(shared_ptr<OllamaEventLoop> loop, shared_ptr<const OllamaClientConfig> config, shared_ptr<const string> payload,
+        function<void(const string& result)> done, shared_ptr<string> rawResponse = nullptr);
+
+    // Chat request with every payload it may send already built, so the loop thread only does I/O
+    struct PreparedChat {
+        ChatRequest request;
+        shared_ptr<const OllamaClientConfig> config;
+        OllamaCascadeOptions cascade;
+        shared_ptr<const string> smallPayload;  // Cascade's small model, null without a cascade
+        shared_ptr<const string> payload;       // Regular model
+    };
+    shared_ptr<const PreparedChat> prepareChat(ChatRequest request);
+    void sendChatOnEventLoop(shared_ptr<OllamaEventLoop> loop, shared_ptr<const PreparedChat> chat, function<void(const string& result)> done);
+
+    // Non-blocking counterpart of sendJSONPayloadWithRetry; done runs on a loop thread
+    void sendOnEventLoop(shared_ptr<OllamaEventLoop> loop, shared_ptr<const OllamaClientConfig> config, shared_ptr<const string> payload,
+        int attempt, function<void(const string& result, const HttpOutcome& outcome)> done);
+
+    // Records an attempt (probe as returned by allowRequest) with the circuit breaker;
+    // returns the backoff before the next attempt, or -1 to stop
+    int nextRetryDelayMs(const HttpOutcome& outcome, const OllamaResilienceOptions& options, int attempt, unsigned long long probe);
     string sendPromptInternal(const string& prompt);
 
+    // Requests in flight at once for a fan-out of count, capped by the client's in-flight limit
+    size_t limitFanOut(int maxConcurrent, size_t count);
+    // Send text prompts maxConcurrent at a time; results[i] gets the answer and timing of prompts[i]
+    void sendPromptsConcurrently(const vector<string>& prompts, int maxConcurrent, vector<OllamaChunkResult>& results);
+
+    // Request body for the snapshot's backend and options (base64Image may be empty for text-only prompts)
+    static string buildChatPayload(const OllamaClientConfig& config, const string& model, const string& prompt, const string& base64Image);
+
     // Pure virtual methods that subclasses must implement for image handling
     virtual string convertImageToBase64Jpeg(const void* imageData, float jpegQuality = 0.8f) = 0;
 
@@ -61,4 +316,18 @@ protected:
     // Helper for image inference that subclasses can use
     string sendImageForInferenceInternal(const string& base64Image, const string& prompt);
 
+    // Encode a raw pixel buffer as base64 JPEG, used for tiles
+    // Framework clients override this with their own encoder; the default uses the built-in encoder (OllamaJpeg)
+    virtual string encodePixelViewToBase64Jpeg(const OllamaPixelView& pixels, float jpegQuality);
+
+    // Encode a raw pixel buffer as base64 image: the format chosen by content when content-aware encoding is on
+    // (natural images still go through encodePixelViewToBase64Jpeg), otherwise always encodePixelViewToBase64Jpeg
+    string encodePixelViewToBase64Image(const OllamaPixelView& pixels, float jpegQuality);
+
+    OllamaTiledResult sendTiledForInferenceInternal(const OllamaPixelView& pixels, const string& prompt, const OllamaTileOptions& options);
+
+    // Load an image file as base64 JPEG, used for batches
+    // The default maps JPEG files and sends them as stored, and fails on other formats; framework clients decode and re-encode those
+    virtual string loadImageFileToBase64Jpeg(const string& path, float jpegQuality);
+
 };
\ No newline at end of file
@@ -36,6 +36,10 @@ public:
     void sendTextureForInference(const Texture2dRef& texture, const string& prompt, InferenceCallback callback, void * userData);
     string sendTextureForInferenceSync(const Texture2dRef& texture, const string& prompt);
 
+    // Tiled inference for high-resolution surfaces (see OllamaTileOptions)
+    void sendSurfaceTiledForInference(const Surface& surface, const string& prompt, const OllamaTileOptions& options, TiledCallback callback, void * userData);
+    OllamaTiledResult sendSurfaceTiledForInferenceSync(const Surface& surface, const string& prompt, const OllamaTileOptions& options);
+
     // Static utility methods for Cinder image conversion
     static string textureToBase64Jpeg(const Texture2dRef& texture, float jpegQuality = 0.8f);
     static string textureToRawBase64Jpeg(const Texture2dRef& texture, float jpegQuality = 0.8f);
@@ -49,6 +53,22 @@ protected:
     void sendImageForInference(const void* imageData, const string& prompt, InferenceCallback callback, void * userData) override;
     string sendImageForInferenceSync(const void* imageData, const string& prompt) override;
 
+    // Raw pixel encoding for tiles
+    string encodePixelViewToBase64Jpeg(const OllamaPixelView& pixels, float jpegQuality) override;
+
+    // Image file loading for batches (any format loadImage supports)
+    string loadImageFileToBase64Jpeg(const string& path, float jpegQuality) override;
+
 private:
     string sendImageForInferenceInternal(const Surface& surface, const string& prompt);
+    ChatRequest buildSurfaceRequest(const Surface& surface, const string& prompt);
+
+    // Base64 image for a request: content-aware when enabled, otherwise surfaceToRawBase64Jpeg
+    string surfaceToBase64Image(const Surface& surface, float jpegQuality);
+
+    // Encode any image source (Surface, Channel) as raw base64 JPEG
+    static string imageSourceToRawBase64Jpeg(const ImageSourceRef& source, float jpegQuality);
+
+    // View of RGB(A)/BGR(A) surface data without copying; other channel orders are converted to RGBA in packed
+    static OllamaPixelView surfaceToView(const Surface& surface, Surface8u& packed);
 };
\ No newline at end of file
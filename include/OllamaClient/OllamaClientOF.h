@@ -34,6 +34,10 @@ public:
     void sendImageForInference(const ofImage& image, const string& prompt, InferenceCallback callback, void * userData);
     string sendImageForInferenceSync(const ofImage& image, const string& prompt);
 
+    // Tiled inference for high-resolution pixels (see OllamaTileOptions)
+    void sendPixelsTiledForInference(const ofPixels& pixels, const string& prompt, const OllamaTileOptions& options, TiledCallback callback, void * userData);
+    OllamaTiledResult sendPixelsTiledForInferenceSync(const ofPixels& pixels, const string& prompt, const OllamaTileOptions& options);
+
     // Static utility methods for OpenFrameworks image conversion
     static string textureToBase64Jpeg(const ofTexture& texture, ofImageQualityType quality = OF_IMAGE_QUALITY_HIGH);
     static string pixelsToBase64Jpeg(const ofPixels& pixels, ofImageQualityType quality = OF_IMAGE_QUALITY_HIGH);
@@ -47,9 +51,23 @@ protected:
     void sendImageForInference(const void* imageData, const string& prompt, InferenceCallback callback, void * userData) override;
     string sendImageForInferenceSync(const void* imageData, const string& prompt) override;
 
+    // Raw pixel encoding for tiles
+    string encodePixelViewToBase64Jpeg(const OllamaPixelView& pixels, float jpegQuality) override;
+
+    // Image file loading for batches (any format ofLoadImage supports)
+    string loadImageFileToBase64Jpeg(const string& path, float jpegQuality) override;
+
 private:
     string sendPixelsForInferenceInternal(const ofPixels& pixels, const string& prompt);
+    ChatRequest buildPixelsRequest(const ofPixels& pixels, const string& prompt);
 
-    // Helper to convert OF quality enum to float
+    // Base64 image for a request: content-aware when enabled, otherwise pixelsToBase64Jpeg
+    string pixelsToBase64Image(const ofPixels& pixels, float jpegQuality);
+
+    // Helpers to convert between the OF quality enum and float
     static float qualityToFloat(ofImageQualityType quality);
+    static ofImageQualityType qualityFromFloat(float jpegQuality);
+
+    // View of ofPixels data without copying
+    static OllamaPixelView pixelsToView(const ofPixels& pixels);
 };
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "OllamaImage.h"
+
+using namespace std;
+
+/*
+    Content-aware image encoding: the format follows what is in the picture
+
+    Color JPEG suits photos and camera frames. Other content is sent more cheaply:
+    Grayscale - a single-channel JPEG carries no chroma at all
+    Sparse    - line drawings, sketches, diagrams and screenshots (a dominant
+                background or a handful of flat colors) are often smaller as PNG
+                and keep their edges, where JPEG rings around every stroke
+
+    analyze() scans the pixels once: every pixel for the gray test (a single
+    colored stroke keeps an image in color), a grid of samples for the color
+    count and the share of the most common color. Sparse images are encoded
+    as JPEG (gray or color) and then as PNG, which is abandoned as soon as it
+    grows past the JPEG; the smaller one is kept. Natural images only ever
+    pay for the analysis.
+
+    Alpha is dropped: 4-channel views are analyzed and encoded from their RGB
+    alone, so a transparent pixel is sent with the color it stores (often
+    black). Flatten a transparent canvas onto its background first.
+
+    Usage:
+    OllamaContentEncodeResult encoded = OllamaContentEncoder::encode(OllamaPixelView(canvas, 512, 512, 4), 0.8f);
+    cout << OllamaContentEncoder::formatToString(encoded.format) << " " << encoded.bytes.size() << " bytes" << endl;
+
+    Or for every frame, tile and drawing the client encodes:
+    OllamaContentEncodingOptions content;
+    content.enabled = true;
+    client.setContentEncodingOptions(content);
+*/
+
+enum class OllamaContentFormat { ColorJpeg, GrayJpeg, Png };
+
+struct OllamaContentEncodingOptions {
+    bool enabled = false;               // Used by the client only (off = always color JPEG, the framework encoder)
+
+    int grayTolerance = 4;              // Largest channel difference still counted as gray
+    double sparseBackground = 0.5;      // Share of the most common color from which an image counts as sparse
+    int maxFlatColors = 64;             // At most this many distinct colors also counts as sparse
+    int sampleStep = 4;                 // Colors are counted on every n-th pixel of every n-th row
+};
+
+struct OllamaImageContent {
+    bool grayscale = false;             // Every pixel within grayTolerance of gray
+    int colorCount = 0;                 // Distinct sampled colors, counted up to maxFlatColors + 1
+    double backgroundFraction = 0.0;    // Share of the samples in the most common color
+    bool sparse = false;                // Dominant background or few colors: lossless may win
+
+    bool isNatural() const { return !grayscale && !sparse; }
+};
+
+struct OllamaContentCandidate {
+    OllamaContentFormat format = OllamaContentFormat::ColorJpeg;
+    size_t size = 0;                    // Encoded bytes (before base64); 0 = abandoned once larger than an earlier candidate
+    double encodeMs = 0.0;
+};
+
+struct OllamaContentEncodeResult {
+    OllamaContentFormat format = OllamaContentFormat::ColorJpeg;
+    string bytes;                       // Image file bytes; empty if the pixels are invalid
+    OllamaImageContent content;
+    vector<OllamaContentCandidate> candidates;      // Every format tried, the kept one included
+
+    double analyzeMs = 0.0;
+    double encodeMs = 0.0;              // All candidates together
+};
+
+struct OllamaContentEncodingStats {
+    unsigned long long colorJpeg = 0;   // Images sent per format
+    unsigned long long grayJpeg = 0;
+    unsigned long long png = 0;
+
+    unsigned long long bytes = 0;       // Base64 image bytes sent
+    double encodeMs = 0.0;              // Analysis and encoding time
+
+    unsigned long long getImages() const { return colorJpeg + grayJpeg + png; }
+};
+
+class OllamaContentEncoder {
+public:
+    static OllamaImageContent analyze(const OllamaPixelView& pixels, const OllamaContentEncodingOptions& options = OllamaContentEncodingOptions());
+
+    // Formats worth trying for the content, in the order they are tried
+    // Natural color: color JPEG; natural gray: gray JPEG; sparse: the JPEG for its color, then PNG
+    static vector<OllamaContentFormat> getCandidates(const OllamaImageContent& content);
+
+    // Analyzes the pixels, encodes every candidate with the built-in encoders (OllamaJpeg, OllamaPng) and keeps the smallest
+    static OllamaContentEncodeResult encode(const OllamaPixelView& pixels, float jpegQuality = 0.8f,
+        const OllamaContentEncodingOptions& options = OllamaContentEncodingOptions());
+
+    // Same with an analysis the caller already has
+    static OllamaContentEncodeResult encode(const OllamaPixelView& pixels, float jpegQuality, const OllamaImageContent& content);
+
+    // One format; gray formats take the luma of color pixels
+    static string encodeAs(const OllamaPixelView& pixels, OllamaContentFormat format, float jpegQuality = 0.8f);
+
+    static string formatToString(OllamaContentFormat format);
+    static string formatToMimeType(OllamaContentFormat format);
+};
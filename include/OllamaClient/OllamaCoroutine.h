@@ -0,0 +1,436 @@
+#pragma once
+
+// Requires C++20 coroutines (/std:c++20 or /std:c++latest)
+#if !defined(__cpp_impl_coroutine) || !defined(__has_include)
+#error "OllamaCoroutine.h requires C++20 coroutines; compile with /std:c++20 or /std:c++latest"
+#elif !__has_include(<coroutine>)
+#error "OllamaCoroutine.h requires the <coroutine> header of a C++20 standard library"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <utility>
+
+#include "OllamaClientBase.h"
+
+using namespace std;
+
+/*
+    Awaitable versions of the async client calls (C++20 coroutines)
+
+    Steps that depend on each other read top to bottom instead of nesting
+    callbacks, and nothing blocks while a request is outstanding: the coroutine
+    is suspended and resumed from the request's callback. Combined with
+    setEventLoop() no thread at all is held per request.
+
+    OllamaTask<T>        - lazy coroutine: starts when awaited or when start() is called
+    OllamaAwait          - awaitables for prompts, images, YUV frames and raw requests
+    OllamaExecutor       - where the coroutine resumes (default: the thread that completed the request)
+    OllamaResumeQueue    - executor that resumes on the thread calling runPending(), e.g. the app's update()
+    OllamaCancellation   - cancel() resumes every pending await on the token with "Error: Cancelled"
+
+    Usage:
+    OllamaTask<string> describeAndSummarize(OllamaClientOF& client, ofPixels pixels, OllamaExecutor executor, OllamaCancellation cancel) {
+        string description = co_await OllamaAwait::image(client, &pixels, "Describe this image.", executor, cancel);
+        string hazards = co_await OllamaAwait::prompt(client, "List any hazards in: " + description, executor, cancel);
+        co_return co_await OllamaAwait::prompt(client, "Summarize in one line: " + hazards, executor, cancel);
+    }
+
+    OllamaResumeQueue mainThread;                   // runPending() from update()
+    OllamaCancellation cancel = OllamaCancellation::create();
+    describeAndSummarize(client, pixels, mainThread.getExecutor(), cancel).start([](string summary) { ... });
+*/
+
+// Schedules a resumption; null resumes inline on the thread that completed the request
+using OllamaExecutor = function<void(function<void()> resume)>;
+
+/*
+    Cancellation token shared by copies
+
+    Pass the same token (or a child()) down to nested tasks so cancelling the
+    outer operation cancels every await below it. A cancelled await resumes at
+    once; the HTTP request itself runs to completion and its result is dropped.
+*/
+class OllamaCancellation {
+public:
+    // Inert token that is never cancelled
+    OllamaCancellation() = default;
+
+    static OllamaCancellation create() {
+        OllamaCancellation token;
+        token.mState = make_shared<State>();
+        return token;
+    }
+
+    // Cancelled when this token is, but can also be cancelled on its own
+    OllamaCancellation child() const {
+        OllamaCancellation token = create();
+        if (mState) {
+            shared_ptr<State> childState = token.mState;
+            if (!subscribe([childState]() { cancelState(*childState); })) {
+                cancelState(*childState);
+            }
+        }
+        return token;
+    }
+
+    void cancel() {
+        if (mState) {
+            cancelState(*mState);
+        }
+    }
+
+    bool isCancelled() const {
+        if (!mState) {
+            return false;
+        }
+        lock_guard<mutex> lock(mState->stateMutex);
+        return mState->cancelled;
+    }
+
+    // Runs onCancel once when cancelled (on the cancelling thread). Returns 0 if already cancelled or inert
+    unsigned long long subscribe(function<void()> onCancel) const {
+        if (!mState) {
+            return 0;
+        }
+        lock_guard<mutex> lock(mState->stateMutex);
+        if (mState->cancelled) {
+            return 0;
+        }
+        unsigned long long id = ++mState->nextId;
+        mState->callbacks[id] = move(onCancel);
+        return id;
+    }
+
+    void unsubscribe(unsigned long long id) const {
+        if (mState && id) {
+            lock_guard<mutex> lock(mState->stateMutex);
+            mState->callbacks.erase(id);
+        }
+    }
+
+private:
+    struct State {
+        mutex stateMutex;
+        bool cancelled = false;
+        unsigned long long nextId = 0;
+        map<unsigned long long, function<void()>> callbacks;
+    };
+
+    shared_ptr<State> mState;
+
+    static void cancelState(State& state) {
+        map<unsigned long long, function<void()>> callbacks;
+        {
+            lock_guard<mutex> lock(state.stateMutex);
+            if (state.cancelled) {
+                return;
+            }
+            state.cancelled = true;
+            callbacks.swap(state.callbacks);
+        }
+        for (auto& callback : callbacks) {
+            callback.second();
+        }
+    }
+};
+
+// Executor that queues resumptions until the owning thread calls runPending()
+class OllamaResumeQueue {
+public:
+    OllamaResumeQueue() : mState(make_shared<State>()) {}
+
+    // Safe to use after the queue is destroyed (the resumptions are then never run)
+    OllamaExecutor getExecutor() const {
+        shared_ptr<State> state = mState;
+        return [state](function<void()> resume) {
+            lock_guard<mutex> lock(state->queueMutex);
+            state->pending.push_back(move(resume));
+        };
+    }
+
+    // Resumes everything queued so far on the calling thread; returns how many ran
+    size_t runPending() {
+        vector<function<void()>> pending;
+        {
+            lock_guard<mutex> lock(mState->queueMutex);
+            pending.swap(mState->pending);
+        }
+        for (function<void()>& resume : pending) {
+            resume();
+        }
+        return pending.size();
+    }
+
+private:
+    struct State {
+        mutex queueMutex;
+        vector<function<void()>> pending;
+    };
+
+    shared_ptr<State> mState;
+};
+
+// Awaitable result of one async client call
+class OllamaResultAwaitable {
+public:
+    // Starts the request; the callback must be called exactly once
+    using Starter = function<void(OllamaClientBase::InferenceCallback callback)>;
+
+    OllamaResultAwaitable(Starter start, OllamaExecutor executor, OllamaCancellation cancellation)
+        : mStart(move(start)), mState(make_shared<State>())
+    {
+        mState->executor = move(executor);
+        mState->cancellation = move(cancellation);
+    }
+
+    bool await_ready() const { return false; }
+
+    // Returns false (resume at once, no executor hop) if the result arrived before suspending
+    bool await_suspend(coroutine_handle<> handle) {
+        // A completion (or cancellation) arriving before this returns is recorded but not resumed
+        shared_ptr<State> state = mState;
+        Starter start = move(mStart);
+        state->handle = handle;
+
+        unsigned long long subscription = state->cancellation.subscribe([state]() { complete(state, "Error: Cancelled"); });
+        {
+            lock_guard<mutex> lock(state->stateMutex);
+            state->subscription = subscription;
+            if (!subscription && state->cancellation.isCancelled()) {
+                state->completed = true;
+                state->result = "Error: Cancelled";
+            }
+        }
+
+        if (!isCompleted(*state)) {
+            start([state](const string& result, void *) { complete(state, result); });
+        }
+
+        lock_guard<mutex> lock(state->stateMutex);
+        state->starting = false;
+        return !state->completed;
+    }
+
+    string await_resume() {
+        return move(mState->result);
+    }
+
+private:
+    struct State {
+        mutex stateMutex;
+        bool starting = true;       // Inside await_suspend: completion must not resume yet
+        bool completed = false;
+        string result;
+        coroutine_handle<> handle;
+        OllamaExecutor executor;
+        OllamaCancellation cancellation;
+        unsigned long long subscription = 0;
+    };
+
+    Starter mStart;
+    shared_ptr<State> mState;
+
+    static bool isCompleted(State& state) {
+        lock_guard<mutex> lock(state.stateMutex);
+        return state.completed;
+    }
+
+    // First of result and cancellation wins; the other is ignored
+    static void complete(const shared_ptr<State>& state, const string& result) {
+        bool resumeNow = false;
+        unsigned long long subscription = 0;
+        {
+            lock_guard<mutex> lock(state->stateMutex);
+            if (state->completed) {
+                return;
+            }
+            state->completed = true;
+            state->result = result;
+            resumeNow = !state->starting;
+            subscription = state->subscription;
+        }
+        state->cancellation.unsubscribe(subscription);
+
+        if (!resumeNow) {
+            return;     // await_suspend sees completed and does not suspend
+        }
+
+        coroutine_handle<> handle = state->handle;
+        if (state->executor) {
+            state->executor([handle]() { handle.resume(); });
+        }
+        else {
+            handle.resume();
+        }
+    }
+};
+
+class OllamaAwait {
+public:
+    // Text-only prompt (chat model)
+    static OllamaResultAwaitable prompt(OllamaClientBase& client, const string& prompt,
+        OllamaExecutor executor = nullptr, OllamaCancellation cancellation = OllamaCancellation()) {
+        return call([&client, prompt](OllamaClientBase::InferenceCallback callback) { client.sendPrompt(prompt, callback, nullptr); },
+            move(executor), move(cancellation));
+    }
+
+    // Framework image (ofPixels*, Surface*, ...); it only has to stay valid until the await starts
+    static OllamaResultAwaitable image(OllamaClientBase& client, const void* imageData, const string& prompt,
+        OllamaExecutor executor = nullptr, OllamaCancellation cancellation = OllamaCancellation()) {
+        return call([&client, imageData, prompt](OllamaClientBase::InferenceCallback callback) { client.sendImageForInference(imageData, prompt, callback, nullptr); },
+            move(executor), move(cancellation));
+    }
+
+    // YUV camera frame; the planes only have to stay valid until the await starts
+    static OllamaResultAwaitable yuv(OllamaClientBase& client, const OllamaYuvView& frame, const string& prompt,
+        OllamaExecutor executor = nullptr, OllamaCancellation cancellation = OllamaCancellation()) {
+        return call([&client, frame, prompt](OllamaClientBase::InferenceCallback callback) { client.sendYuvForInference(frame, prompt, callback, nullptr); },
+            move(executor), move(cancellation));
+    }
+
+    // Prebuilt /api/chat request body
+    static OllamaResultAwaitable raw(OllamaClientBase& client, const string& payload,
+        OllamaExecutor executor = nullptr, OllamaCancellation cancellation = OllamaCancellation()) {
+        return call([&client, payload](OllamaClientBase::InferenceCallback callback) { client.sendRawRequest(payload, callback, nullptr); },
+            move(executor), move(cancellation));
+    }
+
+    // Any other callback-based call, e.g. OllamaClientOF::sendTextureForInference
+    static OllamaResultAwaitable call(OllamaResultAwaitable::Starter start,
+        OllamaExecutor executor = nullptr, OllamaCancellation cancellation = OllamaCancellation()) {
+        return OllamaResultAwaitable(move(start), move(executor), move(cancellation));
+    }
+};
+
+namespace OllamaCoroutineDetail {
+    struct PromiseBase {
+        coroutine_handle<> continuation;    // Awaiting coroutine, resumed at the end
+        bool detached = false;              // Started with start(): the frame frees itself
+        exception_ptr error;
+        function<void(exception_ptr error)> onError;
+
+        suspend_always initial_suspend() noexcept { return {}; }
+        void unhandled_exception() noexcept { error = current_exception(); }
+    };
+
+    template<typename T>
+    struct Promise : PromiseBase {
+        T value{};
+        function<void(T result)> onDone;
+
+        void return_value(T result) { value = move(result); }
+        T take() {
+            if (error) rethrow_exception(error);
+            return move(value);
+        }
+        void finishDetached() {
+            if (error) { if (onError) onError(error); }
+            else if (onDone) onDone(move(value));
+        }
+    };
+
+    template<>
+    struct Promise<void> : PromiseBase {
+        function<void()> onDone;
+
+        void return_void() {}
+        void take() {
+            if (error) rethrow_exception(error);
+        }
+        void finishDetached() {
+            if (error) { if (onError) onError(error); }
+            else if (onDone) onDone();
+        }
+    };
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        template<typename P>
+        coroutine_handle<> await_suspend(coroutine_handle<P> handle) noexcept {
+            P& promise = handle.promise();
+            if (promise.continuation) {
+                return promise.continuation;    // Symmetric transfer: no stack growth across long chains
+            }
+            if (promise.detached) {
+                try {
+                    promise.finishDetached();
+                }
+                catch (...) {
+                }
+                handle.destroy();
+            }
+            return noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+}
+
+template<typename T = string>
+class OllamaTask {
+public:
+    struct promise_type : OllamaCoroutineDetail::Promise<T> {
+        OllamaTask get_return_object() { return OllamaTask(coroutine_handle<promise_type>::from_promise(*this)); }
+        OllamaCoroutineDetail::FinalAwaiter final_suspend() noexcept { return {}; }
+    };
+
+    OllamaTask() = default;
+    OllamaTask(OllamaTask&& other) noexcept : mHandle(exchange(other.mHandle, nullptr)) {}
+    OllamaTask& operator=(OllamaTask&& other) noexcept {
+        if (this != &other) {
+            if (mHandle) mHandle.destroy();
+            mHandle = exchange(other.mHandle, nullptr);
+        }
+        return *this;
+    }
+    OllamaTask(const OllamaTask&) = delete;
+    OllamaTask& operator=(const OllamaTask&) = delete;
+    ~OllamaTask() {
+        if (mHandle) mHandle.destroy();
+    }
+
+    // Awaiting runs the task and resumes with its result (exceptions are rethrown here)
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+            coroutine_handle<> await_suspend(coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().take(); }
+        };
+        return Awaiter{ mHandle };
+    }
+
+    // Start from non-coroutine code; the task then owns itself and onDone gets the result
+    template<typename Callback>
+    void start(Callback onDone, function<void(exception_ptr error)> onError = nullptr) {
+        coroutine_handle<promise_type> handle = exchange(mHandle, nullptr);
+        if (!handle) {
+            return;
+        }
+        handle.promise().detached = true;
+        handle.promise().onDone = move(onDone);
+        handle.promise().onError = move(onError);
+        handle.resume();
+    }
+
+    void start() {
+        start(nullptr);
+    }
+
+private:
+    explicit OllamaTask(coroutine_handle<promise_type> handle) : mHandle(handle) {}
+
+    coroutine_handle<promise_type> mHandle;
+};
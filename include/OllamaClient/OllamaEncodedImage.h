@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+
+using namespace std;
+
+/*
+    Images that are already encoded (JPEG or PNG files from a camera, a screenshot tool, an earlier run)
+
+    OllamaMappedFile   - read-only memory mapping of a whole file
+    OllamaEncodedImage - checks that bytes hold a complete JPEG or PNG and reads its size
+
+    Loading such a file into an ofImage or Surface decodes it, and pixelsToBase64Jpeg
+    then encodes it again: the CPU cost of both, and a second round of JPEG loss.
+    The client's sendEncodedImageForInference methods skip both. The file is
+    mapped, its headers are checked, and the mapped bytes are base64-encoded
+    into the request as they are.
+
+    Usage:
+    string answer = client.sendEncodedImageForInferenceSync("frames/0001.jpg", "What is in this image?");
+
+    OllamaMappedFile file("frames/0001.jpg");
+    OllamaEncodedImageInfo info;
+    if (file.isOpen() && OllamaEncodedImage::inspect(file.getData(), file.getSize(), info)) {
+        cout << OllamaEncodedImage::formatToString(info.format) << " " << info.width << "x" << info.height << endl;
+    }
+*/
+
+class OllamaMappedFile {
+public:
+    OllamaMappedFile() = default;
+    explicit OllamaMappedFile(const string& path);
+    ~OllamaMappedFile();
+
+    OllamaMappedFile(const OllamaMappedFile&) = delete;
+    OllamaMappedFile& operator=(const OllamaMappedFile&) = delete;
+
+    // Maps the whole file read-only (an empty file cannot be mapped and fails)
+    bool open(const string& path);
+    void close();
+
+    bool isOpen() const { return mData != nullptr; }
+    const unsigned char* getData() const { return mData; }
+    size_t getSize() const { return mSize; }
+    const string& getError() const { return mError; }
+
+private:
+    // Windows handles, kept as void* so this header does not pull in Windows.h
+    void* mFile = nullptr;
+    void* mMapping = nullptr;
+    const unsigned char* mData = nullptr;
+    size_t mSize = 0;
+    string mError;
+};
+
+struct OllamaEncodedImageInfo {
+    enum Format { Unknown, Jpeg, Png };
+
+    Format format = Unknown;
+    int width = 0;
+    int height = 0;
+    string error;       // Why inspect() failed
+};
+
+class OllamaEncodedImage {
+public:
+    // True for a JPEG (SOI, a frame header before the scan, EOI after it) or a PNG (signature, IHDR, IEND)
+    // with a non-zero size; truncated files fail
+    static bool inspect(const unsigned char* data, size_t size, OllamaEncodedImageInfo& info);
+
+    static string formatToString(OllamaEncodedImageInfo::Format format);
+
+private:
+    static bool inspectJpeg(const unsigned char* data, size_t size, OllamaEncodedImageInfo& info);
+    static bool inspectPng(const unsigned char* data, size_t size, OllamaEncodedImageInfo& info);
+};
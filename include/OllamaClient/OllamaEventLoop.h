@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+using namespace std;
+
+/*
+    Non-blocking HTTP/1.1 engine multiplexing many requests on a few threads
+
+    Each loop thread polls all of its sockets with WSAPoll. Every exchange is
+    a small state machine (connect, send, read headers, read body: fixed length,
+    chunked or until close), so hundreds of requests in flight cost a socket
+    and a few buffers each instead of a blocked thread each. Keep-alive
+    connections are pooled per host and reused.
+
+    Used by OllamaClientBase as an alternative executor for the async methods:
+    shared_ptr<OllamaEventLoop> loop = make_shared<OllamaEventLoop>(2);
+    client.setEventLoop(loop);
+    client.sendPrompt("hello", callback, nullptr);   // no thread per request
+
+    Callbacks and posted tasks run on a loop thread and must not block it.
+*/
+
+struct OllamaHttpRequest {
+    string host;
+    int port = 80;
+    string method = "POST";
+    string path = "/";
+    string contentType = "application/json";
+    string body;
+
+    // Whole exchange including connecting (0 = no limit)
+    double timeoutMs = 0.0;
+
+    // Optional: called with each piece of the (de-chunked) body as it arrives
+    function<void(const char* data, size_t size)> onBodyData;
+};
+
+struct OllamaHttpResponse {
+    int statusCode = 0;             // 0 if no response was received
+    bool connectFailed = false;     // Connection refused or server unreachable
+    bool timedOut = false;          // No complete response within timeoutMs
+    string body;
+    string error;                   // Empty on success, "Error: ..." otherwise
+};
+
+class OllamaEventLoop {
+public:
+    using ResponseCallback = function<void(OllamaHttpResponse& response)>;
+
+    explicit OllamaEventLoop(int threads = 1);
+    ~OllamaEventLoop();
+
+    // Queue an exchange (thread-safe); done is called exactly once on a loop thread
+    void submit(const OllamaHttpRequest& request, ResponseCallback done);
+
+    // Run a task on a loop thread, now or after a delay (thread-safe)
+    void post(function<void()> task);
+    void schedule(double delayMs, function<void()> task);
+
+    // True on one of this loop's threads, where callers must not block
+    bool isLoopThread() const;
+
+    // Closes every connection; exchanges still in flight fail with "Error: Event loop stopped"
+    // Called on a loop thread (directly or by destroying the loop from a callback), the other
+    // threads are joined and this one shuts down as soon as the callback returns
+    void stop();
+
+    int getThreadCount() const;
+    size_t getActiveCount() const;
+    size_t getOpenConnectionCount() const;
+    unsigned long long getCompletedCount() const;
+
+    // Idle keep-alive connections kept per host and loop thread
+    static const size_t kMaxIdlePerHost = 32;
+
+private:
+    struct Connection;
+    struct Worker;
+    struct Core;
+
+    // Threads, sockets and queues; every loop thread holds a reference until run() returns,
+    // so they outlive the loop object when its last owner lets go inside a callback
+    shared_ptr<Core> mCore;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+/*
+    Fast non-cryptographic hashing (64-bit FNV-1a)
+    Used to deduplicate image payloads and to key identical requests
+*/
+
+class OllamaHash {
+public:
+    static unsigned long long fnv1a(const void* data, size_t size, unsigned long long seed = 14695981039346656037ULL);
+    static unsigned long long fnv1a(const string& data, unsigned long long seed = 14695981039346656037ULL);
+
+    // 16 lowercase hex digits
+    static string toHex(unsigned long long hash);
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/*
+    Framework-independent view of an 8-bit interleaved pixel buffer
+    The view does not own the pixels; the buffer must outlive it
+
+    Usage:
+    OllamaPixelView view(frame.data, 3840, 2160, 3);
+    OllamaPixelView corner = view.crop(0, 0, 1024, 1024);   // no copy
+*/
+
+struct OllamaPixelView {
+    const unsigned char* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int channels = 3;       // 1 (gray), 3 (RGB) or 4 (RGBA)
+    size_t rowBytes = 0;    // Bytes between rows (0 = width * channels)
+    bool bgr = false;       // Channel order is BGR(A) instead of RGB(A)
+
+    OllamaPixelView() = default;
+    OllamaPixelView(const unsigned char* data, int width, int height, int channels, size_t rowBytes = 0, bool bgr = false);
+
+    bool isValid() const;
+    size_t getRowBytes() const;
+    const unsigned char* getRow(int y) const;
+
+    // Sub-rectangle sharing the same buffer (clamped to the image bounds)
+    OllamaPixelView crop(int x, int y, int width, int height) const;
+};
+
+/*
+    Framework-independent view of an 8-bit YUV camera frame
+    I420 - planar 4:2:0 (Y plane, U plane, V plane)
+    NV12 - semi-planar 4:2:0 (Y plane, interleaved UV plane)
+    YUY2 - packed 4:2:2 (Y0 U Y1 V per pixel pair)
+
+    Usage:
+    OllamaYuvView frame = OllamaYuvView::nv12(buffer, buffer + 1920 * 1080, 1920, 1080);
+    string base64Image = OllamaClientBase::yuvToBase64Jpeg(frame);
+*/
+
+enum class OllamaYuvFormat { I420, NV12, YUY2 };
+
+struct OllamaYuvView {
+    OllamaYuvFormat format = OllamaYuvFormat::I420;
+    int width = 0;
+    int height = 0;
+    const unsigned char* planes[3] = { nullptr, nullptr, nullptr };
+    size_t strides[3] = { 0, 0, 0 };    // Bytes between rows per plane (0 = tightly packed)
+
+    // Most cameras deliver video range (Y 16-235, UV 16-240); JPEG expects full range (0-255)
+    bool fullRange = false;
+
+    static OllamaYuvView i420(const unsigned char* y, const unsigned char* u, const unsigned char* v, int width, int height, size_t yStride = 0, size_t uvStride = 0);
+    static OllamaYuvView nv12(const unsigned char* y, const unsigned char* uv, int width, int height, size_t yStride = 0, size_t uvStride = 0);
+    static OllamaYuvView yuy2(const unsigned char* data, int width, int height, size_t stride = 0);
+
+    bool isValid() const;
+    int getPlaneCount() const;
+
+    // Plane geometry (chroma planes are half width, and half height for 4:2:0)
+    int getPlaneRows(int plane) const;
+    size_t getPlaneRowBytes(int plane) const;
+    size_t getStride(int plane) const;
+
+    // Area-averaged copy at another size as I420, stored in storage (used to send frames at reduced resolution)
+    OllamaYuvView resized(int newWidth, int newHeight, std::vector<unsigned char>& storage) const;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+#include "OllamaImage.h"
+
+using namespace std;
+
+/*
+    Built-in baseline JPEG encoder (framework independent)
+
+    YUV frames are encoded from their planes as they are: luma feeds the
+    8x8 blocks directly and chroma keeps its native subsampling (4:2:0 for
+    I420/NV12, 4:2:2 for YUY2), so no RGB conversion happens at all. Video
+    range samples are expanded to full range through a lookup table.
+
+    Interleaved pixels are converted to YCbCr and encoded as 4:2:0
+    (grayscale as a single component).
+
+    Usage:
+    string jpeg = OllamaJpegEncoder::encode(OllamaYuvView::nv12(y, uv, 1280, 720), 0.8f);
+*/
+
+class OllamaJpegEncoder {
+public:
+    // JPEG file bytes, or an empty string if the input is invalid
+    // Quality ranges from 0 to 1 like the framework encoders (mapped to the IJG 1-100 scale)
+    static string encode(const OllamaYuvView& frame, float quality = 0.8f);
+    static string encode(const OllamaPixelView& pixels, float quality = 0.8f);
+};
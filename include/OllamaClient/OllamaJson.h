@@ -0,0 +1,148 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+/*
+    Minimal JSON support for the Ollama client
+    No DOM is built: values are read in a single forward pass
+
+    OllamaJson              - escaping and single-field lookup helpers
+    OllamaJsonReader        - pull parser over a JSON text
+    OllamaStructuredDecoder - maps a JSON object straight into user struct fields
+
+    Decoding a structured response (request it with OllamaOptions::format):
+
+    struct Detection { string label; double confidence; vector<string> colors; };
+
+    Detection d;
+    OllamaStructuredDecoder decoder;
+    decoder.bind("label", &d.label)
+           .bind("confidence", &d.confidence)
+           .bind("colors", &d.colors);
+    if (!decoder.decode(client.sendPromptSync(prompt))) {
+        cout << decoder.getError() << endl;
+    }
+*/
+
+class OllamaJson {
+public:
+    // Escape a string for use inside a JSON string literal (quotes not included)
+    static string escape(const string& str);
+
+    // Find "key": "<string>" anywhere in the text and decode the value
+    static bool findString(const string& json, const string& key, string& value);
+
+    // Find "key": <number> anywhere in the text
+    static bool findNumber(const string& json, const string& key, double& value);
+
+    // Find "key": <number> and convert it to int (false if it does not fit)
+    static bool findInt(const string& json, const string& key, int& value);
+
+private:
+    // Offset of the value that follows "key": or string::npos
+    static size_t findValue(const string& json, const string& key);
+};
+
+class OllamaJsonReader {
+public:
+    enum Token { Null, Bool, Number, String, Object, Array, End, Invalid };
+
+    OllamaJsonReader(const char* begin, const char* end);
+    explicit OllamaJsonReader(const string& json);
+
+    // Type of the next value (skips whitespace, consumes nothing)
+    Token peek();
+
+    // Scalars - return false (and set the error) on a type mismatch
+    bool readString(string& value);
+    bool readNumber(double& value);
+    bool readBool(bool& value);
+    bool readNull();
+
+    // Objects: beginObject() then loop while (nextKey(key)) { read or skip the value }
+    bool beginObject();
+    bool nextKey(string& key);
+
+    // Arrays: beginArray() then loop while (nextElement()) { read or skip the value }
+    bool beginArray();
+    bool nextElement();
+
+    // Skip over one complete value of any type (nesting is capped at 256 levels)
+    bool skipValue();
+
+    // Advance to the first occurrence of a character (e.g. '{' after leading prose)
+    bool seek(char c);
+
+    bool ok() const { return mError.empty(); }
+    const string& getError() const { return mError; }
+    size_t getOffset() const { return static_cast<size_t>(mPos - mBegin); }
+
+private:
+    const char* mBegin;
+    const char* mPos;
+    const char* mEnd;
+    string mError;
+    int mDepth;     // Open objects and arrays
+    bool mFirst;    // No item read yet in the innermost open container
+
+    void skipWhitespace();
+    bool expect(char c);
+    bool enter(char open);
+    bool next(char close);
+    bool fail(const string& message);
+    static void appendUtf8(string& out, unsigned int codepoint);
+};
+
+class OllamaStructuredDecoder {
+public:
+    // Bind an object key to a destination field
+    OllamaStructuredDecoder& bind(const string& key, string* target);
+    OllamaStructuredDecoder& bind(const string& key, double* target);
+    OllamaStructuredDecoder& bind(const string& key, float* target);
+    OllamaStructuredDecoder& bind(const string& key, int* target);
+    OllamaStructuredDecoder& bind(const string& key, bool* target);
+    OllamaStructuredDecoder& bind(const string& key, vector<string>* target);
+    OllamaStructuredDecoder& bind(const string& key, vector<double>* target);
+    OllamaStructuredDecoder& bind(const string& key, vector<int>* target);
+
+    // Nested object decoded by another decoder
+    OllamaStructuredDecoder& bind(const string& key, OllamaStructuredDecoder* nested);
+
+    // Array of objects: bindElement is called once per element, before it is parsed,
+    // and should append a new struct and bind its fields to the given decoder
+    OllamaStructuredDecoder& bindArray(const string& key, function<void(OllamaStructuredDecoder& element)> bindElement);
+
+    // Anything else: the reader is positioned at the value and the handler must consume it
+    OllamaStructuredDecoder& bindCustom(const string& key, function<bool(OllamaJsonReader& reader)> handler);
+
+    // Decode a JSON object. Text before the first '{' is ignored, unknown keys are skipped
+    bool decode(const string& json);
+    bool decode(OllamaJsonReader& reader);
+
+    // Bound keys that were not present in the last decoded object
+    vector<string> getMissingKeys() const;
+
+    const string& getError() const { return mError; }
+
+private:
+    enum BindingType { BindString, BindDouble, BindFloat, BindInt, BindBool, BindStringArray, BindDoubleArray, BindIntArray, BindNested, BindArray, BindCustom };
+
+    struct Binding {
+        string key;
+        BindingType type;
+        void* target;
+        function<void(OllamaStructuredDecoder&)> bindElement;
+        function<bool(OllamaJsonReader&)> handler;
+        bool found;
+    };
+
+    vector<Binding> mBindings;
+    string mError;
+
+    OllamaStructuredDecoder& add(const string& key, BindingType type, void* target);
+    bool readBinding(Binding& binding, OllamaJsonReader& reader);
+};
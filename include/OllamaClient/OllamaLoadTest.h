@@ -0,0 +1,170 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "OllamaStandInServer.h"
+
+using namespace std;
+
+class OllamaClientBase;
+
+/*
+    Load generation for sizing an Ollama server
+
+    OllamaHdrHistogram  - latency histogram with fixed relative precision over
+                          a wide range in constant memory (HdrHistogram layout)
+    OllamaLoadGenerator - drives a client with one request scenario and reports
+                          throughput and latency / time-to-first-token percentiles
+    makeMockHandler     - stand-in /api/chat that emulates Ollama's timing, so
+                          the generator runs offline
+
+    Open-loop scenarios send at a fixed arrival rate whether or not earlier
+    requests have completed, like independent users do. Latency is measured
+    from the scheduled send time, so a client that falls behind shows up in
+    the percentiles instead of silently lowering the load (coordinated
+    omission). Closed-loop scenarios keep a fixed number of requests in flight.
+
+    Time to first token comes from the timing fields of Ollama's final
+    response: the end-to-end latency minus the time spent generating every
+    token after the first. Responses without those fields only record latency.
+
+    Usage:
+    OllamaStandInServer server(OllamaLoadGenerator::makeMockHandler(OllamaMockServerOptions()));
+    server.start();
+    MyClient client("127.0.0.1", server.getPort());
+
+    vector<OllamaLoadReport> reports;
+    for (double rate : { 1.0, 2.0, 4.0, 8.0 }) {
+        OllamaLoadScenario scenario;
+        scenario.name = "text @" + to_string(rate);
+        scenario.ratePerSecond = rate;
+        reports.push_back(OllamaLoadGenerator::run(client, scenario));
+    }
+    cout << OllamaLoadGenerator::formatTable(reports);
+*/
+
+class OllamaHdrHistogram {
+public:
+    // Values from 1 microsecond to highestMs, kept to significantDigits (1-5) decimal digits
+    OllamaHdrHistogram(double highestMs = 3600000.0, int significantDigits = 3);
+
+    // Values above the highest trackable one are recorded as that value
+    void record(double valueMs);
+    void add(const OllamaHdrHistogram& other);     // Same range and precision only
+    void reset();
+
+    unsigned long long getCount() const { return mCount; }
+    double getMinMs() const;
+    double getMaxMs() const;
+    double getMeanMs() const;
+
+    // Smallest recorded value that percentile percent of the values are at or below (within precision)
+    double getPercentileMs(double percentile) const;
+
+private:
+    int mSubBucketHalfCountMagnitude;
+    unsigned long long mSubBucketCount;
+    unsigned long long mSubBucketHalfCount;
+    unsigned long long mHighestUs;
+
+    vector<unsigned long long> mCounts;
+    unsigned long long mCount = 0;
+    unsigned long long mMinUs = 0;
+    unsigned long long mMaxUs = 0;
+    double mSumUs = 0.0;
+
+    size_t indexOf(unsigned long long valueUs) const;
+    unsigned long long highestEquivalentUs(size_t index) const;
+};
+
+// Timing fields of an Ollama response (reported in nanoseconds, converted to milliseconds),
+// or of llama-server's "timings" object (promptEval and eval only)
+struct OllamaServerTimings {
+    double totalMs = 0.0;
+    double loadMs = 0.0;
+    double promptEvalMs = 0.0;
+    double evalMs = 0.0;
+    int promptEvalCount = 0;
+    int evalCount = 0;
+
+    // False if the response has no eval timing
+    static bool parse(const string& response, OllamaServerTimings& timings);
+};
+
+struct OllamaLoadScenario {
+    string name = "scenario";
+
+    // Request content; with an image the request goes to the vision model
+    string prompt = "Describe a sunny day in one paragraph.";
+    string base64Image;
+
+    // Open loop: requests per second; 0 = closed loop with `concurrency` requests in flight
+    double ratePerSecond = 1.0;
+    int concurrency = 0;
+
+    // Exponential gaps between arrivals (a Poisson process), otherwise evenly spaced
+    bool poisson = true;
+    unsigned int seed = 1;
+
+    // Requests that start within the first warmupSec are sent but not measured
+    double durationSec = 30.0;
+    double warmupSec = 5.0;
+};
+
+struct OllamaLoadReport {
+    string name;
+    double offeredRate = 0.0;           // Requests per second asked for (0 for closed loop)
+    int concurrency = 0;
+
+    size_t sent = 0;
+    size_t completed = 0;
+    size_t errors = 0;                  // Error results, rejections included
+    size_t rejected = 0;                // Rejected by the client's in-flight limit or circuit breaker
+
+    // Measured requests completed per second, and generated tokens per second (when the server reports them)
+    double throughput = 0.0;
+    double tokensPerSecond = 0.0;
+
+    double wallClockMs = 0.0;
+    double maxDispatchLagMs = 0.0;      // Worst send delay behind schedule (open loop)
+    size_t maxInFlight = 0;
+
+    // Measured requests that succeeded
+    OllamaHdrHistogram latency;
+    OllamaHdrHistogram timeToFirstToken;
+};
+
+// Stand-in Ollama: a fixed number of requests run at once and the rest queue, as with OLLAMA_NUM_PARALLEL
+struct OllamaMockServerOptions {
+    int parallel = 4;
+
+    // Added to the first request only
+    double loadMs = 0.0;
+
+    // Prompt processing; the prompt is estimated at 4 bytes per token, plus imageTokens per image
+    double promptTokensPerSecond = 1000.0;
+    int imageTokens = 576;
+
+    // Generation speed of a request running alone; each other running request slows it by batchSlowdown
+    double evalTokensPerSecond = 40.0;
+    double batchSlowdown = 0.1;
+    int responseTokens = 64;
+
+    // Every duration varies by up to +- jitter (as a fraction)
+    double jitter = 0.1;
+    unsigned int seed = 1;
+};
+
+class OllamaLoadGenerator {
+public:
+    // Runs the scenario through client (sendRawExchange, so admission, retries and the event loop apply)
+    // and blocks until every request has completed
+    static OllamaLoadReport run(OllamaClientBase& client, const OllamaLoadScenario& scenario);
+
+    // Throughput table and latency / time-to-first-token percentile table, one row per report
+    static string formatTable(const vector<OllamaLoadReport>& reports);
+
+    // Non-streamed /api/chat answers with Ollama's timing fields (stream: true is not emulated)
+    static OllamaStandInServer::Handler makeMockHandler(const OllamaMockServerOptions& options);
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+    Map-reduce over long documents
+
+    A document too long for one request is split into chunks that fit the
+    model's context, on paragraph boundaries where possible, then sentences,
+    then words. Every chunk is sent with the prompt as its own request, up to
+    maxConcurrent at a time (map). The partial answers are combined with the
+    reduce prompt in one more request (reduce). If the partial answers are too
+    long for one request themselves, they are reduced in groups first, round
+    after round, until they fit.
+
+    Usage:
+    OllamaMapReduceOptions options;
+    options.maxConcurrent = 4;
+    options.reducePrompt = "Merge these partial summaries into one summary of the whole report.";
+
+    OllamaMapReduceResult result = client.sendMapReduceSync(report, "Summarize this part of the report.", options);
+    for (const OllamaChunkResult& chunk : result.chunks) { ... chunk.offset, chunk.requestMs, chunk.result ... }
+*/
+
+struct OllamaMapReduceOptions {
+    // Chunk size in tokens (0 = half the client's numCtx, or of Ollama's default 2048 if that is unset),
+    // leaving the rest of the context for the prompt and the answer
+    int maxChunkTokens = 0;
+
+    // Estimate used to turn tokens into characters (about 4 for English text)
+    double charsPerToken = 4.0;
+
+    // Chunk requests in flight at once
+    int maxConcurrent = 4;
+
+    // Instruction for the reduce step (empty = no reduce, only the chunk answers)
+    string reducePrompt = "Combine these partial answers into a single answer for the whole document.";
+};
+
+struct OllamaChunkResult {
+    size_t index = 0;
+
+    // Chunk position in the document, in bytes
+    size_t offset = 0;
+    size_t length = 0;
+
+    string result;
+    double startMs = 0.0;       // When the request started, relative to the start of the map step
+    double requestMs = 0.0;
+};
+
+struct OllamaMapReduceResult {
+    // In document order
+    vector<OllamaChunkResult> chunks;
+
+    // Answer of the final reduce request (empty if no reducePrompt)
+    string reduced;
+    double reduceMs = 0.0;
+    int reduceRounds = 0;       // 1, or more when the partial answers had to be reduced in groups first
+
+    // Elapsed time of the map step versus the sum of the chunk request times,
+    // i.e. what sending the chunks one after another would have taken
+    double wallClockMs = 0.0;
+    double sequentialMs = 0.0;
+
+    double getSpeedup() const { return wallClockMs > 0.0 ? sequentialMs / wallClockMs : 0.0; }
+};
+
+class OllamaTextSplitter {
+public:
+    // Chunks of at most maxChars bytes covering text in order (offset and length set, whitespace between chunks skipped)
+    // Cuts at the last paragraph break in the second half of the window, else the last sentence end, else the
+    // last whitespace, else at maxChars without splitting a UTF-8 character
+    static vector<OllamaChunkResult> split(const string& text, size_t maxChars);
+
+    // Chunk size in bytes for the options and the client's context size (numCtx, 0 = server default)
+    static size_t getMaxChunkChars(const OllamaMapReduceOptions& options, int numCtx);
+
+private:
+    static size_t findCut(const string& text, size_t begin, size_t end);
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+    Typed generation options for Ollama requests
+    Serialized into the "options" and "format" fields of every request body
+
+    Unset fields are left out of the request so the server (or the model's
+    Modelfile) keeps its own default.
+
+    Usage:
+    OllamaOptions options;
+    options.numPredict = 64;
+    options.temperature = 0.2f;
+    options.format = "json";
+    client.setOptions(options);
+
+    https://github.com/ollama/ollama/blob/main/docs/api.md#generate-request-with-options
+    https://ollama.com/blog/structured-outputs
+*/
+
+struct OllamaOptions {
+    // Maximum number of tokens to generate (-1 = server default)
+    int numPredict = -1;
+
+    // Context window size in tokens (0 = server default)
+    int numCtx = 0;
+
+    // Sampling temperature (< 0 = server default)
+    float temperature = -1.0f;
+
+    // Top-k sampling (0 = server default)
+    int topK = 0;
+
+    // Generation stops at any of these sequences
+    vector<string> stop;
+
+    // Output format: "" (free-form), "json", or a JSON schema object such as
+    // {"type":"object","properties":{"label":{"type":"string"}},"required":["label"]}
+    string format;
+
+    // Random seed for reproducible output (-1 = server default)
+    int seed = -1;
+
+    // True when no field is set and nothing needs to be serialized
+    bool isDefault() const;
+
+    // JSON fragment appended to a request body, e.g. ,"options":{"num_predict":64},"format":"json"
+    // Empty when isDefault() is true
+    string toJSONFields() const;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+
+#include "OllamaImage.h"
+
+using namespace std;
+
+/*
+    Built-in PNG encoder (framework independent, no zlib)
+
+    Lossless, for images JPEG handles badly: line drawings, diagrams,
+    screenshots and text, where a few flat colors and hard edges compress
+    to far fewer bytes than the DCT blocks JPEG spends on ringing.
+
+    The color type follows the pixels:
+    Gray    - every pixel has R == G == B (or the view has one channel)
+    Palette - at most 256 distinct colors
+    RGB     - anything else
+    Alpha is dropped, as in the JPEG encoders.
+
+    Rows are filtered (per row, the PNG filter with the smallest sum of
+    absolute differences) and compressed with deflate: LZ77 over hash chains
+    and dynamic Huffman codes per block. Filters predict smooth gradients;
+    on flat drawings and screenshots the unfiltered rows repeat exactly and
+    compress better, so filtering can be turned off (palette images are
+    never filtered).
+
+    Usage:
+    string png = OllamaPngEncoder::encode(OllamaPixelView(canvas.data, 512, 512, 4));
+
+    OllamaPngOptions options;
+    options.filterRows = false;
+    options.maxSize = jpeg.size();     // empty result if the PNG would not be smaller
+    string smaller = OllamaPngEncoder::encode(view, options);
+*/
+
+struct OllamaPngOptions {
+    enum ColorType { Auto, Gray, Palette, Rgb };
+
+    // Forcing Gray keeps the green channel; forcing Palette on more than 256 colors falls back to RGB
+    ColorType colorType = Auto;
+    bool filterRows = true;
+    size_t maxSize = 0;         // Stop and return an empty string once the file would be larger (0 = no limit)
+};
+
+class OllamaPngEncoder {
+public:
+    // PNG file bytes, or an empty string if the input is invalid (or the file would exceed maxSize)
+    static string encode(const OllamaPixelView& pixels, const OllamaPngOptions& options = OllamaPngOptions());
+
+    // Deflate wrapped as a zlib stream (RFC 1950), as stored in IDAT; empty if it would exceed maxSize (0 = no limit)
+    static string zlibCompress(const unsigned char* data, size_t size, size_t maxSize = 0);
+
+    static unsigned long crc32(const unsigned char* data, size_t size, unsigned long crc = 0);
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+/*
+    Overload protection for the Ollama client
+
+    OllamaAdmissionController - caps the number of requests in flight, rejecting
+                                immediately or after a bounded wait when full
+    OllamaAdmissionSlot       - releases an acquired slot when it goes out of scope
+    OllamaCircuitBreaker      - fails fast while the server is unhealthy and lets
+                                a few probe requests through to detect recovery
+
+    Both are owned by OllamaClientBase and configured with OllamaResilienceOptions.
+    Retries (connection refused / HTTP 503, timeouts on request) use exponential backoff with full jitter:
+    https://aws.amazon.com/blogs/architecture/exponential-backoff-and-jitter/
+*/
+
+struct OllamaResilienceOptions {
+    // Maximum concurrent requests (0 = unlimited)
+    int maxInFlight = 0;
+
+    // How long a request may wait for a free slot before it is rejected (0 = reject immediately)
+    int maxWaitMs = 0;
+
+    // How long to wait for the response (0 = no limit): the whole exchange on the event loop,
+    // the receive timeout with WinHTTP (whose default is the same 30 s)
+    int requestTimeoutMs = 30000;
+
+    // Extra attempts after a connection refused or an HTTP 503 response
+    int maxRetries = 2;
+
+    // Also retry timed-out requests. Off by default: the server may still be generating the
+    // first answer, so a retry can run the same prompt twice and adds load when it is slow
+    bool retryOnTimeout = false;
+
+    // Backoff before retry n is a random delay in [0, min(retryMaxDelayMs, retryBaseDelayMs * 2^n)]
+    int retryBaseDelayMs = 200;
+    int retryMaxDelayMs = 5000;
+
+    // Consecutive failures that open the breaker (0 = breaker disabled)
+    int breakerFailureThreshold = 5;
+
+    // Time the breaker stays open before letting probe requests through
+    int breakerOpenMs = 10000;
+
+    // Concurrent probe requests allowed while half-open
+    int breakerHalfOpenProbes = 1;
+};
+
+class OllamaAdmissionController {
+public:
+    // Returns false if no slot became free within maxWaitMs
+    bool acquire(int maxInFlight, int maxWaitMs);
+    void release();
+
+    int getInFlight();
+    unsigned long long getAdmittedCount() const { return mAdmitted; }
+    unsigned long long getRejectedCount() const { return mRejected; }
+
+private:
+    mutex mMutex;
+    condition_variable mSlotFreed;
+    int mInFlight = 0;
+    atomic<unsigned long long> mAdmitted{ 0 };
+    atomic<unsigned long long> mRejected{ 0 };
+};
+
+// Owns one slot from a successful acquire(), so a throwing request still gives it back
+class OllamaAdmissionSlot {
+public:
+    explicit OllamaAdmissionSlot(OllamaAdmissionController& admission) : mAdmission(admission) {}
+    ~OllamaAdmissionSlot() { mAdmission.release(); }
+
+    OllamaAdmissionSlot(const OllamaAdmissionSlot&) = delete;
+    OllamaAdmissionSlot& operator=(const OllamaAdmissionSlot&) = delete;
+
+private:
+    OllamaAdmissionController& mAdmission;
+};
+
+class OllamaCircuitBreaker {
+public:
+    enum State { Closed, Open, HalfOpen };
+
+    // Returns false while open; in half-open, admits up to maxProbes concurrent probes.
+    // probe is set to 0 for a normal request, otherwise to the half-open period the probe belongs to.
+    // Every admitted request must be followed by recordSuccess() or recordFailure() with that value:
+    // only probes move the breaker out of half-open, so a request admitted while closed cannot
+    // close it again or take a probe's place when it finishes late
+    bool allowRequest(const OllamaResilienceOptions& options, unsigned long long& probe);
+    void recordSuccess(unsigned long long probe);
+    void recordFailure(const OllamaResilienceOptions& options, unsigned long long probe);
+
+    State getState();
+    static string stateToString(State state);
+    unsigned long long getRejectedCount() const { return mRejected; }
+
+private:
+    mutex mMutex;
+    State mState = Closed;
+    int mConsecutiveFailures = 0;
+    int mProbesInFlight = 0;
+    unsigned long long mHalfOpenPeriod = 0;
+    chrono::steady_clock::time_point mOpenedAt;
+    atomic<unsigned long long> mRejected{ 0 };
+
+    void open();
+};
+
+// Snapshot of the overload-protection counters
+struct OllamaResilienceStats {
+    OllamaCircuitBreaker::State breakerState = OllamaCircuitBreaker::Closed;
+    int inFlight = 0;
+    unsigned long long admitted = 0;
+    unsigned long long rejectedInFlight = 0;   // No free slot within maxWaitMs
+    unsigned long long rejectedBreaker = 0;    // Failed fast because the breaker was open
+    unsigned long long retries = 0;
+};
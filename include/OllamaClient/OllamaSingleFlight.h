@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <atomic>
+
+using namespace std;
+
+/*
+    In-flight request coalescing (single-flight)
+
+    Requests with an identical body (same model, prompt, image and options)
+    for the same target (host, port and endpoint) that are sent while one of
+    them is still outstanding attach to it instead
+    of sending their own: one HTTP request goes out and every caller receives
+    its result. Nothing is cached; once the request completes, the next
+    identical one is sent again.
+
+    Used by OllamaClientBase when deduplication is enabled:
+    client.setDeduplication(true);
+*/
+
+struct OllamaSingleFlightStats {
+    unsigned long long sent = 0;        // Requests that went to the server
+    unsigned long long merged = 0;      // Requests that attached to one already in flight
+    size_t inFlight = 0;                // Distinct requests outstanding now
+
+    double getMergeRate() const { return sent + merged > 0 ? static_cast<double>(merged) / (sent + merged) : 0.0; }
+};
+
+class OllamaSingleFlight {
+public:
+    using ResultCallback = function<void(const string& result)>;
+
+    // Registers onResult for payload sent to target. Returns true if no identical request is in flight: the caller
+    // then sends it and must call complete(key, result), which calls onResult and every callback attached meanwhile
+    bool join(const string& target, const string& payload, ResultCallback onResult, unsigned long long& key);
+    void complete(unsigned long long key, const string& result);
+
+    // Blocking form: send() runs for the first caller, the others wait for its result
+    string run(const string& target, const string& payload, function<string()> send);
+
+    OllamaSingleFlightStats getStats();
+
+private:
+    struct Flight {
+        string target;
+        const string* payload;          // The sender's payload, alive until complete()
+        vector<ResultCallback> waiters;
+    };
+
+    mutex mMutex;
+    unordered_map<unsigned long long, Flight> mFlights;
+    atomic<unsigned long long> mSent{ 0 };
+    atomic<unsigned long long> mMerged{ 0 };
+};
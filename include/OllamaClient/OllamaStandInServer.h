@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+/*
+    Minimal local HTTP/1.1 server standing in for Ollama
+    Used to replay traces and to test throughput without a model or GPU
+
+    Listens on 127.0.0.1 only. Each connection is served on its own thread with keep-alive.
+    A response with more than one chunk is sent with chunked transfer encoding,
+    each chunk after its delay, which emulates a streamed generation.
+
+    Usage:
+    OllamaStandInServer server([](const string& method, const string& path, const string& body) {
+        OllamaStandInServer::Response response;
+        response.chunks.push_back({ 250.0, "{\"message\":{\"role\":\"assistant\",\"content\":\"ok\"},\"done\":true}" });
+        return response;
+    });
+    server.start(11435);
+*/
+
+class OllamaStandInServer {
+public:
+    struct Chunk {
+        double delayMs;     // Wait before sending this chunk
+        string data;
+    };
+
+    struct Response {
+        int statusCode = 200;
+        string contentType = "application/json";
+        vector<Chunk> chunks;
+    };
+
+    using Handler = function<Response(const string& method, const string& path, const string& body)>;
+
+    explicit OllamaStandInServer(Handler handler);
+    ~OllamaStandInServer();
+
+    // Starts listening (port 0 = any free port, see getPort())
+    bool start(int port = 0);
+    void stop();
+
+    bool isRunning() const { return mRunning; }
+    int getPort() const { return mPort; }
+    unsigned long long getRequestCount() const { return mRequestCount; }
+
+private:
+    Handler mHandler;
+    atomic<bool> mRunning{ false };
+    int mPort = 0;
+    atomic<unsigned long long> mRequestCount{ 0 };
+
+    // SOCKET handles are stored as uintptr_t to keep Winsock out of this header
+    uintptr_t mListenSocket;
+    thread mAcceptThread;
+    mutex mConnectionsMutex;
+    vector<uintptr_t> mConnections;
+    vector<thread> mConnectionThreads;
+
+    void acceptLoop();
+    void serveConnection(uintptr_t socket);
+    bool sendAll(uintptr_t socket, const string& data);
+};
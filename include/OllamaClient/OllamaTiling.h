@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+    Tiled inference for high-resolution images
+
+    A large image is split into overlapping tiles. Tiles are JPEG-encoded in
+    parallel and sent as separate requests, up to maxConcurrent at a time, so
+    small details survive that a single downscaled request would lose.
+
+    Usage:
+    OllamaTileOptions options;
+    options.tileWidth = options.tileHeight = 1024;
+    options.maxConcurrent = 4;
+    options.mergePrompt = "Combine these tile reports into a list of defects.";
+
+    OllamaTiledResult result = client.sendTiledForInferenceSync(view, "List any defects.", options);
+    for (const OllamaTileResult& tile : result.tiles) { ... tile.x, tile.y, tile.result ... }
+*/
+
+struct OllamaTileOptions {
+    // Tile size in pixels (clamped to the image size)
+    int tileWidth = 1024;
+    int tileHeight = 1024;
+
+    // Pixels shared by neighbouring tiles so objects on a seam appear whole in one of them
+    int overlap = 128;
+
+    // Tile requests in flight at once
+    int maxConcurrent = 4;
+
+    // Threads encoding tiles (0 = one per hardware thread)
+    int encodeThreads = 0;
+
+    float jpegQuality = 0.8f;
+
+    // If set, tile answers are combined with this instruction in one chat request
+    string mergePrompt;
+};
+
+struct OllamaTileResult {
+    // Tile rectangle in source image pixels
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    // Grid position
+    int row = 0;
+    int column = 0;
+
+    string result;
+    double encodeMs = 0.0;
+    double requestMs = 0.0;
+};
+
+struct OllamaTiledResult {
+    // In row-major grid order
+    vector<OllamaTileResult> tiles;
+
+    // Answer of the merge request (empty if no mergePrompt)
+    string merged;
+    double mergeMs = 0.0;
+
+    // Elapsed time for all tiles versus the sum of per-tile encode + request times,
+    // i.e. what processing the tiles one after another would have taken
+    double wallClockMs = 0.0;
+    double sequentialMs = 0.0;
+
+    double getSpeedup() const { return wallClockMs > 0.0 ? sequentialMs / wallClockMs : 0.0; }
+};
+
+class OllamaTiler {
+public:
+    // Tile rectangles covering a width x height image, in row-major order
+    // Tiles are spaced evenly, so the actual overlap may exceed the requested one
+    static vector<OllamaTileResult> computeTiles(int width, int height, const OllamaTileOptions& options);
+
+private:
+    static vector<int> computeOffsets(int length, int tileLength, int overlap);
+};
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+
+#include "OllamaStandInServer.h"
+
+using namespace std;
+
+class OllamaClientBase;
+
+/*
+    Request/response traces for reproducing production load offline
+
+    OllamaTraceRecorder - appends every exchange to a compact binary trace file
+    OllamaTraceReader   - loads a trace back into memory
+    OllamaTraceReplayer - replays a trace through a client, or serves it from a
+                          local stand-in server so throughput can be tested without a GPU
+
+    Recording:
+    client.startTraceRecording("session.oltr");
+    ...
+    client.stopTraceRecording();
+
+    Replaying against a stand-in server at twice the original speed:
+    vector<OllamaTraceEntry> trace;
+    OllamaTraceReader::read("session.oltr", trace);
+
+    OllamaStandInServer server(OllamaTraceReplayer::makeStandInHandler(trace, 2.0));
+    server.start();
+
+    OllamaClientOF client("127.0.0.1", server.getPort());
+    OllamaReplayOptions options;
+    options.speed = 2.0;
+    OllamaReplayReport report = OllamaTraceReplayer::replay(client, trace, options);
+
+    File format (all integers are unsigned LEB128 varints unless noted):
+    "OLTR" version(u8)
+    record*: type(u8) length payload
+      'B' blob:     id(u64 little endian) encoding(u8: 0 = raw, 1 = base64 decoded) bytes
+      'E' exchange: arrivalUs latencyUs status requestLength request responseLength response
+
+    Images inside "images":[...] are written once as blobs and referenced from
+    request bodies as "@blob:<16 hex digits>". A blob id is the FNV-1a hash of the
+    base64 image, or the next free value if a different image already has that hash.
+*/
+
+struct OllamaTraceEntry {
+    // Wall-clock arrival time (milliseconds since the Unix epoch)
+    double arrivalMs = 0.0;
+
+    // Time from arrival to the final response, including retries
+    double latencyMs = 0.0;
+
+    // HTTP status of the last attempt (0 = no response)
+    int statusCode = 0;
+
+    // Request body with images inlined, raw response body
+    string request;
+    string response;
+};
+
+class OllamaTraceRecorder {
+public:
+    ~OllamaTraceRecorder();
+
+    // Opens (or continues) an append-only trace file
+    bool open(const string& path);
+    void close();
+    bool isOpen();
+
+    // Thread-safe; each record is flushed so a crash loses at most the record being written
+    void record(const OllamaTraceEntry& entry);
+
+    // Safe to call while other threads record
+    unsigned long long getRecordCount() const { return mRecordCount; }
+    unsigned long long getDedupedImageCount() const { return mDedupedImages; }
+
+    // Current wall-clock time in the trace's time base
+    static double nowMs();
+
+private:
+    mutex mMutex;
+    ofstream mFile;
+    // Stored blobs: id -> length and second hash of the image, to tell a repeat from a hash collision
+    map<unsigned long long, pair<size_t, unsigned long long>> mBlobs;
+    atomic<unsigned long long> mRecordCount{ 0 };
+    atomic<unsigned long long> mDedupedImages{ 0 };
+
+    void writeRecord(char type, const string& payload);
+    static pair<size_t, unsigned long long> fingerprint(const string& image);
+};
+
+class OllamaTraceReader {
+public:
+    // Loads all exchanges in arrival order with images restored into the request bodies
+    static bool read(const string& path, vector<OllamaTraceEntry>& entries, string* error = nullptr);
+};
+
+struct OllamaReplayOptions {
+    // 1.0 = original arrival times, 2.0 = twice as fast, 0 = send everything at once
+    double speed = 1.0;
+
+    // Replay only the first N entries (0 = all)
+    size_t maxRequests = 0;
+};
+
+struct OllamaReplayReport {
+    size_t sent = 0;
+    size_t errors = 0;
+
+    // Time span of the replayed part of the trace (after scaling) and actual replay time
+    double traceDurationMs = 0.0;
+    double wallClockMs = 0.0;
+
+    // Completed requests per second of wall-clock time
+    double throughput = 0.0;
+
+    // Per-request latency in trace order, and the worst dispatch delay behind schedule
+    vector<double> latenciesMs;
+    double maxDispatchLagMs = 0.0;
+
+    double getMeanLatencyMs() const;
+    double getPercentileLatencyMs(double percentile) const;
+};
+
+class OllamaTraceReplayer {
+public:
+    // Open-loop replay: requests are dispatched at their (scaled) arrival times whether or not
+    // earlier ones have completed. Blocks until every response has arrived
+    static OllamaReplayReport replay(OllamaClientBase& client, const vector<OllamaTraceEntry>& entries, const OllamaReplayOptions& options);
+
+    // Stand-in server handler answering each recorded request body with its recorded
+    // response after its recorded latency divided by speed (0 = no delay)
+    static OllamaStandInServer::Handler makeStandInHandler(const vector<OllamaTraceEntry>& entries, double speed = 1.0);
+};
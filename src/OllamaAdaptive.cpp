@@ -0,0 +1,143 @@
+#include <OllamaClient/OllamaAdaptive.h>
+
+#include <algorithm>
+#include <cmath>
+
+OllamaAdaptiveController::OllamaAdaptiveController()
+    : mStart(chrono::steady_clock::now())
+{
+    moveTo(0);
+    mPoint.changes = 0;
+}
+
+void OllamaAdaptiveController::setOptions(const OllamaAdaptiveOptions& options) {
+    lock_guard<mutex> lock(mMutex);
+    mOptions = options;
+    mUpgradeBackoff.clear();
+    mSteppedUp = false;
+    moveTo(0);
+}
+
+OllamaAdaptiveOptions OllamaAdaptiveController::getOptions() {
+    lock_guard<mutex> lock(mMutex);
+    return mOptions;
+}
+
+// Ladder levels that lower the quality (including level 0) and that lower the resolution after it
+static int qualityLevelCount(const OllamaAdaptiveOptions& options) {
+    if (options.qualityStep <= 0.0f || options.maxQuality <= options.minQuality) {
+        return 1;
+    }
+    return 1 + static_cast<int>(ceil((options.maxQuality - options.minQuality) / options.qualityStep - 1e-4f));
+}
+
+static int scaleLevelCount(const OllamaAdaptiveOptions& options) {
+    if (options.scaleStep <= 0.0f || options.scaleStep >= 1.0f || options.maxScale <= options.minScale || options.minScale <= 0.0f) {
+        return 0;
+    }
+    return static_cast<int>(ceil(log(options.minScale / options.maxScale) / log(options.scaleStep) - 1e-4f));
+}
+
+int OllamaAdaptiveController::getLevelCount(const OllamaAdaptiveOptions& options) {
+    return qualityLevelCount(options) + scaleLevelCount(options);
+}
+
+void OllamaAdaptiveController::levelToSettings(const OllamaAdaptiveOptions& options, int level, float& quality, float& scale) {
+    level = max(0, min(level, getLevelCount(options) - 1));
+
+    // Quality goes first (cheap to recover), the resolution once quality is at its minimum
+    int qualityLevels = qualityLevelCount(options);
+    if (level < qualityLevels) {
+        quality = max(options.minQuality, options.maxQuality - level * options.qualityStep);
+        scale = options.maxScale;
+    }
+    else {
+        quality = options.minQuality;
+        scale = max(options.minScale, options.maxScale * pow(options.scaleStep, static_cast<float>(level - qualityLevels + 1)));
+    }
+}
+
+bool OllamaAdaptiveController::acquire(OllamaOperatingPoint& point) {
+    lock_guard<mutex> lock(mMutex);
+    if (!mOptions.enabled) {
+        return false;
+    }
+    point = mPoint;
+    return true;
+}
+
+void OllamaAdaptiveController::record(const OllamaOperatingPoint& point, size_t payloadBytes, double latencyMs) {
+    lock_guard<mutex> lock(mMutex);
+
+    // Only measurements of the current point drive the controller
+    if (point.level == mPoint.level && point.changes == mPoint.changes) {
+        double weight = mPoint.samples == 0 ? 1.0 : max(0.0, min(1.0, mOptions.smoothing));
+        mPoint.smoothedLatencyMs += weight * (latencyMs - mPoint.smoothedLatencyMs);
+        mPoint.meanPayloadBytes += (static_cast<double>(payloadBytes) - mPoint.meanPayloadBytes) / (mPoint.samples + 1);
+        mPoint.samples++;
+    }
+
+    OllamaAdaptiveSample sample;
+    sample.timeMs = chrono::duration<double, milli>(chrono::steady_clock::now() - mStart).count();
+    sample.level = point.level;
+    sample.quality = point.quality;
+    sample.scale = point.scale;
+    sample.payloadBytes = payloadBytes;
+    sample.latencyMs = latencyMs;
+    sample.smoothedLatencyMs = mPoint.smoothedLatencyMs;
+    mHistory.push_back(sample);
+    while (mHistory.size() > max<size_t>(1, mOptions.historySize)) {
+        mHistory.pop_front();
+    }
+
+    if (!mOptions.enabled) {
+        return;
+    }
+
+    int levels = getLevelCount(mOptions);
+    mUpgradeBackoff.resize(levels, 1);
+
+    if (mPoint.smoothedLatencyMs > mOptions.targetLatencyMs) {
+        if (mPoint.samples >= mOptions.downgradeSamples && mPoint.level + 1 < levels) {
+            if (mSteppedUp) {
+                mUpgradeBackoff[mPoint.level] = min(32, mUpgradeBackoff[mPoint.level] * 2);
+            }
+            mSteppedUp = false;
+            moveTo(mPoint.level + 1);
+        }
+    }
+    else if (mPoint.smoothedLatencyMs < mOptions.targetLatencyMs * (1.0 - mOptions.hysteresis) && mPoint.level > 0) {
+        if (mPoint.samples >= mOptions.upgradeSamples * mUpgradeBackoff[mPoint.level - 1]) {
+            mUpgradeBackoff[mPoint.level] = 1;  // This level held up
+            mSteppedUp = true;
+            moveTo(mPoint.level - 1);
+        }
+    }
+}
+
+OllamaOperatingPoint OllamaAdaptiveController::getOperatingPoint() {
+    lock_guard<mutex> lock(mMutex);
+    return mPoint;
+}
+
+vector<OllamaAdaptiveSample> OllamaAdaptiveController::getHistory() {
+    lock_guard<mutex> lock(mMutex);
+    return vector<OllamaAdaptiveSample>(mHistory.begin(), mHistory.end());
+}
+
+void OllamaAdaptiveController::reset() {
+    lock_guard<mutex> lock(mMutex);
+    mHistory.clear();
+    mStart = chrono::steady_clock::now();
+    mUpgradeBackoff.clear();
+    mSteppedUp = false;
+    moveTo(0);
+}
+
+void OllamaAdaptiveController::moveTo(int level) {
+    unsigned long long changes = mPoint.changes + 1;
+    mPoint = OllamaOperatingPoint();
+    mPoint.level = level;
+    mPoint.changes = changes;
+    levelToSettings(mOptions, level, mPoint.quality, mPoint.scale);
+}
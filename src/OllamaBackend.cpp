@@ -0,0 +1,191 @@
+#include <OllamaClient/OllamaBackend.h>
+#include <OllamaClient/OllamaJson.h>
+#include <OllamaClient/OllamaHash.h>
+
+#include <sstream>
+#include <algorithm>
+
+static string parseError(const string& response) {
+    // Ollama: {"error":"..."}, OpenAI-compatible servers: {"error":{"message":"...",...}}
+    string error;
+    if (OllamaJson::findString(response, "error", error) || OllamaJson::findString(response, "message", error)) {
+        return "Error: " + error;
+    }
+    return "Error: Could not parse response content\nRaw response: " + response;
+}
+
+// Media type for a data URL from the first base64 characters (a PNG file starts with 89 50 4E 47 0D 0A 1A 0A)
+static const char* imageMimeType(const string& base64Image) {
+    return base64Image.compare(0, 11, "iVBORw0KGgo") == 0 ? "image/png" : "image/jpeg";
+}
+
+// Token count reported by the server; garbage (negative, NaN, absurdly large) counts as zero
+static unsigned long long tokenCount(double value) {
+    return value > 0.0 && value < 1e18 ? static_cast<unsigned long long>(value) : 0ULL;
+}
+
+// OllamaChatBackend
+
+string OllamaChatBackend::buildChatPayload(const string& model, const string& prompt, const string& base64Image, const OllamaOptions& options) {
+    // Create JSON payload using string building (lightweight approach)
+    ostringstream json;
+    json << "{\"messages\":[{\"role\":\"user\",";
+    if (!base64Image.empty()) {
+        json << "\"images\":[\"" << base64Image << "\"],";
+    }
+    json << "\"content\":\"" << OllamaJson::escape(prompt) << "\"}],\"stream\":false,\"model\":\"" << OllamaJson::escape(model) << "\"";
+    json << options.toJSONFields() << "}";
+
+    return json.str();
+}
+
+string OllamaChatBackend::parseResponseContent(const string& response) {
+    // Parse response JSON (look for the "content" field and decode its escapes)
+    string content;
+    if (OllamaJson::findString(response, "content", content)) {
+        return content;
+    }
+    return parseError(response);
+}
+
+// OllamaOpenAIBackend
+
+OllamaOpenAIBackend::OllamaOpenAIBackend(const OllamaOpenAIOptions& options)
+    : mOptions(options), mSlots(max(0, options.slotCount))
+{
+}
+
+string OllamaOpenAIBackend::buildChatPayload(const string& model, const string& prompt, const string& base64Image, const OllamaOptions& options) {
+    ostringstream json;
+    json << "{\"model\":\"" << OllamaJson::escape(model) << "\",\"messages\":[{\"role\":\"user\",\"content\":";
+    if (base64Image.empty()) {
+        json << "\"" << OllamaJson::escape(prompt) << "\"";
+    }
+    else {
+        json << "[{\"type\":\"text\",\"text\":\"" << OllamaJson::escape(prompt) << "\"},"
+             << "{\"type\":\"image_url\",\"image_url\":{\"url\":\"data:" << imageMimeType(base64Image) << ";base64," << base64Image << "\"}}]";
+    }
+    json << "}],\"stream\":false";
+
+    // Generation options at the top level, under their OpenAI names (numCtx has no per-request equivalent)
+    if (options.numPredict >= 0) json << ",\"max_tokens\":" << options.numPredict;
+    if (options.temperature >= 0.0f) json << ",\"temperature\":" << options.temperature;
+    if (options.topK > 0) json << ",\"top_k\":" << options.topK;
+    if (options.seed >= 0) json << ",\"seed\":" << options.seed;
+    if (!options.stop.empty()) {
+        json << ",\"stop\":[";
+        for (size_t i = 0; i < options.stop.size(); i++) {
+            if (i > 0) json << ",";
+            json << "\"" << OllamaJson::escape(options.stop[i]) << "\"";
+        }
+        json << "]";
+    }
+    if (!options.format.empty()) {
+        size_t start = options.format.find_first_not_of(" \t\r\n");
+        if (start != string::npos && options.format[start] == '{') {
+            json << ",\"response_format\":{\"type\":\"json_schema\",\"json_schema\":{\"name\":\"response\",\"schema\":" << options.format << "}}";
+        }
+        else {
+            json << ",\"response_format\":{\"type\":\"json_object\"}";
+        }
+    }
+
+    if (mOptions.cachePrompt) {
+        json << ",\"cache_prompt\":true";
+        int slot = pickSlot(model, prompt);
+        if (slot >= 0) {
+            json << ",\"id_slot\":" << slot;
+        }
+    }
+
+    json << "}";
+    return json.str();
+}
+
+int OllamaOpenAIBackend::pickSlot(const string& model, const string& prompt) {
+    if (mSlots.empty()) {
+        return -1;
+    }
+
+    unsigned long long prefix = OllamaHash::fnv1a(model + '\n' + prompt.substr(0, mOptions.affinityPrefixChars));
+
+    lock_guard<mutex> lock(mMutex);
+    size_t pick = 0;
+    bool found = false;
+    for (size_t i = 0; i < mSlots.size(); i++) {
+        if (mSlots[i].used && mSlots[i].prefix == prefix) {
+            pick = i;
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) {
+        // Least recently used slot (unused slots first)
+        for (size_t i = 1; i < mSlots.size(); i++) {
+            if (mSlots[i].lastUsed < mSlots[pick].lastUsed) {
+                pick = i;
+            }
+        }
+    }
+
+    mSlots[pick].prefix = prefix;
+    mSlots[pick].used = true;
+    mSlots[pick].lastUsed = ++mTick;
+    return static_cast<int>(pick);
+}
+
+string OllamaOpenAIBackend::parseResponseContent(const string& response) {
+    recordTimings(response);
+
+    string content;
+    if (OllamaJson::findString(response, "content", content)) {
+        return content;
+    }
+    return parseError(response);
+}
+
+void OllamaOpenAIBackend::recordTimings(const string& response) {
+    double cached = 0.0;
+    double evaluated = 0.0;
+    double promptMs = 0.0;
+    bool timed = false;
+
+    if (OllamaJson::findNumber(response, "prompt_n", evaluated)) {
+        // llama-server: "timings":{"cache_n":..,"prompt_n":..,"prompt_ms":..}
+        OllamaJson::findNumber(response, "cache_n", cached);
+        timed = OllamaJson::findNumber(response, "prompt_ms", promptMs);
+    }
+    else if (OllamaJson::findNumber(response, "prompt_tokens", evaluated)) {
+        // Other servers: "usage":{"prompt_tokens":..,"prompt_tokens_details":{"cached_tokens":..}}, cached tokens included
+        OllamaJson::findNumber(response, "cached_tokens", cached);
+        evaluated = max(0.0, evaluated - cached);
+    }
+    else {
+        return;
+    }
+
+    lock_guard<mutex> lock(mMutex);
+    mStats.responses++;
+    if (cached > 0.0) {
+        mStats.cacheHits++;
+    }
+    mStats.cachedTokens += tokenCount(cached);
+    mStats.evaluatedTokens += tokenCount(evaluated);
+    if (timed) {
+        mStats.promptEvalMs += promptMs;
+        if (evaluated > 0.0) {
+            mStats.savedMs += cached * promptMs / evaluated;
+        }
+    }
+}
+
+OllamaPromptCacheStats OllamaOpenAIBackend::getPromptCacheStats() {
+    lock_guard<mutex> lock(mMutex);
+    return mStats;
+}
+
+void OllamaOpenAIBackend::resetPromptCacheStats() {
+    lock_guard<mutex> lock(mMutex);
+    mStats = OllamaPromptCacheStats();
+}
@@ -0,0 +1,86 @@
+#include <OllamaClient/OllamaBatch.h>
+#include <OllamaClient/OllamaJson.h>
+#include <OllamaClient/OllamaClientBase.h>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cctype>
+
+// Windows specific includes - prevent winsock.h inclusion
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+
+#include "OllamaUtf8.h"
+
+vector<string> OllamaBatch::listImageFiles(const string& directory) {
+    vector<string> files;
+    string prefix = directory;
+    if (!prefix.empty() && prefix.back() != '/' && prefix.back() != '\\') {
+        prefix += "/";
+    }
+
+    WIN32_FIND_DATAW findData;
+    HANDLE find = FindFirstFileW(utf8ToWide(prefix + "*").c_str(), &findData);
+    if (find == INVALID_HANDLE_VALUE) {
+        return files;
+    }
+
+    do {
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            continue;
+        }
+
+        string name = wideToUtf8(findData.cFileName);
+        size_t dot = name.rfind('.');
+        if (dot == string::npos) {
+            continue;
+        }
+
+        string extension = name.substr(dot + 1);
+        transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+        if (extension == "jpg" || extension == "jpeg" || extension == "png" || extension == "bmp") {
+            files.push_back(prefix + name);
+        }
+    } while (FindNextFileW(find, &findData));
+
+    FindClose(find);
+
+    // Frame dumps are usually numbered, so name order is capture order
+    sort(files.begin(), files.end());
+    return files;
+}
+
+set<string> OllamaBatch::readCompleted(const string& outputPath) {
+    set<string> completed;
+    ifstream file(outputPath);
+    string line;
+
+    while (getline(file, line)) {
+        string input;
+        string response;
+        OllamaStructuredDecoder decoder;
+        decoder.bind("file", &input).bind("response", &response);
+
+        // A line cut off by a crash fails to decode, so its input is processed again
+        if (decoder.decode(line) && decoder.getMissingKeys().empty()) {
+            completed.insert(input);
+        }
+    }
+
+    return completed;
+}
+
+string OllamaBatch::formatResult(const string& input, const string& result, double loadMs, double requestMs) {
+    ostringstream line;
+    line << "{\"file\":\"" << OllamaJson::escape(input) << "\",";
+    line << (OllamaClientBase::isErrorResult(result) ? "\"error\":\"" : "\"response\":\"") << OllamaJson::escape(result) << "\",";
+    line << fixed << setprecision(1) << "\"loadMs\":" << loadMs << ",\"requestMs\":" << requestMs << "}";
+    return line.str();
+}
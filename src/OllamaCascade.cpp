@@ -0,0 +1,67 @@
+#include <OllamaClient/OllamaCascade.h>
+#include <OllamaClient/OllamaJson.h>
+#include <OllamaClient/OllamaClientBase.h>
+
+#include <regex>
+
+static bool containsPattern(const string& text, const string& pattern, bool& valid) {
+    try {
+        return regex_search(text, regex(pattern, regex::ECMAScript));
+    }
+    catch (const regex_error&) {
+        valid = false;
+        return false;
+    }
+}
+
+bool OllamaCascade::isAccepted(const OllamaCascadeOptions& options, const string& answer) {
+    if (OllamaClientBase::isErrorResult(answer)) {
+        return false;
+    }
+
+    if (answer.size() < options.minLength || (options.maxLength > 0 && answer.size() > options.maxLength)) {
+        return false;
+    }
+
+    if (!options.confidenceField.empty()) {
+        double confidence = 0.0;
+        if (!OllamaJson::findNumber(answer, options.confidenceField, confidence) || confidence < options.minConfidence) {
+            return false;
+        }
+    }
+
+    bool valid = true;
+    if (!options.acceptPattern.empty() && !containsPattern(answer, options.acceptPattern, valid)) {
+        return false;
+    }
+    if (!options.rejectPattern.empty() && (containsPattern(answer, options.rejectPattern, valid) || !valid)) {
+        return false;
+    }
+
+    return !options.accept || options.accept(answer);
+}
+
+void OllamaCascade::recordAccepted(double smallMs) {
+    lock_guard<mutex> lock(mMutex);
+    mStats.requests++;
+    mStats.accepted++;
+    mStats.smallModelMs += smallMs;
+}
+
+void OllamaCascade::recordEscalated(double smallMs, double largeMs) {
+    lock_guard<mutex> lock(mMutex);
+    mStats.requests++;
+    mStats.escalated++;
+    mStats.smallModelMs += smallMs;
+    mStats.largeModelMs += largeMs;
+}
+
+OllamaCascadeStats OllamaCascade::getStats() {
+    lock_guard<mutex> lock(mMutex);
+    return mStats;
+}
+
+void OllamaCascade::resetStats() {
+    lock_guard<mutex> lock(mMutex);
+    mStats = OllamaCascadeStats();
+}
@@ -1,8 +1,18 @@
 #include <OllamaClient/OllamaClientBase.h>
+#include <OllamaClient/OllamaJson.h>
+#include <OllamaClient/OllamaTrace.h>
+#include <OllamaClient/OllamaJpeg.h>
+#include <OllamaClient/OllamaEventLoop.h>
 
 // Note: We'll need a lightweight JSON library for the base class
 // For now, we'll use a simple JSON string building approach
 #include <sstream>
+#include <fstream>
+#include <random>
+#include <cstring>
+#include <memory>
+#include <condition_variable>
+#include <stdexcept>
 
 // Windows specific includes - prevent winsock.h inclusion
 #ifndef WIN32_LEAN_AND_MEAN
@@ -17,34 +27,266 @@
 #pragma comment(lib, "WinHttp.lib")
 #pragma comment(lib, "ws2_32.lib")
 
-// Internal helper function
-static wstring utf8ToWide(const string& str) {
-    if (str.empty()) return wstring();
-    int size_needed = MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), NULL, 0);
-    wstring wstrTo(size_needed, 0);
-    MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), &wstrTo[0], size_needed);
-    return wstrTo;
+#include "OllamaUtf8.h"
+
+// Internal helper functions
+static double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Where a request goes: identical bodies for different servers or backends are different requests
+static string requestTarget(const OllamaClientConfig& config) {
+    return config.host + ":" + to_string(config.port) + config.backend->getEndpoint();
 }
 
 OllamaClientBase::OllamaClientBase(const string& host, int port, const string& visionModel, const string& chatModel)
-    : mHost(host), mPort(port), mEndpoint("/api/chat"), mVisionModel(visionModel), mChatModel(chatModel)
 {
+    shared_ptr<OllamaClientConfig> config = make_shared<OllamaClientConfig>();
+    config->host = host;
+    config->port = port;
+    config->visionModel = visionModel;
+    config->chatModel = chatModel;
+    config->backend = make_shared<OllamaChatBackend>();
+    mConfig.store(config);
+}
+
+shared_ptr<const OllamaClientConfig> OllamaClientBase::getConfig()
+{
+    return mConfig.load();
+}
+
+void OllamaClientBase::setConfig(const OllamaClientConfig& config)
+{
+    updateConfig([&config](OllamaClientConfig& next) { next = config; });
+}
+
+void OllamaClientBase::updateConfig(function<void(OllamaClientConfig& config)> change)
+{
+    // Copy, change and swap in; if another thread published first, redo the change on its snapshot
+    shared_ptr<const OllamaClientConfig> current = mConfig.load();
+    while (true) {
+        shared_ptr<OllamaClientConfig> next = make_shared<OllamaClientConfig>(*current);
+        change(*next);
+        if (!next->backend) {
+            next->backend = make_shared<OllamaChatBackend>();
+        }
+        if (mConfig.compareExchange(current, next)) {
+            return;
+        }
+    }
+}
+
+void OllamaClientBase::setHost(const string& host, int port)
+{
+    updateConfig([&host, port](OllamaClientConfig& config) {
+        config.host = host;
+        config.port = port;
+        });
 }
 
 void OllamaClientBase::setVisionModel(const string& visionModel)
 {
-    mVisionModel = visionModel;
+    updateConfig([&visionModel](OllamaClientConfig& config) { config.visionModel = visionModel; });
 }
 
 string OllamaClientBase::getVisionModel()
 {
-    return mVisionModel;
+    return getConfig()->visionModel;
 }
 
-void OllamaClientBase::sendPrompt(const string& prompt, InferenceCallback callback, void * userData) {
+void OllamaClientBase::setChatModel(const string& chatModel)
+{
+    updateConfig([&chatModel](OllamaClientConfig& config) { config.chatModel = chatModel; });
+}
+
+string OllamaClientBase::getChatModel()
+{
+    return getConfig()->chatModel;
+}
+
+void OllamaClientBase::setOptions(const OllamaOptions& options)
+{
+    updateConfig([&options](OllamaClientConfig& config) { config.options = options; });
+}
+
+OllamaOptions OllamaClientBase::getOptions()
+{
+    return getConfig()->options;
+}
+
+void OllamaClientBase::setBackend(shared_ptr<OllamaBackend> backend)
+{
+    // A null backend is replaced with the default one by updateConfig
+    updateConfig([&backend](OllamaClientConfig& config) { config.backend = backend; });
+}
+
+shared_ptr<OllamaBackend> OllamaClientBase::getBackend()
+{
+    return getConfig()->backend;
+}
+
+void OllamaClientBase::setResilienceOptions(const OllamaResilienceOptions& options)
+{
+    lock_guard<mutex> lock(mResilienceMutex);
+    mResilienceOptions = options;
+}
+
+OllamaResilienceOptions OllamaClientBase::getResilienceOptions()
+{
+    lock_guard<mutex> lock(mResilienceMutex);
+    return mResilienceOptions;
+}
+
+OllamaResilienceStats OllamaClientBase::getResilienceStats()
+{
+    OllamaResilienceStats stats;
+    stats.breakerState = mBreaker.getState();
+    stats.inFlight = mAdmission.getInFlight();
+    stats.admitted = mAdmission.getAdmittedCount();
+    stats.rejectedInFlight = mAdmission.getRejectedCount();
+    stats.rejectedBreaker = mBreaker.getRejectedCount();
+    stats.retries = mRetries;
+    return stats;
+}
+
+bool OllamaClientBase::startTraceRecording(const string& path)
+{
+    shared_ptr<OllamaTraceRecorder> recorder = make_shared<OllamaTraceRecorder>();
+    if (!recorder->open(path)) {
+        return false;
+    }
+
+    // Requests already in flight finish recording into the previous recorder, which closes when released
+    mTraceRecorder.store(recorder);
+    return true;
+}
+
+void OllamaClientBase::stopTraceRecording()
+{
+    mTraceRecorder.store(shared_ptr<OllamaTraceRecorder>());
+}
+
+void OllamaClientBase::setCascadeOptions(const OllamaCascadeOptions& options)
+{
+    lock_guard<mutex> lock(mCascadeMutex);
+    mCascadeOptions = options;
+}
+
+OllamaCascadeOptions OllamaClientBase::getCascadeOptions()
+{
+    lock_guard<mutex> lock(mCascadeMutex);
+    return mCascadeOptions;
+}
+
+OllamaCascadeStats OllamaClientBase::getCascadeStats()
+{
+    return mCascade.getStats();
+}
+
+void OllamaClientBase::resetCascadeStats()
+{
+    mCascade.resetStats();
+}
+
+void OllamaClientBase::setAdaptiveOptions(const OllamaAdaptiveOptions& options)
+{
+    mAdaptive.setOptions(options);
+}
+
+OllamaAdaptiveOptions OllamaClientBase::getAdaptiveOptions()
+{
+    return mAdaptive.getOptions();
+}
+
+OllamaOperatingPoint OllamaClientBase::getOperatingPoint()
+{
+    return mAdaptive.getOperatingPoint();
+}
+
+vector<OllamaAdaptiveSample> OllamaClientBase::getAdaptiveHistory()
+{
+    return mAdaptive.getHistory();
+}
+
+bool OllamaClientBase::acquireOperatingPoint(ChatRequest& request)
+{
+    request.startedAt = chrono::steady_clock::now();
+    request.adaptive = mAdaptive.acquire(request.operatingPoint);
+    return request.adaptive;
+}
+
+void OllamaClientBase::recordOperatingPoint(const ChatRequest& request, const string& result)
+{
+    // Failed requests say nothing about how long a frame of this size takes
+    if (request.adaptive && !isErrorResult(result)) {
+        mAdaptive.record(request.operatingPoint, request.base64Image.size(), elapsedMs(request.startedAt));
+    }
+}
+
+void OllamaClientBase::setEventLoop(shared_ptr<OllamaEventLoop> loop)
+{
+    mEventLoop.store(loop);
+}
+
+shared_ptr<OllamaEventLoop> OllamaClientBase::getEventLoop()
+{
+    return mEventLoop.load();
+}
+
+void OllamaClientBase::setContentEncodingOptions(const OllamaContentEncodingOptions& options)
+{
+    lock_guard<mutex> lock(mContentMutex);
+    mContentOptions = options;
+}
+
+OllamaContentEncodingOptions OllamaClientBase::getContentEncodingOptions()
+{
+    lock_guard<mutex> lock(mContentMutex);
+    return mContentOptions;
+}
+
+OllamaContentEncodingStats OllamaClientBase::getContentEncodingStats()
+{
+    lock_guard<mutex> lock(mContentMutex);
+    return mContentStats;
+}
+
+void OllamaClientBase::resetContentEncodingStats()
+{
+    lock_guard<mutex> lock(mContentMutex);
+    mContentStats = OllamaContentEncodingStats();
+}
+
+void OllamaClientBase::setDeduplication(bool enabled)
+{
+    mDeduplicate = enabled;
+}
+
+bool OllamaClientBase::getDeduplication()
+{
+    return mDeduplicate;
+}
+
+OllamaSingleFlightStats OllamaClientBase::getDeduplicationStats()
+{
+    return mSingleFlight.getStats();
+}
+
+void OllamaClientBase::runAsync(function<string()> work, InferenceCallback callback, void * userData) {
+    // Admission happens on the calling thread so an overloaded client never piles up blocked threads
+    OllamaResilienceOptions options = getResilienceOptions();
+    if (!mAdmission.acquire(options.maxInFlight, options.maxWaitMs)) {
+        callback("Error: Too many requests in flight", userData);
+        return;
+    }
+
     // Create a thread to handle the HTTP request
-    thread worker([this, prompt, callback, userData]() {
-        string result = sendPromptInternal(prompt);
+    thread worker([this, work, callback, userData]() {
+        string result;
+        {
+            OllamaAdmissionSlot slot(mAdmission);
+            result = work();
+        }
         callback(result, userData);
         });
 
@@ -52,62 +294,944 @@ void OllamaClientBase::sendPrompt(const string& prompt, InferenceCallback callba
     worker.detach();
 }
 
+string OllamaClientBase::runSync(function<string()> work) {
+    OllamaResilienceOptions options = getResilienceOptions();
+    if (!mAdmission.acquire(options.maxInFlight, options.maxWaitMs)) {
+        return "Error: Too many requests in flight";
+    }
+
+    OllamaAdmissionSlot slot(mAdmission);
+    return work();
+}
+
+void OllamaClientBase::runAsyncRequest(function<string()> buildPayload, InferenceCallback callback, void * userData, bool buildOnWorker) {
+    shared_ptr<OllamaEventLoop> loop = mEventLoop.load();
+    if (!loop) {
+        runAsync([this, buildPayload]() {
+            try {
+                return sendJSONPayload(getConfig(), buildPayload());
+            }
+            catch (const exception& e) {
+                return "Error: " + string(e.what());
+            }
+            }, callback, userData);
+        return;
+    }
+
+    runOnEventLoop(loop, [this, loop, buildPayload]() -> LoopExchange {
+        shared_ptr<const OllamaClientConfig> config = getConfig();
+        shared_ptr<const string> payload = make_shared<const string>(buildPayload());
+        return [this, loop, config, payload](function<void(const string&)> done) { sendTracedOnEventLoop(loop, config, payload, done); };
+        }, buildOnWorker, callback, userData);
+}
+
+void OllamaClientBase::runAsyncChat(function<ChatRequest()> buildRequest, InferenceCallback callback, void * userData, bool buildOnWorker) {
+    shared_ptr<OllamaEventLoop> loop = mEventLoop.load();
+    if (!loop) {
+        runAsync([this, buildRequest]() {
+            try {
+                return sendChat(buildRequest());
+            }
+            catch (const exception& e) {
+                return "Error: " + string(e.what());
+            }
+            }, callback, userData);
+        return;
+    }
+
+    runOnEventLoop(loop, [this, loop, buildRequest]() -> LoopExchange {
+        shared_ptr<const PreparedChat> chat = prepareChat(buildRequest());
+        return [this, loop, chat](function<void(const string&)> done) { sendChatOnEventLoop(loop, chat, done); };
+        }, buildOnWorker, callback, userData);
+}
+
+void OllamaClientBase::runOnEventLoop(shared_ptr<OllamaEventLoop> loop, function<LoopExchange()> prepare, bool prepareOnWorker,
+    InferenceCallback callback, void * userData) {
+    // On a loop thread a wait would stall every exchange on it, including those that would free a slot
+    OllamaResilienceOptions options = getResilienceOptions();
+    if (!mAdmission.acquire(options.maxInFlight, loop->isLoopThread() ? 0 : options.maxWaitMs)) {
+        callback("Error: Too many requests in flight", userData);
+        return;
+    }
+
+    function<void(const string&)> done = [this, callback, userData](const string& result) {
+        mAdmission.release();
+        callback(result, userData);
+    };
+
+    // Encoding and JSON happen here, off the loop; only the exchange is posted to it
+    function<void()> start = [loop, prepare, done]() {
+        LoopExchange exchange;
+        string error;
+        try {
+            exchange = prepare();
+        }
+        catch (const exception& e) {
+            error = "Error: " + string(e.what());     // Thrown while building the request, before anything was sent
+        }
+
+        loop->post([exchange, error, done]() {
+            if (exchange) {
+                exchange(done);
+            }
+            else {
+                done(error);
+            }
+            });
+    };
+
+    if (!prepareOnWorker) {
+        start();
+        return;
+    }
+
+    // The thread lives while the image is encoded; the wait for the server holds none
+    thread worker(start);
+    worker.detach();
+}
+
+void OllamaClientBase::sendTracedOnEventLoop(shared_ptr<OllamaEventLoop> loop, shared_ptr<const OllamaClientConfig> config, shared_ptr<const string> payload,
+    function<void(const string& result)> done, shared_ptr<string> rawResponse) {
+    if (mDeduplicate && !rawResponse) {
+        // Attach to an identical request in flight, or send this one for everyone who attaches meanwhile
+        unsigned long long key = 0;
+        if (!mSingleFlight.join(requestTarget(*config), *payload, done, key)) {
+            return;
+        }
+        done = [this, payload, key](const string& result) { mSingleFlight.complete(key, result); };
+    }
+
+    shared_ptr<OllamaTraceRecorder> recorder = mTraceRecorder.load();
+    double arrivalMs = recorder ? OllamaTraceRecorder::nowMs() : 0.0;
+    auto start = chrono::steady_clock::now();
+
+    sendOnEventLoop(loop, config, payload, 0, [payload, recorder, arrivalMs, start, done, rawResponse](const string& result, const HttpOutcome& outcome) {
+        if (recorder) {
+            OllamaTraceEntry entry;
+            entry.arrivalMs = arrivalMs;
+            entry.latencyMs = elapsedMs(start);
+            entry.statusCode = outcome.statusCode;
+            entry.request = *payload;
+            entry.response = outcome.rawResponse;
+            recorder->record(entry);
+        }
+
+        if (rawResponse) {
+            *rawResponse = outcome.rawResponse;
+        }
+        done(result);
+        });
+}
+
+shared_ptr<const OllamaClientBase::PreparedChat> OllamaClientBase::prepareChat(ChatRequest request) {
+    shared_ptr<PreparedChat> chat = make_shared<PreparedChat>();
+    chat->config = getConfig();
+    chat->cascade = getCascadeOptions();
+
+    const OllamaClientConfig& config = *chat->config;
+    string smallModel = request.vision ? chat->cascade.visionModel : chat->cascade.chatModel;
+    if (!smallModel.empty()) {
+        chat->smallPayload = make_shared<const string>(buildChatPayload(config, smallModel, request.prompt, request.base64Image));
+    }
+    chat->payload = make_shared<const string>(buildChatPayload(config, request.vision ? config.visionModel : config.chatModel, request.prompt, request.base64Image));
+    chat->request = move(request);
+    return chat;
+}
+
+void OllamaClientBase::sendChatOnEventLoop(shared_ptr<OllamaEventLoop> loop, shared_ptr<const PreparedChat> chat, function<void(const string& result)> done) {
+    if (chat->request.adaptive) {
+        done = [this, chat, done](const string& result) {
+            recordOperatingPoint(chat->request, result);
+            done(result);
+        };
+    }
+
+    if (!chat->smallPayload) {
+        sendTracedOnEventLoop(loop, chat->config, chat->payload, done);
+        return;
+    }
+
+    auto start = chrono::steady_clock::now();
+    sendTracedOnEventLoop(loop, chat->config, chat->smallPayload, [this, loop, chat, start, done](const string& answer) {
+        double smallMs = elapsedMs(start);
+        if (OllamaCascade::isAccepted(chat->cascade, answer)) {
+            mCascade.recordAccepted(smallMs);
+            done(answer);
+            return;
+        }
+
+        auto escalated = chrono::steady_clock::now();
+        sendTracedOnEventLoop(loop, chat->config, chat->payload, [this, smallMs, escalated, done](const string& result) {
+            mCascade.recordEscalated(smallMs, elapsedMs(escalated));
+            done(result);
+            });
+        });
+}
+
+void OllamaClientBase::sendPrompt(const string& prompt, InferenceCallback callback, void * userData) {
+    runAsyncChat([prompt]() {
+        ChatRequest request;
+        request.prompt = prompt;
+        return request;
+        }, callback, userData, false);
+}
+
 string OllamaClientBase::sendPromptSync(const string& prompt) {
-    return sendPromptInternal(prompt);
+    return runSync([this, &prompt]() { return sendPromptInternal(prompt); });
+}
+
+void OllamaClientBase::sendRawRequest(const string& payload, InferenceCallback callback, void * userData) {
+    runAsyncRequest([payload]() { return payload; }, callback, userData, false);
+}
+
+string OllamaClientBase::sendRawRequestSync(const string& payload) {
+    return runSync([this, &payload]() { return sendJSONPayload(getConfig(), payload); });
+}
+
+void OllamaClientBase::sendRawExchange(const string& payload, ExchangeCallback callback, void * userData) {
+    // Filled in before the callback runs; stays empty if the request was rejected before it was sent
+    shared_ptr<string> rawResponse = make_shared<string>();
+    InferenceCallback withResponse = [rawResponse, callback](const string& result, void * userData) {
+        callback(result, *rawResponse, userData);
+    };
+
+    shared_ptr<OllamaEventLoop> loop = mEventLoop.load();
+    if (!loop) {
+        runAsync([this, payload, rawResponse]() { return sendJSONPayloadTraced(getConfig(), payload, rawResponse.get()); }, withResponse, userData);
+        return;
+    }
+
+    runOnEventLoop(loop, [this, loop, payload, rawResponse]() -> LoopExchange {
+        shared_ptr<const OllamaClientConfig> config = getConfig();
+        shared_ptr<const string> body = make_shared<const string>(payload);
+        return [this, loop, config, body, rawResponse](function<void(const string&)> done) { sendTracedOnEventLoop(loop, config, body, done, rawResponse); };
+        }, false, withResponse, userData);
+}
+
+string OllamaClientBase::buildRequestPayload(const string& prompt, const string& base64Image) {
+    shared_ptr<const OllamaClientConfig> config = getConfig();
+    return buildChatPayload(*config, base64Image.empty() ? config->chatModel : config->visionModel, prompt, base64Image);
+}
+
+void OllamaClientBase::sendTiledForInference(const OllamaPixelView& pixels, const string& prompt, const OllamaTileOptions& options, TiledCallback callback, void * userData) {
+    if (!pixels.isValid()) {
+        OllamaTiledResult result;
+        result.merged = "Error: Invalid pixel buffer";
+        callback(result, userData);
+        return;
+    }
+
+    // Copy the pixels (tightly packed) so the caller can reuse its buffer immediately
+    size_t rowSize = static_cast<size_t>(pixels.width) * pixels.channels;
+    shared_ptr<vector<unsigned char>> copy = make_shared<vector<unsigned char>>(rowSize * pixels.height);
+    for (int y = 0; y < pixels.height; y++) {
+        memcpy(copy->data() + y * rowSize, pixels.getRow(y), rowSize);
+    }
+    OllamaPixelView view(copy->data(), pixels.width, pixels.height, pixels.channels, rowSize, pixels.bgr);
+
+    // Tile requests pass admission control individually, so the coordinating thread does not take a slot
+    thread worker([this, copy, view, prompt, options, callback, userData]() {
+        OllamaTiledResult result = sendTiledForInferenceInternal(view, prompt, options);
+        callback(result, userData);
+        });
+
+    worker.detach();
+}
+
+OllamaTiledResult OllamaClientBase::sendTiledForInferenceSync(const OllamaPixelView& pixels, const string& prompt, const OllamaTileOptions& options) {
+    return sendTiledForInferenceInternal(pixels, prompt, options);
+}
+
+string OllamaClientBase::encodePixelViewToBase64Jpeg(const OllamaPixelView& pixels, float jpegQuality) {
+    string jpeg = OllamaJpegEncoder::encode(pixels, jpegQuality);
+    return base64_encode(reinterpret_cast<const unsigned char*>(jpeg.data()), jpeg.size());
+}
+
+string OllamaClientBase::encodePixelViewToBase64Image(const OllamaPixelView& pixels, float jpegQuality) {
+    OllamaContentEncodingOptions options = getContentEncodingOptions();
+    if (!options.enabled) {
+        return encodePixelViewToBase64Jpeg(pixels, jpegQuality);
+    }
+
+    auto start = chrono::steady_clock::now();
+    OllamaImageContent content = OllamaContentEncoder::analyze(pixels, options);
+
+    string base64Image;
+    OllamaContentFormat format = OllamaContentFormat::ColorJpeg;
+    if (content.isNatural()) {
+        // Photos and camera frames keep the framework encoder
+        base64Image = encodePixelViewToBase64Jpeg(pixels, jpegQuality);
+    }
+    else {
+        OllamaContentEncodeResult encoded = OllamaContentEncoder::encode(pixels, jpegQuality, content);
+        format = encoded.format;
+        base64Image = base64_encode(reinterpret_cast<const unsigned char*>(encoded.bytes.data()), encoded.bytes.size());
+    }
+
+    if (!base64Image.empty()) {
+        lock_guard<mutex> lock(mContentMutex);
+        switch (format) {
+            case OllamaContentFormat::GrayJpeg: mContentStats.grayJpeg++; break;
+            case OllamaContentFormat::Png: mContentStats.png++; break;
+            default: mContentStats.colorJpeg++; break;
+        }
+        mContentStats.bytes += base64Image.size();
+        mContentStats.encodeMs += elapsedMs(start);
+    }
+    return base64Image;
+}
+
+void OllamaClientBase::sendYuvForInference(const OllamaYuvView& frame, const string& prompt, InferenceCallback callback, void * userData) {
+    if (!frame.isValid()) {
+        callback("Error: Invalid YUV frame", userData);
+        return;
+    }
+
+    // Copy the planes (tightly packed) so the caller can hand the capture buffer back immediately
+    size_t totalSize = 0;
+    for (int plane = 0; plane < frame.getPlaneCount(); plane++) {
+        totalSize += frame.getPlaneRowBytes(plane) * frame.getPlaneRows(plane);
+    }
+
+    shared_ptr<vector<unsigned char>> copy = make_shared<vector<unsigned char>>(totalSize);
+    OllamaYuvView view = frame;
+    unsigned char* destination = copy->data();
+    for (int plane = 0; plane < frame.getPlaneCount(); plane++) {
+        size_t rowBytes = frame.getPlaneRowBytes(plane);
+        for (int y = 0; y < frame.getPlaneRows(plane); y++) {
+            memcpy(destination + y * rowBytes, frame.planes[plane] + y * frame.getStride(plane), rowBytes);
+        }
+        view.planes[plane] = destination;
+        view.strides[plane] = rowBytes;
+        destination += rowBytes * frame.getPlaneRows(plane);
+    }
+
+    runAsyncChat([this, copy, view, prompt]() { return buildYuvRequest(view, prompt); }, callback, userData);
+}
+
+string OllamaClientBase::sendYuvForInferenceSync(const OllamaYuvView& frame, const string& prompt) {
+    if (!frame.isValid()) {
+        return "Error: Invalid YUV frame";
+    }
+    return runSync([this, &frame, &prompt]() {
+        try {
+            return sendChat(buildYuvRequest(frame, prompt));
+        }
+        catch (const exception& e) {
+            return "Error: " + string(e.what());
+        }
+        });
+}
+
+OllamaClientBase::ChatRequest OllamaClientBase::buildYuvRequest(const OllamaYuvView& frame, const string& prompt) {
+    ChatRequest request;
+    request.vision = true;
+    request.prompt = prompt;
+
+    if (!acquireOperatingPoint(request)) {
+        request.base64Image = yuvToBase64Jpeg(frame, 0.8f);
+    }
+    else if (request.operatingPoint.scale < 1.0f) {
+        vector<unsigned char> storage;
+        OllamaYuvView scaled = frame.resized(max(1, static_cast<int>(frame.width * request.operatingPoint.scale + 0.5f)),
+            max(1, static_cast<int>(frame.height * request.operatingPoint.scale + 0.5f)), storage);
+        request.base64Image = yuvToBase64Jpeg(scaled, request.operatingPoint.quality);
+    }
+    else {
+        request.base64Image = yuvToBase64Jpeg(frame, request.operatingPoint.quality);
+    }
+    return request;
+}
+
+string OllamaClientBase::yuvToBase64Jpeg(const OllamaYuvView& frame, float jpegQuality) {
+    string jpeg = OllamaJpegEncoder::encode(frame, jpegQuality);
+    return base64_encode(reinterpret_cast<const unsigned char*>(jpeg.data()), jpeg.size());
+}
+
+void OllamaClientBase::sendEncodedImageForInference(const string& path, const string& prompt, InferenceCallback callback, void * userData) {
+    // Mapped and encoded on the worker (or loop) thread
+    runAsyncChat([this, path, prompt]() { return buildEncodedImageRequest(path, prompt); }, callback, userData);
+}
+
+string OllamaClientBase::sendEncodedImageForInferenceSync(const string& path, const string& prompt) {
+    return runSync([this, &path, &prompt]() {
+        try {
+            return sendChat(buildEncodedImageRequest(path, prompt));
+        }
+        catch (const exception& e) {
+            return "Error: " + string(e.what());
+        }
+        });
+}
+
+void OllamaClientBase::sendEncodedImageForInference(const unsigned char* data, size_t size, const string& prompt, InferenceCallback callback, void * userData) {
+    OllamaEncodedImageInfo info;
+    if (!OllamaEncodedImage::inspect(data, size, info)) {
+        callback("Error: " + info.error, userData);
+        return;
+    }
+
+    // Copy the bytes so the caller can release its buffer immediately
+    shared_ptr<vector<unsigned char>> copy = make_shared<vector<unsigned char>>(data, data + size);
+    runAsyncChat([this, copy, prompt]() { return buildEncodedImageRequest(copy->data(), copy->size(), prompt); }, callback, userData);
+}
+
+string OllamaClientBase::sendEncodedImageForInferenceSync(const unsigned char* data, size_t size, const string& prompt) {
+    return runSync([this, data, size, &prompt]() {
+        try {
+            return sendChat(buildEncodedImageRequest(data, size, prompt));
+        }
+        catch (const exception& e) {
+            return "Error: " + string(e.what());
+        }
+        });
+}
+
+OllamaClientBase::ChatRequest OllamaClientBase::buildEncodedImageRequest(const unsigned char* data, size_t size, const string& prompt) {
+    OllamaEncodedImageInfo info;
+    if (!OllamaEncodedImage::inspect(data, size, info)) {
+        throw runtime_error(info.error);
+    }
+
+    ChatRequest request;
+    request.vision = true;
+    request.prompt = prompt;
+    request.base64Image = base64_encode(data, size);
+    return request;
+}
+
+OllamaClientBase::ChatRequest OllamaClientBase::buildEncodedImageRequest(const string& path, const string& prompt) {
+    // The mapping is released as soon as the bytes are base64-encoded
+    OllamaMappedFile file(path);
+    if (!file.isOpen()) {
+        throw runtime_error(file.getError());
+    }
+    return buildEncodedImageRequest(file.getData(), file.getSize(), prompt);
+}
+
+OllamaTiledResult OllamaClientBase::sendTiledForInferenceInternal(const OllamaPixelView& pixels, const string& prompt, const OllamaTileOptions& options) {
+    OllamaTiledResult tiled;
+    if (!pixels.isValid()) {
+        tiled.merged = "Error: Invalid pixel buffer";
+        return tiled;
+    }
+
+    tiled.tiles = OllamaTiler::computeTiles(pixels.width, pixels.height, options);
+    size_t count = tiled.tiles.size();
+
+    // Encoders fill slots in tile order; request workers wait for their tile's slot,
+    // so the first request starts as soon as the first tile is encoded
+    vector<string> encoded(count);
+    vector<char> ready(count, 0);
+    mutex readyMutex;
+    condition_variable readyChanged;
+    atomic<size_t> nextEncode(0);
+    atomic<size_t> nextRequest(0);
+
+    auto start = chrono::steady_clock::now();
+
+    size_t encodeThreads = options.encodeThreads > 0 ? options.encodeThreads : max(1u, thread::hardware_concurrency());
+    encodeThreads = min(encodeThreads, count);
+
+    vector<thread> encoders;
+    for (size_t t = 0; t < encodeThreads; t++) {
+        encoders.emplace_back([&]() {
+            for (size_t i = nextEncode++; i < count; i = nextEncode++) {
+                OllamaTileResult& tile = tiled.tiles[i];
+                auto encodeStart = chrono::steady_clock::now();
+                string base64Image = encodePixelViewToBase64Image(pixels.crop(tile.x, tile.y, tile.width, tile.height), options.jpegQuality);
+                tile.encodeMs = elapsedMs(encodeStart);
+
+                {
+                    lock_guard<mutex> lock(readyMutex);
+                    encoded[i] = move(base64Image);
+                    ready[i] = 1;
+                }
+                readyChanged.notify_all();
+            }
+            });
+    }
+
+    size_t fanOut = limitFanOut(options.maxConcurrent, count);
+
+    vector<thread> requesters;
+    for (size_t t = 0; t < fanOut; t++) {
+        requesters.emplace_back([&]() {
+            for (size_t i = nextRequest++; i < count; i = nextRequest++) {
+                string base64Image;
+                {
+                    unique_lock<mutex> lock(readyMutex);
+                    readyChanged.wait(lock, [&]() { return ready[i] != 0; });
+                    base64Image = move(encoded[i]);
+                }
+
+                OllamaTileResult& tile = tiled.tiles[i];
+                auto requestStart = chrono::steady_clock::now();
+                if (base64Image.empty()) {
+                    tile.result = "Error: Failed to encode tile";
+                }
+                else {
+                    tile.result = runSync([&]() { return sendImageForInferenceInternal(base64Image, prompt); });
+                }
+                tile.requestMs = elapsedMs(requestStart);
+            }
+            });
+    }
+
+    for (thread& encoder : encoders) encoder.join();
+    for (thread& requester : requesters) requester.join();
+
+    tiled.wallClockMs = elapsedMs(start);
+    for (const OllamaTileResult& tile : tiled.tiles) {
+        tiled.sequentialMs += tile.encodeMs + tile.requestMs;
+    }
+
+    // Optional merge step: one chat request over all tile answers
+    if (!options.mergePrompt.empty()) {
+        ostringstream mergeInput;
+        mergeInput << options.mergePrompt << "\n\nThe image (" << pixels.width << "x" << pixels.height
+            << " pixels) was analyzed in " << count << " overlapping tiles:\n";
+        for (const OllamaTileResult& tile : tiled.tiles) {
+            mergeInput << "\nTile at x=" << tile.x << " y=" << tile.y << " (" << tile.width << "x" << tile.height << "): " << tile.result << "\n";
+        }
+
+        auto mergeStart = chrono::steady_clock::now();
+        string mergePayload = mergeInput.str();
+        tiled.merged = runSync([&]() { return sendPromptInternal(mergePayload); });
+        tiled.mergeMs = elapsedMs(mergeStart);
+    }
+
+    return tiled;
+}
+
+size_t OllamaClientBase::limitFanOut(int maxConcurrent, size_t count) {
+    // Fan-out never exceeds the client's in-flight limit, which would only turn requests into rejections
+    size_t fanOut = static_cast<size_t>(max(1, maxConcurrent));
+    int maxInFlight = getResilienceOptions().maxInFlight;
+    if (maxInFlight > 0) {
+        fanOut = min(fanOut, static_cast<size_t>(maxInFlight));
+    }
+    return min(fanOut, count);
+}
+
+void OllamaClientBase::sendPromptsConcurrently(const vector<string>& prompts, int maxConcurrent, vector<OllamaChunkResult>& results) {
+    size_t count = prompts.size();
+    results.resize(count);
+    atomic<size_t> next(0);
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> requesters;
+    size_t fanOut = limitFanOut(maxConcurrent, count);
+    for (size_t t = 0; t < fanOut; t++) {
+        requesters.emplace_back([&]() {
+            for (size_t i = next++; i < count; i = next++) {
+                OllamaChunkResult& request = results[i];
+                auto requestStart = chrono::steady_clock::now();
+                request.startMs = chrono::duration<double, milli>(requestStart - start).count();
+                request.result = runSync([&]() { return sendPromptInternal(prompts[i]); });
+                request.requestMs = elapsedMs(requestStart);
+            }
+            });
+    }
+
+    for (thread& requester : requesters) requester.join();
+}
+
+void OllamaClientBase::sendMapReduce(const string& text, const string& prompt, const OllamaMapReduceOptions& options, MapReduceCallback callback, void * userData) {
+    // Chunk requests pass admission control individually, so the coordinating thread does not take a slot
+    thread worker([this, text, prompt, options, callback, userData]() {
+        OllamaMapReduceResult result = sendMapReduceSync(text, prompt, options);
+        callback(result, userData);
+        });
+
+    worker.detach();
+}
+
+OllamaMapReduceResult OllamaClientBase::sendMapReduceSync(const string& text, const string& prompt, const OllamaMapReduceOptions& options) {
+    OllamaMapReduceResult mapped;
+    size_t maxChars = OllamaTextSplitter::getMaxChunkChars(options, getOptions().numCtx);
+    mapped.chunks = OllamaTextSplitter::split(text, maxChars);
+    size_t count = mapped.chunks.size();
+    if (count == 0) {
+        mapped.reduced = "Error: Empty document";
+        return mapped;
+    }
+
+    // Map: the prompt on every chunk
+    vector<string> prompts;
+    for (const OllamaChunkResult& chunk : mapped.chunks) {
+        ostringstream chunkPrompt;
+        chunkPrompt << prompt << "\n\nPart " << chunk.index + 1 << " of " << count << " of the document:\n\n" << text.substr(chunk.offset, chunk.length);
+        prompts.push_back(chunkPrompt.str());
+    }
+
+    auto start = chrono::steady_clock::now();
+    vector<OllamaChunkResult> answers;
+    sendPromptsConcurrently(prompts, options.maxConcurrent, answers);
+    mapped.wallClockMs = elapsedMs(start);
+
+    for (size_t i = 0; i < count; i++) {
+        mapped.chunks[i].result = move(answers[i].result);
+        mapped.chunks[i].startMs = answers[i].startMs;
+        mapped.chunks[i].requestMs = answers[i].requestMs;
+        mapped.sequentialMs += answers[i].requestMs;
+    }
+
+    if (options.reducePrompt.empty()) {
+        return mapped;
+    }
+
+    // Reduce: partial answers labelled with the parts they cover; failed parts are marked rather than dropped
+    struct Partial {
+        size_t first;
+        size_t last;
+        string answer;
+    };
+    vector<Partial> partials;
+    for (const OllamaChunkResult& chunk : mapped.chunks) {
+        bool failed = isErrorResult(chunk.result);
+        partials.push_back({ chunk.index + 1, chunk.index + 1, failed ? "(no answer)" : chunk.result });
+    }
+
+    auto label = [](const Partial& partial) {
+        return partial.first == partial.last ? "Part " + to_string(partial.first) : "Parts " + to_string(partial.first) + " to " + to_string(partial.last);
+    };
+    auto reduceInput = [&](const vector<Partial>& group) {
+        ostringstream input;
+        input << options.reducePrompt << "\n\nThe request for each part was: " << prompt
+            << "\n\nThe document was processed in " << count << " parts. Answers:\n";
+        for (const Partial& partial : group) {
+            input << "\n" << label(partial) << ": " << partial.answer << "\n";
+        }
+        return input.str();
+    };
+
+    auto reduceStart = chrono::steady_clock::now();
+    while (true) {
+        mapped.reduceRounds++;
+
+        // Group consecutive answers into requests of at most maxChars
+        vector<vector<Partial>> groups(1);
+        size_t groupChars = 0;
+        for (Partial& partial : partials) {
+            size_t size = partial.answer.size() + 16;
+            if (!groups.back().empty() && groupChars + size > maxChars) {
+                groups.emplace_back();
+                groupChars = 0;
+            }
+            groups.back().push_back(move(partial));
+            groupChars += size;
+        }
+
+        // Everything fits, or grouping cannot shrink it any further: one final request
+        if (groups.size() == 1 || groups.size() == partials.size()) {
+            vector<Partial> all;
+            for (vector<Partial>& group : groups) {
+                for (Partial& partial : group) all.push_back(move(partial));
+            }
+            string input = reduceInput(all);
+            mapped.reduced = runSync([&]() { return sendPromptInternal(input); });
+            break;
+        }
+
+        vector<string> groupPrompts;
+        for (const vector<Partial>& group : groups) {
+            groupPrompts.push_back(reduceInput(group));
+        }
+        vector<OllamaChunkResult> groupAnswers;
+        sendPromptsConcurrently(groupPrompts, options.maxConcurrent, groupAnswers);
+
+        partials.clear();
+        for (size_t g = 0; g < groups.size(); g++) {
+            bool failed = isErrorResult(groupAnswers[g].result);
+            partials.push_back({ groups[g].front().first, groups[g].back().last, failed ? "(no answer)" : groupAnswers[g].result });
+        }
+    }
+    mapped.reduceMs = elapsedMs(reduceStart);
+
+    return mapped;
+}
+
+void OllamaClientBase::sendBatchForInference(const vector<string>& inputs, const string& prompt, const OllamaBatchOptions& options, BatchCallback callback, void * userData) {
+    // Requests pass admission control individually, so the coordinating thread does not take a slot
+    thread worker([this, inputs, prompt, options, callback, userData]() {
+        OllamaBatchReport report = sendBatchForInferenceSync(inputs, prompt, options);
+        callback(report, userData);
+        });
+
+    worker.detach();
+}
+
+string OllamaClientBase::loadImageFileToBase64Jpeg(const string& path, float) {
+    OllamaMappedFile file(path);
+    if (!file.isOpen()) {
+        return "";
+    }
+
+    // JPEG files go out as stored: no decode, no re-encode, no quality loss
+    OllamaEncodedImageInfo info;
+    if (!OllamaEncodedImage::inspect(file.getData(), file.getSize(), info) || info.format != OllamaEncodedImageInfo::Jpeg) {
+        return "";
+    }
+
+    return base64_encode(file.getData(), file.getSize());
+}
+
+OllamaBatchReport OllamaClientBase::sendBatchForInferenceSync(const vector<string>& inputs, const string& prompt, const OllamaBatchOptions& options) {
+    OllamaBatchReport report;
+    report.total = inputs.size();
+
+    // Inputs still to do, in input order
+    vector<string> pending;
+    set<string> completed;
+    if (options.resume) {
+        completed = OllamaBatch::readCompleted(options.outputPath);
+    }
+    for (const string& input : inputs) {
+        if (completed.count(input)) {
+            report.skipped++;
+        }
+        else {
+            pending.push_back(input);
+        }
+    }
+
+    // Continue after a line cut off by a crash on a new line
+    bool needsNewline = false;
+    if (options.resume) {
+        ifstream existing(options.outputPath, ios::binary | ios::ate);
+        if (existing && existing.tellg() > 0) {
+            existing.seekg(-1, ios::end);
+            needsNewline = existing.get() != '\n';
+        }
+    }
+
+    ofstream output(options.outputPath, ios::binary | (options.resume ? ios::app : ios::trunc));
+    if (!output) {
+        report.error = "Error: Could not open " + options.outputPath;
+        return report;
+    }
+    if (needsNewline) {
+        output << "\n";
+    }
+
+    size_t count = pending.size();
+    if (count == 0) {
+        return report;
+    }
+
+    // Inputs move through the slots in order; loading runs at most maxBuffered slots ahead of writing
+    struct BatchSlot {
+        string image;
+        string result;
+        double loadMs = 0.0;
+        double requestMs = 0.0;
+        bool loaded = false;
+        bool done = false;
+    };
+    vector<BatchSlot> slots(count);
+    mutex slotMutex;
+    condition_variable slotChanged;
+    size_t written = 0;
+    atomic<size_t> nextLoad(0);
+    atomic<size_t> nextRequest(0);
+    size_t window = static_cast<size_t>(max(1, options.maxBuffered));
+
+    auto start = chrono::steady_clock::now();
+
+    size_t loadThreads = options.loadThreads > 0 ? options.loadThreads : max(1u, thread::hardware_concurrency());
+    loadThreads = min(loadThreads, count);
+
+    vector<thread> loaders;
+    for (size_t t = 0; t < loadThreads; t++) {
+        loaders.emplace_back([&]() {
+            double busyMs = 0.0;
+            for (size_t i = nextLoad++; i < count; i = nextLoad++) {
+                {
+                    unique_lock<mutex> lock(slotMutex);
+                    slotChanged.wait(lock, [&]() { return i < written + window; });
+                }
+
+                auto loadStart = chrono::steady_clock::now();
+                string base64Image;
+                try {
+                    base64Image = options.loadInput ? options.loadInput(pending[i], options.jpegQuality) :
+                        loadImageFileToBase64Jpeg(pending[i], options.jpegQuality);
+                }
+                catch (const exception&) {
+                    base64Image.clear();
+                }
+                double loadMs = elapsedMs(loadStart);
+                busyMs += loadMs;
+
+                {
+                    lock_guard<mutex> lock(slotMutex);
+                    slots[i].image = move(base64Image);
+                    slots[i].loadMs = loadMs;
+                    slots[i].loaded = true;
+                }
+                slotChanged.notify_all();
+            }
+
+            lock_guard<mutex> lock(slotMutex);
+            report.loadBusyMs += busyMs;
+            });
+    }
+
+    // Fan-out never exceeds the client's in-flight limit, which would only turn inputs into rejections
+    size_t fanOut = static_cast<size_t>(max(1, options.maxInFlight));
+    int maxInFlight = getResilienceOptions().maxInFlight;
+    if (maxInFlight > 0) {
+        fanOut = min(fanOut, static_cast<size_t>(maxInFlight));
+    }
+    fanOut = min(fanOut, count);
+
+    vector<thread> requesters;
+    for (size_t t = 0; t < fanOut; t++) {
+        requesters.emplace_back([&]() {
+            double busyMs = 0.0;
+            for (size_t i = nextRequest++; i < count; i = nextRequest++) {
+                string base64Image;
+                {
+                    unique_lock<mutex> lock(slotMutex);
+                    slotChanged.wait(lock, [&]() { return slots[i].loaded; });
+                    base64Image = move(slots[i].image);
+                }
+
+                auto requestStart = chrono::steady_clock::now();
+                string result = base64Image.empty() ? "Error: Failed to load image" :
+                    runSync([&]() { return sendImageForInferenceInternal(base64Image, prompt); });
+                double requestMs = base64Image.empty() ? 0.0 : elapsedMs(requestStart);
+                busyMs += requestMs;
+
+                {
+                    lock_guard<mutex> lock(slotMutex);
+                    slots[i].result = move(result);
+                    slots[i].requestMs = requestMs;
+                    slots[i].done = true;
+                }
+                slotChanged.notify_all();
+            }
+
+            lock_guard<mutex> lock(slotMutex);
+            report.requestBusyMs += busyMs;
+            });
+    }
+
+    // Results are written in input order on this thread as they complete
+    for (size_t i = 0; i < count; i++) {
+        BatchSlot slot;
+        {
+            unique_lock<mutex> lock(slotMutex);
+            slotChanged.wait(lock, [&]() { return slots[i].done; });
+            slot = move(slots[i]);
+            slots[i] = BatchSlot();
+        }
+
+        auto writeStart = chrono::steady_clock::now();
+        output << OllamaBatch::formatResult(pending[i], slot.result, slot.loadMs, slot.requestMs) << "\n";
+        output.flush();
+        report.writeBusyMs += elapsedMs(writeStart);
+
+        if (isErrorResult(slot.result)) {
+            report.failed++;
+        }
+        else {
+            report.succeeded++;
+        }
+
+        {
+            lock_guard<mutex> lock(slotMutex);
+            written = i + 1;
+        }
+        slotChanged.notify_all();
+
+        if (options.onProgress) {
+            options.onProgress(i + 1, count);
+        }
+    }
+
+    for (thread& loader : loaders) loader.join();
+    for (thread& requester : requesters) requester.join();
+
+    report.wallClockMs = elapsedMs(start);
+    report.imagesPerSecond = report.wallClockMs > 0.0 ? count / (report.wallClockMs / 1000.0) : 0.0;
+    report.loadThreads = static_cast<int>(loadThreads);
+    report.requestThreads = static_cast<int>(fanOut);
+    return report;
 }
 
 // Simple base64 encoder
 string OllamaClientBase::base64_encode(const unsigned char* data, size_t input_length) {
     static const char charset[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    // Sized once and written through a pointer: images are encoded straight from the caller's (or a mapped file's) bytes
+    string result(((input_length + 2) / 3) * 4, '\0');
+    char* out = &result[0];
+    const unsigned char* end = data + input_length - input_length % 3;
+
+    for (; data < end; data += 3) {
+        unsigned int triple = (static_cast<unsigned int>(data[0]) << 16) | (static_cast<unsigned int>(data[1]) << 8) | data[2];
+        *out++ = charset[(triple >> 18) & 0x3F];
+        *out++ = charset[(triple >> 12) & 0x3F];
+        *out++ = charset[(triple >> 6) & 0x3F];
+        *out++ = charset[triple & 0x3F];
+    }
+
+    if (input_length % 3 == 2) {
+        unsigned int pair = (static_cast<unsigned int>(data[0]) << 8) | data[1];
+        *out++ = charset[(pair >> 10) & 0x3F];
+        *out++ = charset[(pair >> 4) & 0x3F];
+        *out++ = charset[(pair << 2) & 0x3F];
+        *out++ = '=';
+    }
+    else if (input_length % 3 == 1) {
+        *out++ = charset[(data[0] >> 2) & 0x3F];
+        *out++ = charset[(data[0] << 4) & 0x3F];
+        *out++ = '=';
+        *out++ = '=';
+    }
+
+    return result;
+}
+
+// Simple base64 decoder
+string OllamaClientBase::base64_decode(const string& input) {
+    static const string charset = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
     string result;
-    result.reserve(((input_length + 2) / 3) * 4);
-
-    unsigned char b;
-    int i = 0;
-
-    while (input_length >= 3) {
-        b = (data[i] & 0xFC) >> 2;
-        result += charset[b];
-        b = ((data[i] & 0x03) << 4) | ((data[i + 1] & 0xF0) >> 4);
-        result += charset[b];
-        b = ((data[i + 1] & 0x0F) << 2) | ((data[i + 2] & 0xC0) >> 6);
-        result += charset[b];
-        b = data[i + 2] & 0x3F;
-        result += charset[b];
-
-        i += 3;
-        input_length -= 3;
-    }
-
-    if (input_length == 2) {
-        b = (data[i] & 0xFC) >> 2;
-        result += charset[b];
-        b = ((data[i] & 0x03) << 4) | ((data[i + 1] & 0xF0) >> 4);
-        result += charset[b];
-        b = ((data[i + 1] & 0x0F) << 2);
-        result += charset[b];
-        result += '=';
-    }
-    else if (input_length == 1) {
-        b = (data[i] & 0xFC) >> 2;
-        result += charset[b];
-        b = ((data[i] & 0x03) << 4);
-        result += charset[b];
-        result += "==";
+    result.reserve(input.size() / 4 * 3);
+
+    unsigned int buffer = 0;
+    int bits = 0;
+
+    for (char c : input) {
+        size_t value = charset.find(c);
+        if (value == string::npos) {
+            break;
+        }
+
+        buffer = (buffer << 6) | static_cast<unsigned int>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            result += static_cast<char>((buffer >> bits) & 0xFF);
+        }
     }
 
     return result;
 }
 
+const char* const OllamaClientBase::kErrorPrefix = "Error:";
+
+bool OllamaClientBase::isErrorResult(const string& result) {
+    return result.compare(0, strlen(kErrorPrefix), kErrorPrefix) == 0;
+}
 
 string OllamaClientBase::sendPromptInternal(const string& prompt) {
     try {
-        // Create JSON payload using string building (lightweight approach)
-        ostringstream json;
-        json << "{\"messages\":[{\"role\":\"user\",\"content\":\"" << prompt << "\"}],\"stream\":false,\"model\":\"" << mChatModel << "\"}";
-
-        string payload = json.str();
-        return sendJSONPayload(payload);
+        ChatRequest request;
+        request.prompt = prompt;
+        return sendChat(request);
     }
     catch (const exception& e) {
         return "Error: " + string(e.what());
@@ -116,19 +1240,168 @@ string OllamaClientBase::sendPromptInternal(const string& prompt) {
 
 string OllamaClientBase::sendImageForInferenceInternal(const string& base64Image, const string& prompt) {
     try {
-        // Create JSON payload using string building
-        ostringstream json;
-        json << "{\"messages\":[{\"role\":\"user\",\"images\":[\"" << base64Image << "\"],\"content\":\"" << prompt << "\"}],\"stream\":false,\"model\":\"" << mVisionModel << "\"}";
-
-        string payload = json.str();
-        return sendJSONPayload(payload);
+        ChatRequest request;
+        request.vision = true;
+        request.prompt = prompt;
+        request.base64Image = base64Image;
+        return sendChat(request);
     }
     catch (const exception& e) {
         return "Error: " + string(e.what());
     }
 }
 
-string OllamaClientBase::sendJSONPayload(const string payload) {
+string OllamaClientBase::sendChat(const ChatRequest& request) {
+    shared_ptr<const OllamaClientConfig> config = getConfig();
+    string model = request.vision ? config->visionModel : config->chatModel;
+    OllamaCascadeOptions cascade = getCascadeOptions();
+    string smallModel = request.vision ? cascade.visionModel : cascade.chatModel;
+
+    string result;
+    if (smallModel.empty()) {
+        result = sendJSONPayload(config, buildChatPayload(*config, model, request.prompt, request.base64Image));
+    }
+    else {
+        auto start = chrono::steady_clock::now();
+        result = sendJSONPayload(config, buildChatPayload(*config, smallModel, request.prompt, request.base64Image));
+        double smallMs = elapsedMs(start);
+        if (OllamaCascade::isAccepted(cascade, result)) {
+            mCascade.recordAccepted(smallMs);
+        }
+        else {
+            auto escalated = chrono::steady_clock::now();
+            result = sendJSONPayload(config, buildChatPayload(*config, model, request.prompt, request.base64Image));
+            mCascade.recordEscalated(smallMs, elapsedMs(escalated));
+        }
+    }
+
+    recordOperatingPoint(request, result);
+    return result;
+}
+
+string OllamaClientBase::buildChatPayload(const OllamaClientConfig& config, const string& model, const string& prompt, const string& base64Image) {
+    return config.backend->buildChatPayload(model, prompt, base64Image, config.options);
+}
+
+string OllamaClientBase::sendJSONPayload(shared_ptr<const OllamaClientConfig> config, const string payload) {
+    if (!mDeduplicate) {
+        return sendJSONPayloadTraced(config, payload);
+    }
+    return mSingleFlight.run(requestTarget(*config), payload, [this, &config, &payload]() { return sendJSONPayloadTraced(config, payload); });
+}
+
+string OllamaClientBase::sendJSONPayloadTraced(shared_ptr<const OllamaClientConfig> config, const string& payload, string* rawResponse) {
+    shared_ptr<OllamaTraceRecorder> recorder = mTraceRecorder.load();
+    if (!recorder) {
+        HttpOutcome outcome;
+        string result = sendJSONPayloadWithRetry(*config, payload, outcome);
+        if (rawResponse) {
+            *rawResponse = outcome.rawResponse;
+        }
+        return result;
+    }
+
+    OllamaTraceEntry entry;
+    entry.arrivalMs = OllamaTraceRecorder::nowMs();
+    auto start = chrono::steady_clock::now();
+
+    HttpOutcome outcome;
+    string result = sendJSONPayloadWithRetry(*config, payload, outcome);
+
+    entry.latencyMs = elapsedMs(start);
+    entry.statusCode = outcome.statusCode;
+    entry.request = payload;
+    entry.response = outcome.rawResponse;
+    recorder->record(entry);
+
+    if (rawResponse) {
+        *rawResponse = outcome.rawResponse;
+    }
+    return result;
+}
+
+string OllamaClientBase::sendJSONPayloadWithRetry(const OllamaClientConfig& config, const string& payload, HttpOutcome& outcome) {
+    OllamaResilienceOptions options = getResilienceOptions();
+
+    for (int attempt = 0; ; attempt++) {
+        unsigned long long probe = 0;
+        if (!mBreaker.allowRequest(options, probe)) {
+            return "Error: Server unavailable (circuit breaker " + OllamaCircuitBreaker::stateToString(mBreaker.getState()) + ")";
+        }
+
+        outcome = HttpOutcome();
+        string result = sendJSONPayloadOnce(config, payload, options, outcome);
+
+        int delayMs = nextRetryDelayMs(outcome, options, attempt, probe);
+        if (delayMs < 0) {
+            return result;
+        }
+
+        this_thread::sleep_for(chrono::milliseconds(delayMs));
+        mRetries++;
+    }
+}
+
+int OllamaClientBase::nextRetryDelayMs(const HttpOutcome& outcome, const OllamaResilienceOptions& options, int attempt, unsigned long long probe) {
+    static thread_local mt19937 random(random_device{}());
+
+    // No response or a 5xx counts against server health; client errors (4xx) do not
+    if (outcome.statusCode == 0 || outcome.statusCode >= 500) {
+        mBreaker.recordFailure(options, probe);
+    }
+    else {
+        mBreaker.recordSuccess(probe);
+    }
+
+    bool retryable = outcome.connectFailed || (outcome.timedOut && options.retryOnTimeout) || outcome.statusCode == 503;
+    if (!retryable || attempt >= options.maxRetries) {
+        return -1;
+    }
+
+    // Exponential backoff with full jitter
+    long long ceiling = min(static_cast<long long>(options.retryMaxDelayMs),
+        static_cast<long long>(options.retryBaseDelayMs) << min(attempt, 20));
+    uniform_int_distribution<long long> delay(0, max(0LL, ceiling));
+    return static_cast<int>(delay(random));
+}
+
+void OllamaClientBase::sendOnEventLoop(shared_ptr<OllamaEventLoop> loop, shared_ptr<const OllamaClientConfig> config, shared_ptr<const string> payload,
+    int attempt, function<void(const string& result, const HttpOutcome& outcome)> done) {
+    OllamaResilienceOptions options = getResilienceOptions();
+    unsigned long long probe = 0;
+    if (!mBreaker.allowRequest(options, probe)) {
+        done("Error: Server unavailable (circuit breaker " + OllamaCircuitBreaker::stateToString(mBreaker.getState()) + ")", HttpOutcome());
+        return;
+    }
+
+    OllamaHttpRequest request;
+    request.host = config->host;
+    request.port = config->port;
+    request.path = config->backend->getEndpoint();
+    request.body = *payload;
+    request.timeoutMs = options.requestTimeoutMs;
+
+    loop->submit(request, [this, loop, config, payload, attempt, options, probe, done](OllamaHttpResponse& response) {
+        HttpOutcome outcome;
+        outcome.statusCode = response.statusCode;
+        outcome.connectFailed = response.connectFailed;
+        outcome.timedOut = response.timedOut;
+        outcome.rawResponse = move(response.body);
+        string result = response.error.empty() ? config->backend->parseResponseContent(outcome.rawResponse) : response.error;
+
+        int delayMs = nextRetryDelayMs(outcome, options, attempt, probe);
+        if (delayMs < 0) {
+            done(result, outcome);
+            return;
+        }
+
+        // Back off on a timer instead of sleeping, so the loop keeps serving other requests
+        mRetries++;
+        loop->schedule(delayMs, [this, loop, config, payload, attempt, done]() { sendOnEventLoop(loop, config, payload, attempt + 1, done); });
+        });
+}
+
+string OllamaClientBase::sendJSONPayloadOnce(const OllamaClientConfig& config, const string& payload, const OllamaResilienceOptions& options, HttpOutcome& outcome) {
     try {
         // Initialize WinHTTP
         HINTERNET hSession = WinHttpOpen(L"OllamaClient/1.0",
@@ -139,18 +1412,21 @@ string OllamaClientBase::sendJSONPayload(const string payload) {
             return "Error: Failed to initialize WinHTTP";
         }
 
+        // Default resolve, connect and send timeouts; the receive timeout comes from the resilience options
+        WinHttpSetTimeouts(hSession, 0, 60000, 30000, options.requestTimeoutMs > 0 ? options.requestTimeoutMs : -1);
+
         // Convert host to wide string
-        wstring wideHost = utf8ToWide(mHost);
+        wstring wideHost = utf8ToWide(config.host);
 
         // Connect to server
-        HINTERNET hConnect = WinHttpConnect(hSession, wideHost.c_str(), static_cast<INTERNET_PORT>(mPort), 0);
+        HINTERNET hConnect = WinHttpConnect(hSession, wideHost.c_str(), static_cast<INTERNET_PORT>(config.port), 0);
         if (!hConnect) {
             WinHttpCloseHandle(hSession);
             return "Error: Failed to connect to server";
         }
 
         // Create request
-        HINTERNET hRequest = WinHttpOpenRequest(hConnect, L"POST", utf8ToWide(mEndpoint).c_str(),
+        HINTERNET hRequest = WinHttpOpenRequest(hConnect, L"POST", utf8ToWide(config.backend->getEndpoint()).c_str(),
             NULL, WINHTTP_NO_REFERER,
             WINHTTP_DEFAULT_ACCEPT_TYPES,
             0);
@@ -178,19 +1454,30 @@ string OllamaClientBase::sendJSONPayload(const string payload) {
             static_cast<DWORD>(payload.size()),
             static_cast<DWORD>(payload.size()), 0);
         if (!result) {
+            DWORD error = GetLastError();
+            outcome.connectFailed = (error == ERROR_WINHTTP_CANNOT_CONNECT);
             WinHttpCloseHandle(hRequest);
             WinHttpCloseHandle(hConnect);
             WinHttpCloseHandle(hSession);
-            return "Error: Failed to send request";
+            return outcome.connectFailed ? "Error: Connection refused by server" : "Error: Failed to send request";
         }
 
         // Receive response
         result = WinHttpReceiveResponse(hRequest, NULL);
         if (!result) {
+            outcome.timedOut = (GetLastError() == ERROR_WINHTTP_TIMEOUT);
             WinHttpCloseHandle(hRequest);
             WinHttpCloseHandle(hConnect);
             WinHttpCloseHandle(hSession);
-            return "Error: Failed to receive response";
+            return outcome.timedOut ? "Error: Request timed out" : "Error: Failed to receive response";
+        }
+
+        // HTTP status for retry and circuit breaker decisions
+        DWORD statusCode = 0;
+        DWORD statusCodeSize = sizeof(statusCode);
+        if (WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+            WINHTTP_HEADER_NAME_BY_INDEX, &statusCode, &statusCodeSize, WINHTTP_NO_HEADER_INDEX)) {
+            outcome.statusCode = static_cast<int>(statusCode);
         }
 
         // Read response data
@@ -219,21 +1506,8 @@ string OllamaClientBase::sendJSONPayload(const string payload) {
         WinHttpCloseHandle(hConnect);
         WinHttpCloseHandle(hSession);
 
-        // Parse response JSON (simple approach - look for "content" field)
-        try {
-            size_t contentStart = response.find("\"content\":\"");
-            if (contentStart != string::npos) {
-                contentStart += 11; // Length of "content":"
-                size_t contentEnd = response.find("\"", contentStart);
-                if (contentEnd != string::npos) {
-                    return response.substr(contentStart, contentEnd - contentStart);
-                }
-            }
-            return "Error: Could not parse response content\nRaw response: " + response;
-        }
-        catch (const exception& e) {
-            return "Error parsing response: " + string(e.what()) + "\nRaw response: " + response;
-        }
+        outcome.rawResponse = response;
+        return config.backend->parseResponseContent(response);
     }
     catch (const exception& e) {
         return "Error: " + string(e.what());
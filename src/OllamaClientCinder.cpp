@@ -1,5 +1,7 @@
 #include <OllamaClient/OllamaClientCinder.h>
 
+#include "cinder/ip/Resize.h"
+
 OllamaClientCinder::OllamaClientCinder(const string& host, int port, const string& visionModel, const string& chatModel)
     : OllamaClientBase(host, port, visionModel, chatModel)
 {
@@ -7,18 +9,12 @@ OllamaClientCinder::OllamaClientCinder(const string& host, int port, const strin
 
 // Cinder Surface methods
 void OllamaClientCinder::sendImageForInference(const Surface& surface, const string& prompt, InferenceCallback callback, void * userData) {
-    // Create a thread to handle the HTTP request
-    thread worker([this, surface, prompt, callback, userData]() {
-        string result = sendImageForInferenceInternal(surface, prompt);
-        callback(result, userData);
-        });
-
-    // Detach the thread so it can continue running
-    worker.detach();
+    // Encoding and the HTTP request run on a worker thread (or the event loop if one is set)
+    runAsyncChat([this, surface, prompt]() { return buildSurfaceRequest(surface, prompt); }, callback, userData);
 }
 
 string OllamaClientCinder::sendImageForInferenceSync(const Surface& surface, const string& prompt) {
-    return sendImageForInferenceInternal(surface, prompt);
+    return runSync([this, &surface, &prompt]() { return sendImageForInferenceInternal(surface, prompt); });
 }
 
 // Cinder Texture methods
@@ -42,6 +38,54 @@ string OllamaClientCinder::sendTextureForInferenceSync(const Texture2dRef& textu
     return sendImageForInferenceSync(surface, prompt);
 }
 
+// Tiled inference methods
+void OllamaClientCinder::sendSurfaceTiledForInference(const Surface& surface, const string& prompt, const OllamaTileOptions& options, TiledCallback callback, void * userData) {
+    // The base class copies the pixels before returning
+    Surface8u packed;
+    sendTiledForInference(surfaceToView(surface, packed), prompt, options, callback, userData);
+}
+
+OllamaTiledResult OllamaClientCinder::sendSurfaceTiledForInferenceSync(const Surface& surface, const string& prompt, const OllamaTileOptions& options) {
+    Surface8u packed;
+    return sendTiledForInferenceSync(surfaceToView(surface, packed), prompt, options);
+}
+
+string OllamaClientCinder::encodePixelViewToBase64Jpeg(const OllamaPixelView& view, float jpegQuality) {
+    if (!view.isValid()) {
+        return "";
+    }
+
+    // Cinder wraps external memory through non-const pointers; the pixels are only read
+    uint8_t* data = const_cast<uint8_t*>(view.data);
+
+    if (view.channels == 1) {
+        Channel8u channel(view.width, view.height, view.getRowBytes(), 1, data);
+        return imageSourceToRawBase64Jpeg(channel, jpegQuality);
+    }
+
+    SurfaceChannelOrder order = view.channels == 4 ?
+        SurfaceChannelOrder(view.bgr ? SurfaceChannelOrder::BGRA : SurfaceChannelOrder::RGBA) :
+        SurfaceChannelOrder(view.bgr ? SurfaceChannelOrder::BGR : SurfaceChannelOrder::RGB);
+    Surface8u surface(data, view.width, view.height, view.getRowBytes(), order);
+    return imageSourceToRawBase64Jpeg(surface, jpegQuality);
+}
+
+string OllamaClientCinder::loadImageFileToBase64Jpeg(const string& path, float jpegQuality) {
+    // JPEG files are sent as stored
+    string base64Image = OllamaClientBase::loadImageFileToBase64Jpeg(path, jpegQuality);
+    if (!base64Image.empty()) {
+        return base64Image;
+    }
+
+    try {
+        return imageSourceToRawBase64Jpeg(loadImage(loadFile(path)), jpegQuality);
+    }
+    catch (const exception& e) {
+        CI_LOG_E("Failed to load image " << path << ": " << e.what());
+        return "";
+    }
+}
+
 // Implementation of pure virtual methods from base class
 string OllamaClientCinder::convertImageToBase64Jpeg(const void* imageData, float jpegQuality) {
     // For Cinder implementation, we expect imageData to be a Surface*
@@ -71,17 +115,46 @@ string OllamaClientCinder::sendImageForInferenceSync(const void* imageData, cons
 
 string OllamaClientCinder::sendImageForInferenceInternal(const Surface& surface, const string& prompt) {
     try {
-        string base64Image = surfaceToRawBase64Jpeg(surface);
-        CI_LOG_I("Sending request to: " << mHost << ":" << mPort << mEndpoint);
-        CI_LOG_I("Base64 image size: " << base64Image.size() << " bytes");
-
-        return OllamaClientBase::sendImageForInferenceInternal(base64Image, prompt);
+        return sendChat(buildSurfaceRequest(surface, prompt));
     }
     catch (const exception& e) {
         return "Error: " + string(e.what());
     }
 }
 
+OllamaClientBase::ChatRequest OllamaClientCinder::buildSurfaceRequest(const Surface& surface, const string& prompt) {
+    ChatRequest request;
+    request.vision = true;
+    request.prompt = prompt;
+
+    if (!acquireOperatingPoint(request)) {
+        request.base64Image = surfaceToBase64Image(surface, 0.8f);
+    }
+    else if (request.operatingPoint.scale < 1.0f) {
+        ivec2 size(max(1, static_cast<int>(surface.getWidth() * request.operatingPoint.scale + 0.5f)),
+            max(1, static_cast<int>(surface.getHeight() * request.operatingPoint.scale + 0.5f)));
+        request.base64Image = surfaceToBase64Image(ip::resize(surface, surface.getBounds(), size), request.operatingPoint.quality);
+    }
+    else {
+        request.base64Image = surfaceToBase64Image(surface, request.operatingPoint.quality);
+    }
+    shared_ptr<const OllamaClientConfig> config = getConfig();
+    CI_LOG_I("Sending request to: " << config->host << ":" << config->port << config->backend->getEndpoint());
+    CI_LOG_I("Base64 image size: " << request.base64Image.size() << " bytes");
+
+    return request;
+}
+
+string OllamaClientCinder::surfaceToBase64Image(const Surface& surface, float jpegQuality) {
+    // Without content-aware encoding the surface goes straight to the framework encoder
+    if (!getContentEncodingOptions().enabled) {
+        return surfaceToRawBase64Jpeg(surface, jpegQuality);
+    }
+
+    Surface8u packed;
+    return encodePixelViewToBase64Image(surfaceToView(surface, packed), jpegQuality);
+}
+
 // Static utility methods for Cinder image conversion
 string OllamaClientCinder::textureToBase64Jpeg(const Texture2dRef& texture, float jpegQuality) {
     if (!texture) {
@@ -127,13 +200,17 @@ string OllamaClientCinder::textureToRawBase64Jpeg(const Texture2dRef& texture, f
 }
 
 string OllamaClientCinder::surfaceToRawBase64Jpeg(const Surface& surface, float jpegQuality) {
+    return imageSourceToRawBase64Jpeg(surface, jpegQuality);
+}
+
+string OllamaClientCinder::imageSourceToRawBase64Jpeg(const ImageSourceRef& source, float jpegQuality) {
     OStreamMemRef stream = OStreamMem::create();
     DataTargetRef target = DataTargetStream::createRef(stream);
 
     ImageTarget::Options options;
     options.quality(jpegQuality);
 
-    writeImage(target, surface, options, "jpg");
+    writeImage(target, source, options, "jpg");
 
     void* bufferData = stream->getBuffer();
     size_t bufferSize = stream->tell();
@@ -142,4 +219,26 @@ string OllamaClientCinder::surfaceToRawBase64Jpeg(const Surface& surface, float
         reinterpret_cast<const unsigned char*>(bufferData),
         bufferSize
     );
+}
+
+OllamaPixelView OllamaClientCinder::surfaceToView(const Surface& surface, Surface8u& packed) {
+    if (!surface) {
+        return OllamaPixelView();
+    }
+
+    // Red, green and blue adjacent and in order (RGB, RGBA, RGBX or the BGR equivalents)
+    int pixelInc = surface.getPixelInc();
+    bool rgb = surface.getRedOffset() == 0 && surface.getGreenOffset() == 1 && surface.getBlueOffset() == 2;
+    bool bgr = surface.getBlueOffset() == 0 && surface.getGreenOffset() == 1 && surface.getRedOffset() == 2;
+
+    const Surface* source = &surface;
+    if (!rgb && !bgr) {
+        packed = Surface8u(surface.getWidth(), surface.getHeight(), true, SurfaceChannelOrder::RGBA);
+        packed.copyFrom(surface, surface.getBounds());
+        source = &packed;
+        pixelInc = 4;
+    }
+
+    return OllamaPixelView(source->getData(), source->getWidth(), source->getHeight(), pixelInc,
+        static_cast<size_t>(source->getRowBytes()), bgr);
 }
\ No newline at end of file
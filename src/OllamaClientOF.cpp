@@ -1,5 +1,7 @@
 #include <OllamaClient/OllamaClientOF.h>
 
+#include <cstring>
+
 OllamaClientOF::OllamaClientOF(const string& host, int port, const string& visionModel, const string& chatModel)
     : OllamaClientBase(host, port, visionModel, chatModel)
 {
@@ -7,18 +9,12 @@ OllamaClientOF::OllamaClientOF(const string& host, int port, const string& visio
 
 // OpenFrameworks ofPixels methods
 void OllamaClientOF::sendPixelsForInference(const ofPixels& pixels, const string& prompt, InferenceCallback callback, void * userData) {
-    // Create a thread to handle the HTTP request
-    thread worker([this, pixels, prompt, callback, userData]() {
-        string result = sendPixelsForInferenceInternal(pixels, prompt);
-        callback(result, userData);
-        });
-
-    // Detach the thread so it can continue running
-    worker.detach();
+    // Encoding and the HTTP request run on a worker thread (or the event loop if one is set)
+    runAsyncChat([this, pixels, prompt]() { return buildPixelsRequest(pixels, prompt); }, callback, userData);
 }
 
 string OllamaClientOF::sendPixelsForInferenceSync(const ofPixels& pixels, const string& prompt) {
-    return sendPixelsForInferenceInternal(pixels, prompt);
+    return runSync([this, &pixels, &prompt]() { return sendPixelsForInferenceInternal(pixels, prompt); });
 }
 
 // OpenFrameworks ofTexture methods
@@ -62,6 +58,54 @@ string OllamaClientOF::sendImageForInferenceSync(const ofImage& image, const str
     return sendPixelsForInferenceSync(image.getPixels(), prompt);
 }
 
+// Tiled inference methods
+void OllamaClientOF::sendPixelsTiledForInference(const ofPixels& pixels, const string& prompt, const OllamaTileOptions& options, TiledCallback callback, void * userData) {
+    // The base class copies the pixels before returning
+    sendTiledForInference(pixelsToView(pixels), prompt, options, callback, userData);
+}
+
+OllamaTiledResult OllamaClientOF::sendPixelsTiledForInferenceSync(const ofPixels& pixels, const string& prompt, const OllamaTileOptions& options) {
+    return sendTiledForInferenceSync(pixelsToView(pixels), prompt, options);
+}
+
+string OllamaClientOF::encodePixelViewToBase64Jpeg(const OllamaPixelView& view, float jpegQuality) {
+    if (!view.isValid()) {
+        return "";
+    }
+
+    // Pack the (possibly strided) view into ofPixels in RGB(A) order
+    ofPixels pixels;
+    pixels.allocate(view.width, view.height, view.channels);
+    size_t rowSize = static_cast<size_t>(view.width) * view.channels;
+    for (int y = 0; y < view.height; y++) {
+        unsigned char* row = pixels.getData() + y * rowSize;
+        memcpy(row, view.getRow(y), rowSize);
+        if (view.bgr && view.channels >= 3) {
+            for (size_t i = 0; i < rowSize; i += view.channels) {
+                swap(row[i], row[i + 2]);
+            }
+        }
+    }
+
+    return pixelsToBase64Jpeg(pixels, qualityFromFloat(jpegQuality));
+}
+
+string OllamaClientOF::loadImageFileToBase64Jpeg(const string& path, float jpegQuality) {
+    // JPEG files are sent as stored
+    string base64Image = OllamaClientBase::loadImageFileToBase64Jpeg(path, jpegQuality);
+    if (!base64Image.empty()) {
+        return base64Image;
+    }
+
+    ofPixels pixels;
+    if (!ofLoadImage(pixels, path)) {
+        ofLogError("OllamaClientOF") << "Failed to load image: " << path;
+        return "";
+    }
+
+    return pixelsToBase64Jpeg(pixels, qualityFromFloat(jpegQuality));
+}
+
 // Implementation of pure virtual methods from base class
 string OllamaClientOF::convertImageToBase64Jpeg(const void* imageData, float jpegQuality) {
     // For OpenFrameworks implementation, we expect imageData to be an ofPixels*
@@ -70,12 +114,7 @@ string OllamaClientOF::convertImageToBase64Jpeg(const void* imageData, float jpe
         return "";
     }
 
-    ofImageQualityType quality = (jpegQuality > 0.9f) ? OF_IMAGE_QUALITY_BEST :
-                                (jpegQuality > 0.7f) ? OF_IMAGE_QUALITY_HIGH :
-                                (jpegQuality > 0.5f) ? OF_IMAGE_QUALITY_MEDIUM :
-                                OF_IMAGE_QUALITY_LOW;
-
-    return pixelsToBase64Jpeg(*pixels, quality);
+    return pixelsToBase64Jpeg(*pixels, qualityFromFloat(jpegQuality));
 }
 
 void OllamaClientOF::sendImageForInference(const void* imageData, const string& prompt, InferenceCallback callback, void * userData) {
@@ -97,17 +136,45 @@ string OllamaClientOF::sendImageForInferenceSync(const void* imageData, const st
 
 string OllamaClientOF::sendPixelsForInferenceInternal(const ofPixels& pixels, const string& prompt) {
     try {
-        string base64Image = pixelsToBase64Jpeg(pixels);
-        ofLogNotice("OllamaClientOF") << "Sending request to: " << mHost << ":" << mPort << mEndpoint;
-        ofLogNotice("OllamaClientOF") << "Base64 image size: " << base64Image.size() << " bytes";
-
-        return OllamaClientBase::sendImageForInferenceInternal(base64Image, prompt);
+        return sendChat(buildPixelsRequest(pixels, prompt));
     }
     catch (const exception& e) {
         return "Error: " + string(e.what());
     }
 }
 
+OllamaClientBase::ChatRequest OllamaClientOF::buildPixelsRequest(const ofPixels& pixels, const string& prompt) {
+    ChatRequest request;
+    request.vision = true;
+    request.prompt = prompt;
+
+    if (!acquireOperatingPoint(request)) {
+        request.base64Image = pixelsToBase64Image(pixels, qualityToFloat(OF_IMAGE_QUALITY_HIGH));
+    }
+    else if (request.operatingPoint.scale < 1.0f) {
+        ofPixels scaled = pixels;
+        scaled.resize(max(1, static_cast<int>(pixels.getWidth() * request.operatingPoint.scale + 0.5f)),
+            max(1, static_cast<int>(pixels.getHeight() * request.operatingPoint.scale + 0.5f)));
+        request.base64Image = pixelsToBase64Image(scaled, request.operatingPoint.quality);
+    }
+    else {
+        request.base64Image = pixelsToBase64Image(pixels, request.operatingPoint.quality);
+    }
+    shared_ptr<const OllamaClientConfig> config = getConfig();
+    ofLogNotice("OllamaClientOF") << "Sending request to: " << config->host << ":" << config->port << config->backend->getEndpoint();
+    ofLogNotice("OllamaClientOF") << "Base64 image size: " << request.base64Image.size() << " bytes";
+
+    return request;
+}
+
+string OllamaClientOF::pixelsToBase64Image(const ofPixels& pixels, float jpegQuality) {
+    // Without content-aware encoding the pixels go straight to the framework encoder
+    if (!getContentEncodingOptions().enabled) {
+        return pixelsToBase64Jpeg(pixels, qualityFromFloat(jpegQuality));
+    }
+    return encodePixelViewToBase64Image(pixelsToView(pixels), jpegQuality);
+}
+
 // Static utility methods for OpenFrameworks image conversion
 string OllamaClientOF::textureToBase64Jpeg(const ofTexture& texture, ofImageQualityType quality) {
     if (!texture.isAllocated()) {
@@ -164,4 +231,22 @@ float OllamaClientOF::qualityToFloat(ofImageQualityType quality) {
         case OF_IMAGE_QUALITY_WORST: return 0.2f;
         default: return 0.8f;
     }
+}
+
+ofImageQualityType OllamaClientOF::qualityFromFloat(float jpegQuality) {
+    return (jpegQuality > 0.9f) ? OF_IMAGE_QUALITY_BEST :
+           (jpegQuality > 0.7f) ? OF_IMAGE_QUALITY_HIGH :
+           (jpegQuality > 0.5f) ? OF_IMAGE_QUALITY_MEDIUM :
+           OF_IMAGE_QUALITY_LOW;
+}
+
+OllamaPixelView OllamaClientOF::pixelsToView(const ofPixels& pixels) {
+    if (!pixels.isAllocated()) {
+        return OllamaPixelView();
+    }
+
+    ofPixelFormat format = pixels.getPixelFormat();
+    bool bgr = format == OF_PIXELS_BGR || format == OF_PIXELS_BGRA;
+    return OllamaPixelView(pixels.getData(), static_cast<int>(pixels.getWidth()), static_cast<int>(pixels.getHeight()),
+        static_cast<int>(pixels.getNumChannels()), 0, bgr);
 }
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include <OllamaClient/OllamaContentEncoder.h>
+#include <OllamaClient/OllamaJpeg.h>
+#include <OllamaClient/OllamaPng.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+static double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Luma plane for the gray formats (pixels that are already gray keep their value)
+static OllamaPixelView toGrayView(const OllamaPixelView& pixels, vector<unsigned char>& plane) {
+    if (pixels.channels < 3) {
+        return pixels;
+    }
+
+    plane.resize(static_cast<size_t>(pixels.width) * pixels.height);
+    int red = pixels.bgr ? 2 : 0;
+    int blue = pixels.bgr ? 0 : 2;
+    unsigned char* out = plane.data();
+    for (int y = 0; y < pixels.height; y++) {
+        const unsigned char* pixel = pixels.getRow(y);
+        for (int x = 0; x < pixels.width; x++, pixel += pixels.channels) {
+            *out++ = static_cast<unsigned char>((77 * pixel[red] + 150 * pixel[1] + 29 * pixel[blue] + 128) >> 8);
+        }
+    }
+    return OllamaPixelView(plane.data(), pixels.width, pixels.height, 1);
+}
+
+// PNG as used for sparse content: unfiltered rows (flat runs repeat exactly), stopped once larger than maxSize
+static string encodeSparsePng(const OllamaPixelView& pixels, size_t maxSize) {
+    OllamaPngOptions options;
+    options.filterRows = false;
+    options.maxSize = maxSize;
+    return OllamaPngEncoder::encode(pixels, options);
+}
+
+OllamaImageContent OllamaContentEncoder::analyze(const OllamaPixelView& pixels, const OllamaContentEncodingOptions& options) {
+    OllamaImageContent content;
+    if (!pixels.isValid()) {
+        return content;
+    }
+
+    int red = pixels.bgr ? 2 : 0;
+    int blue = pixels.bgr ? 0 : 2;
+
+    // Gray test on every pixel: one colored stroke must keep the image in color
+    content.grayscale = true;
+    if (pixels.channels >= 3) {
+        int tolerance = max(0, options.grayTolerance);
+        for (int y = 0; y < pixels.height && content.grayscale; y++) {
+            const unsigned char* pixel = pixels.getRow(y);
+            for (int x = 0; x < pixels.width; x++, pixel += pixels.channels) {
+                if (abs(pixel[red] - pixel[1]) > tolerance || abs(pixel[blue] - pixel[1]) > tolerance) {
+                    content.grayscale = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Colors and their sample counts in a small open-addressing table; once it is full,
+    // new colors are no longer added but the known ones keep counting
+    size_t maxColors = static_cast<size_t>(max(0, options.maxFlatColors)) + 1;
+    size_t tableSize = 16;
+    while (tableSize < maxColors * 2) {
+        tableSize *= 2;
+    }
+    vector<unsigned int> keys(tableSize, 0);         // Color + 1, 0 = empty slot
+    vector<unsigned long> counts(tableSize, 0);
+    size_t colors = 0;
+    bool overflow = false;
+    unsigned long samples = 0;
+
+    int step = max(1, options.sampleStep);
+    for (int y = 0; y < pixels.height; y += step) {
+        const unsigned char* row = pixels.getRow(y);
+        for (int x = 0; x < pixels.width; x += step) {
+            const unsigned char* pixel = row + static_cast<size_t>(x) * pixels.channels;
+            unsigned int rgb = pixels.channels < 3 ? pixel[0] :
+                (static_cast<unsigned int>(pixel[red]) << 16) | (static_cast<unsigned int>(pixel[1]) << 8) | pixel[blue];
+            unsigned int key = rgb + 1;
+            samples++;
+
+            size_t slot = ((key * 2654435761u) >> 8) & (tableSize - 1);
+            while (keys[slot] != 0 && keys[slot] != key) {
+                slot = (slot + 1) & (tableSize - 1);
+            }
+            if (keys[slot] == key) {
+                counts[slot]++;
+            }
+            else if (colors < maxColors) {
+                keys[slot] = key;
+                counts[slot] = 1;
+                colors++;
+            }
+            else {
+                overflow = true;
+            }
+        }
+    }
+
+    unsigned long background = *max_element(counts.begin(), counts.end());
+    content.colorCount = static_cast<int>(overflow ? maxColors : colors);
+    content.backgroundFraction = samples > 0 ? static_cast<double>(background) / samples : 0.0;
+    content.sparse = content.backgroundFraction >= options.sparseBackground || content.colorCount <= options.maxFlatColors;
+    return content;
+}
+
+vector<OllamaContentFormat> OllamaContentEncoder::getCandidates(const OllamaImageContent& content) {
+    OllamaContentFormat jpeg = content.grayscale ? OllamaContentFormat::GrayJpeg : OllamaContentFormat::ColorJpeg;
+    if (content.sparse) {
+        return { jpeg, OllamaContentFormat::Png };
+    }
+    return { jpeg };
+}
+
+OllamaContentEncodeResult OllamaContentEncoder::encode(const OllamaPixelView& pixels, float jpegQuality, const OllamaContentEncodingOptions& options) {
+    auto start = chrono::steady_clock::now();
+    OllamaImageContent content = analyze(pixels, options);
+    double analyzeMs = elapsedMs(start);
+
+    OllamaContentEncodeResult result = encode(pixels, jpegQuality, content);
+    result.analyzeMs = analyzeMs;
+    return result;
+}
+
+OllamaContentEncodeResult OllamaContentEncoder::encode(const OllamaPixelView& pixels, float jpegQuality, const OllamaImageContent& content) {
+    OllamaContentEncodeResult result;
+    result.content = content;
+    if (!pixels.isValid()) {
+        return result;
+    }
+
+    auto start = chrono::steady_clock::now();
+    vector<unsigned char> plane;
+    OllamaPixelView source = content.grayscale ? toGrayView(pixels, plane) : pixels;
+
+    for (OllamaContentFormat format : getCandidates(content)) {
+        auto encodeStart = chrono::steady_clock::now();
+        string bytes = format == OllamaContentFormat::Png ? encodeSparsePng(source, result.bytes.size()) : OllamaJpegEncoder::encode(source, jpegQuality);
+
+        OllamaContentCandidate candidate;
+        candidate.format = format;
+        candidate.size = bytes.size();
+        candidate.encodeMs = elapsedMs(encodeStart);
+        result.candidates.push_back(candidate);
+
+        if (!bytes.empty() && (result.bytes.empty() || bytes.size() < result.bytes.size())) {
+            result.format = format;
+            result.bytes.swap(bytes);
+        }
+    }
+
+    result.encodeMs = elapsedMs(start);
+    return result;
+}
+
+string OllamaContentEncoder::encodeAs(const OllamaPixelView& pixels, OllamaContentFormat format, float jpegQuality) {
+    if (!pixels.isValid()) {
+        return "";
+    }
+
+    vector<unsigned char> plane;
+    switch (format) {
+        case OllamaContentFormat::GrayJpeg: return OllamaJpegEncoder::encode(toGrayView(pixels, plane), jpegQuality);
+        case OllamaContentFormat::Png: return encodeSparsePng(pixels, 0);
+        default: return OllamaJpegEncoder::encode(pixels, jpegQuality);
+    }
+}
+
+string OllamaContentEncoder::formatToString(OllamaContentFormat format) {
+    switch (format) {
+        case OllamaContentFormat::GrayJpeg: return "gray-jpeg";
+        case OllamaContentFormat::Png: return "png";
+        default: return "color-jpeg";
+    }
+}
+
+string OllamaContentEncoder::formatToMimeType(OllamaContentFormat format) {
+    return format == OllamaContentFormat::Png ? "image/png" : "image/jpeg";
+}
@@ -0,0 +1,209 @@
+#include <OllamaClient/OllamaEncodedImage.h>
+
+#include <cstring>
+#include <cstdint>
+
+// Windows specific includes - prevent winsock.h inclusion
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+
+#include "OllamaUtf8.h"
+
+static unsigned int readBigEndian16(const unsigned char* p) {
+    return (static_cast<unsigned int>(p[0]) << 8) | p[1];
+}
+
+static unsigned long readBigEndian32(const unsigned char* p) {
+    return (static_cast<unsigned long>(p[0]) << 24) | (static_cast<unsigned long>(p[1]) << 16) |
+        (static_cast<unsigned long>(p[2]) << 8) | p[3];
+}
+
+// OllamaMappedFile
+
+OllamaMappedFile::OllamaMappedFile(const string& path) {
+    open(path);
+}
+
+OllamaMappedFile::~OllamaMappedFile() {
+    close();
+}
+
+bool OllamaMappedFile::open(const string& path) {
+    close();
+
+    HANDLE file = CreateFileW(utf8ToWide(path).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        mError = "Cannot open " + path;
+        return false;
+    }
+    mFile = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX) {
+        close();
+        mError = "Empty or unreadable file " + path;
+        return false;
+    }
+
+    mMapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mMapping) {
+        close();
+        mError = "Cannot map " + path;
+        return false;
+    }
+
+    mData = static_cast<const unsigned char*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+    if (!mData) {
+        close();
+        mError = "Cannot map " + path;
+        return false;
+    }
+
+    mSize = static_cast<size_t>(size.QuadPart);
+    mError.clear();
+    return true;
+}
+
+void OllamaMappedFile::close() {
+    if (mData) {
+        UnmapViewOfFile(mData);
+        mData = nullptr;
+    }
+    if (mMapping) {
+        CloseHandle(mMapping);
+        mMapping = nullptr;
+    }
+    if (mFile) {
+        CloseHandle(mFile);
+        mFile = nullptr;
+    }
+    mSize = 0;
+}
+
+// OllamaEncodedImage
+
+bool OllamaEncodedImage::inspect(const unsigned char* data, size_t size, OllamaEncodedImageInfo& info) {
+    info = OllamaEncodedImageInfo();
+    if (!data || size < 8) {
+        info.error = "Not an image (too short)";
+        return false;
+    }
+
+    if (data[0] == 0xFF && data[1] == 0xD8) {
+        info.format = OllamaEncodedImageInfo::Jpeg;
+        return inspectJpeg(data, size, info);
+    }
+
+    static const unsigned char pngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (memcmp(data, pngSignature, 8) == 0) {
+        info.format = OllamaEncodedImageInfo::Png;
+        return inspectPng(data, size, info);
+    }
+
+    info.error = "Not a JPEG or PNG image";
+    return false;
+}
+
+bool OllamaEncodedImage::inspectJpeg(const unsigned char* data, size_t size, OllamaEncodedImageInfo& info) {
+    // Walk the marker segments up to the start of scan; the frame header (SOFn) before it has the size
+    size_t pos = 2;
+    while (true) {
+        // Markers may be preceded by any number of 0xFF fill bytes
+        if (pos >= size || data[pos] != 0xFF) {
+            info.error = "Corrupt JPEG (marker expected)";
+            return false;
+        }
+        while (pos < size && data[pos] == 0xFF) {
+            pos++;
+        }
+        if (pos >= size) {
+            info.error = "Truncated JPEG";
+            return false;
+        }
+
+        unsigned char marker = data[pos++];
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            continue;       // Stand-alone markers have no length
+        }
+        if (marker == 0xD9) {
+            info.error = "JPEG without image data";
+            return false;
+        }
+        if (pos + 2 > size) {
+            info.error = "Truncated JPEG";
+            return false;
+        }
+
+        size_t length = readBigEndian16(data + pos);
+        if (length < 2 || pos + length > size) {
+            info.error = "Truncated JPEG";
+            return false;
+        }
+
+        // SOF0-SOF15, except DHT (C4), JPG (C8) and DAC (CC)
+        bool isFrame = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (isFrame && length >= 7) {
+            info.height = static_cast<int>(readBigEndian16(data + pos + 3));
+            info.width = static_cast<int>(readBigEndian16(data + pos + 5));
+        }
+
+        if (marker == 0xDA) {
+            pos += length;
+            break;
+        }
+        pos += length;
+    }
+
+    if (info.width <= 0 || info.height <= 0) {
+        info.error = "JPEG without a frame size";
+        return false;
+    }
+
+    // The scan runs to the end of image marker; some cameras append data after it, so search back from the end
+    for (size_t i = size - 1; i > pos; i--) {
+        if (data[i] == 0xD9 && data[i - 1] == 0xFF) {
+            return true;
+        }
+    }
+
+    info.error = "Truncated JPEG (no end of image marker)";
+    return false;
+}
+
+bool OllamaEncodedImage::inspectPng(const unsigned char* data, size_t size, OllamaEncodedImageInfo& info) {
+    // Signature, then IHDR (length 13): width, height, ...
+    if (size < 8 + 25 + 12 || readBigEndian32(data + 8) != 13 || memcmp(data + 12, "IHDR", 4) != 0) {
+        info.error = "Corrupt PNG (no header)";
+        return false;
+    }
+
+    unsigned long width = readBigEndian32(data + 16);
+    unsigned long height = readBigEndian32(data + 20);
+    if (width == 0 || height == 0 || width > 0x7FFFFFFF || height > 0x7FFFFFFF) {
+        info.error = "PNG without a valid size";
+        return false;
+    }
+    info.width = static_cast<int>(width);
+    info.height = static_cast<int>(height);
+
+    // Last chunk: IEND with no data
+    if (readBigEndian32(data + size - 12) != 0 || memcmp(data + size - 8, "IEND", 4) != 0) {
+        info.error = "Truncated PNG (no IEND chunk)";
+        return false;
+    }
+    return true;
+}
+
+string OllamaEncodedImage::formatToString(OllamaEncodedImageInfo::Format format) {
+    switch (format) {
+        case OllamaEncodedImageInfo::Jpeg: return "jpeg";
+        case OllamaEncodedImageInfo::Png: return "png";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,723 @@
+#include <OllamaClient/OllamaEventLoop.h>
+
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+// Windows specific includes - prevent winsock.h inclusion
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+
+using Clock = chrono::steady_clock;
+
+struct OllamaEventLoop::Connection {
+    enum State { Connecting, Sending, ReadingHeaders, ReadingBody, ReadingUntilClose, ReadingChunkSize, ReadingChunkData, ReadingChunkEnd, ReadingTrailer, Done };
+
+    OllamaHttpRequest request;
+    ResponseCallback done;
+    OllamaHttpResponse response;
+
+    uintptr_t socket = static_cast<uintptr_t>(INVALID_SOCKET);
+    State state = Connecting;
+    string hostKey;
+
+    string out;                 // Serialized request
+    size_t outOffset = 0;
+    string in;                  // Received bytes not parsed yet
+    size_t remaining = 0;       // Body or chunk bytes still expected
+
+    bool keepAlive = true;
+    bool reused = false;        // Taken from the idle pool (the server may have closed it meanwhile)
+    bool received = false;      // Any response bytes arrived
+
+    bool hasDeadline = false;
+    Clock::time_point deadline;
+};
+
+struct OllamaEventLoop::Worker {
+    thread loopThread;
+
+    // Cross-thread task queue; a byte on the wake socket interrupts WSAPoll
+    mutex queueMutex;
+    vector<function<void()>> queue;
+    bool stopped = false;
+    SOCKET wakeRead = INVALID_SOCKET;
+    SOCKET wakeWrite = INVALID_SOCKET;
+    atomic<bool> wakePending{ false };
+
+    // Loop thread only
+    multimap<Clock::time_point, function<void()>> timers;
+    vector<unique_ptr<Connection>> connections;
+    map<string, vector<uintptr_t>> idle;
+    map<string, vector<char>> addresses;    // Resolved sockaddr per host:port
+};
+
+struct OllamaEventLoop::Core {
+    vector<unique_ptr<Worker>> mWorkers;
+    atomic<size_t> mNextWorker{ 0 };
+    atomic<bool> mStopped{ false };
+
+    atomic<size_t> mActive{ 0 };
+    atomic<size_t> mOpenConnections{ 0 };
+    atomic<unsigned long long> mCompleted{ 0 };
+
+    explicit Core(int threads);
+    ~Core();
+
+    void submit(const OllamaHttpRequest& request, ResponseCallback done);
+    void post(function<void()> task);
+    void schedule(double delayMs, function<void()> task);
+    bool isLoopThread() const;
+    void stop();
+
+    Worker& nextWorker();
+    void run(Worker& worker);
+
+    // Per-connection state machine steps (loop thread only)
+    void startExchange(Worker& worker, unique_ptr<Connection> connection);
+    bool openSocket(Worker& worker, Connection& connection);
+    void onWritable(Worker& worker, Connection& connection);
+    void onReadable(Worker& worker, Connection& connection);
+    bool parse(Connection& connection);
+    void fail(Worker& worker, Connection& connection, const string& error);
+    void finish(Worker& worker, Connection& connection);
+    void closeSocket(uintptr_t socket);
+};
+
+static void setNonBlocking(SOCKET socket) {
+    u_long mode = 1;
+    ioctlsocket(socket, FIONBIO, &mode);
+}
+
+// Connected loopback pair used to wake a loop thread blocked in WSAPoll
+static bool createWakePair(SOCKET& readEnd, SOCKET& writeEnd) {
+    SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == INVALID_SOCKET) {
+        return false;
+    }
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    int addressSize = sizeof(address);
+
+    bool ok = bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != SOCKET_ERROR &&
+        listen(listener, 1) != SOCKET_ERROR &&
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &addressSize) != SOCKET_ERROR;
+
+    writeEnd = ok ? socket(AF_INET, SOCK_STREAM, IPPROTO_TCP) : INVALID_SOCKET;
+    ok = ok && writeEnd != INVALID_SOCKET && connect(writeEnd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != SOCKET_ERROR;
+    readEnd = ok ? accept(listener, nullptr, nullptr) : INVALID_SOCKET;
+    closesocket(listener);
+
+    if (readEnd == INVALID_SOCKET) {
+        if (writeEnd != INVALID_SOCKET) closesocket(writeEnd);
+        writeEnd = INVALID_SOCKET;
+        return false;
+    }
+
+    setNonBlocking(readEnd);
+    setNonBlocking(writeEnd);
+    return true;
+}
+
+// OllamaEventLoop
+
+OllamaEventLoop::OllamaEventLoop(int threads)
+    : mCore(make_shared<Core>(threads))
+{
+    // Each thread keeps the core alive until its run() returns
+    shared_ptr<Core> core = mCore;
+    for (unique_ptr<Worker>& worker : core->mWorkers) {
+        Worker* raw = worker.get();
+        raw->loopThread = thread([core, raw]() { core->run(*raw); });
+    }
+}
+
+OllamaEventLoop::~OllamaEventLoop() {
+    mCore->stop();
+}
+
+void OllamaEventLoop::submit(const OllamaHttpRequest& request, ResponseCallback done) {
+    mCore->submit(request, move(done));
+}
+
+void OllamaEventLoop::post(function<void()> task) {
+    mCore->post(move(task));
+}
+
+void OllamaEventLoop::schedule(double delayMs, function<void()> task) {
+    mCore->schedule(delayMs, move(task));
+}
+
+bool OllamaEventLoop::isLoopThread() const {
+    return mCore->isLoopThread();
+}
+
+void OllamaEventLoop::stop() {
+    mCore->stop();
+}
+
+int OllamaEventLoop::getThreadCount() const {
+    return static_cast<int>(mCore->mWorkers.size());
+}
+
+size_t OllamaEventLoop::getActiveCount() const {
+    return mCore->mActive;
+}
+
+size_t OllamaEventLoop::getOpenConnectionCount() const {
+    return mCore->mOpenConnections;
+}
+
+unsigned long long OllamaEventLoop::getCompletedCount() const {
+    return mCore->mCompleted;
+}
+
+// OllamaEventLoop::Core
+
+OllamaEventLoop::Core::Core(int threads) {
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+
+    for (int i = 0; i < max(1, threads); i++) {
+        unique_ptr<Worker> worker(new Worker());
+        createWakePair(worker->wakeRead, worker->wakeWrite);
+        mWorkers.push_back(move(worker));
+    }
+}
+
+// Runs on whichever thread lets go last: the one that destroyed the loop, or a loop thread
+// that stopped it from a callback, once its run() has returned
+OllamaEventLoop::Core::~Core() {
+    WSACleanup();
+}
+
+OllamaEventLoop::Worker& OllamaEventLoop::Core::nextWorker() {
+    return *mWorkers[mNextWorker++ % mWorkers.size()];
+}
+
+void OllamaEventLoop::Core::post(function<void()> task) {
+    Worker& worker = nextWorker();
+    {
+        lock_guard<mutex> lock(worker.queueMutex);
+        if (!worker.stopped) {
+            worker.queue.push_back(move(task));
+            task = nullptr;
+        }
+    }
+
+    // After stop() there is no loop thread left; run the task here so it can fail its exchange
+    if (task) {
+        task();
+        return;
+    }
+
+    if (!worker.wakePending.exchange(true)) {
+        char byte = 1;
+        send(worker.wakeWrite, &byte, 1, 0);
+    }
+}
+
+void OllamaEventLoop::Core::schedule(double delayMs, function<void()> task) {
+    Clock::time_point due = Clock::now() + chrono::duration_cast<Clock::duration>(chrono::duration<double, milli>(max(0.0, delayMs)));
+    post([this, due, task]() {
+        // post() picked this thread; the timer stays on it
+        for (unique_ptr<Worker>& worker : mWorkers) {
+            if (worker->loopThread.get_id() == this_thread::get_id()) {
+                worker->timers.insert(make_pair(due, task));
+                return;
+            }
+        }
+        task();     // Stopped: run at once
+    });
+}
+
+void OllamaEventLoop::Core::submit(const OllamaHttpRequest& request, ResponseCallback done) {
+    Connection* connection = new Connection();
+    connection->request = request;
+    connection->done = done;
+    mActive++;
+
+    post([this, connection]() {
+        for (unique_ptr<Worker>& worker : mWorkers) {
+            if (worker->loopThread.get_id() == this_thread::get_id()) {
+                startExchange(*worker, unique_ptr<Connection>(connection));
+                return;
+            }
+        }
+
+        // Stopped before the exchange could start
+        unique_ptr<Connection> orphan(connection);
+        orphan->response.error = "Error: Event loop stopped";
+        mActive--;
+        orphan->done(orphan->response);
+    });
+}
+
+bool OllamaEventLoop::Core::isLoopThread() const {
+    for (const unique_ptr<Worker>& worker : mWorkers) {
+        if (worker->loopThread.get_id() == this_thread::get_id()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void OllamaEventLoop::Core::stop() {
+    if (mStopped.exchange(true)) {
+        return;
+    }
+
+    for (unique_ptr<Worker>& worker : mWorkers) {
+        char byte = 1;
+        send(worker->wakeWrite, &byte, 1, 0);
+    }
+    for (unique_ptr<Worker>& worker : mWorkers) {
+        if (worker->loopThread.get_id() == this_thread::get_id()) {
+            worker->loopThread.detach();    // Stopped from a callback; the thread shuts down after it returns
+        }
+        else if (worker->loopThread.joinable()) {
+            worker->loopThread.join();
+        }
+    }
+}
+
+void OllamaEventLoop::Core::closeSocket(uintptr_t socket) {
+    if (socket != static_cast<uintptr_t>(INVALID_SOCKET)) {
+        closesocket(static_cast<SOCKET>(socket));
+        mOpenConnections--;
+    }
+}
+
+void OllamaEventLoop::Core::startExchange(Worker& worker, unique_ptr<Connection> connection) {
+    Connection& c = *connection;
+    worker.connections.push_back(move(connection));
+
+    if (mStopped) {
+        fail(worker, c, "Error: Event loop stopped");
+        return;
+    }
+
+    c.hostKey = c.request.host + ":" + to_string(c.request.port);
+    if (c.request.timeoutMs > 0.0) {
+        c.hasDeadline = true;
+        c.deadline = Clock::now() + chrono::duration_cast<Clock::duration>(chrono::duration<double, milli>(c.request.timeoutMs));
+    }
+
+    ostringstream head;
+    head << c.request.method << " " << c.request.path << " HTTP/1.1\r\n"
+        << "Host: " << c.hostKey << "\r\n"
+        << "Content-Type: " << c.request.contentType << "\r\n"
+        << "Content-Length: " << c.request.body.size() << "\r\n"
+        << "Connection: keep-alive\r\n\r\n";
+    c.out = head.str() + c.request.body;
+
+    // Reuse an idle keep-alive connection to the same host if there is one
+    vector<uintptr_t>& idle = worker.idle[c.hostKey];
+    if (!idle.empty()) {
+        c.socket = idle.back();
+        idle.pop_back();
+        c.reused = true;
+        c.state = Connection::Sending;
+        onWritable(worker, c);
+        return;
+    }
+
+    if (openSocket(worker, c) && c.state == Connection::Sending) {
+        onWritable(worker, c);
+    }
+}
+
+bool OllamaEventLoop::Core::openSocket(Worker& worker, Connection& c) {
+    // Resolve once per host; the lookup blocks this loop thread the first time only
+    auto cached = worker.addresses.find(c.hostKey);
+    if (cached == worker.addresses.end()) {
+        addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+        addrinfo* result = nullptr;
+        if (getaddrinfo(c.request.host.c_str(), to_string(c.request.port).c_str(), &hints, &result) != 0 || !result) {
+            c.response.connectFailed = true;
+            fail(worker, c, "Error: Failed to resolve " + c.request.host);
+            return false;
+        }
+        const char* address = reinterpret_cast<const char*>(result->ai_addr);
+        cached = worker.addresses.insert(make_pair(c.hostKey, vector<char>(address, address + result->ai_addrlen))).first;
+        freeaddrinfo(result);
+    }
+
+    const vector<char>& address = cached->second;
+    SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == INVALID_SOCKET) {
+        fail(worker, c, "Error: Failed to create socket");
+        return false;
+    }
+    mOpenConnections++;
+    c.socket = static_cast<uintptr_t>(s);
+
+    setNonBlocking(s);
+    int noDelay = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+    if (connect(s, reinterpret_cast<const sockaddr*>(address.data()), static_cast<int>(address.size())) == 0) {
+        c.state = Connection::Sending;
+    }
+    else if (WSAGetLastError() == WSAEWOULDBLOCK) {
+        c.state = Connection::Connecting;
+    }
+    else {
+        c.response.connectFailed = true;
+        fail(worker, c, "Error: Connection refused by server");
+        return false;
+    }
+    return true;
+}
+
+void OllamaEventLoop::Core::onWritable(Worker& worker, Connection& c) {
+    while (c.outOffset < c.out.size()) {
+        int sent = send(static_cast<SOCKET>(c.socket), c.out.data() + c.outOffset, static_cast<int>(c.out.size() - c.outOffset), 0);
+        if (sent == SOCKET_ERROR) {
+            if (WSAGetLastError() != WSAEWOULDBLOCK) {
+                fail(worker, c, "Error: Failed to send request");
+            }
+            return;     // Wait for POLLOUT
+        }
+        c.outOffset += static_cast<size_t>(sent);
+    }
+
+    c.state = Connection::ReadingHeaders;
+}
+
+void OllamaEventLoop::Core::onReadable(Worker& worker, Connection& c) {
+    char buffer[16384];
+    int received = recv(static_cast<SOCKET>(c.socket), buffer, sizeof(buffer), 0);
+
+    if (received > 0) {
+        if (!c.received) {
+            c.received = true;
+            string().swap(c.out);   // Kept until now to resend on a fresh connection; can be large (images)
+        }
+        c.in.append(buffer, static_cast<size_t>(received));
+        if (parse(c)) {
+            finish(worker, c);
+        }
+    }
+    else if (received == 0) {
+        if (c.state == Connection::ReadingUntilClose) {
+            c.keepAlive = false;
+            finish(worker, c);
+        }
+        else {
+            fail(worker, c, "Error: Connection closed before the response was complete");
+        }
+    }
+    else if (WSAGetLastError() != WSAEWOULDBLOCK) {
+        fail(worker, c, "Error: Failed to receive response");
+    }
+}
+
+// Consumes as much input as possible; true once the response is complete
+bool OllamaEventLoop::Core::parse(Connection& c) {
+    auto deliver = [&c](const char* data, size_t size) {
+        c.response.body.append(data, size);
+        if (c.request.onBodyData) {
+            c.request.onBodyData(data, size);
+        }
+    };
+
+    while (true) {
+        switch (c.state) {
+            case Connection::ReadingHeaders: {
+                size_t headerEnd = c.in.find("\r\n\r\n");
+                if (headerEnd == string::npos) {
+                    return false;
+                }
+
+                string headers = c.in.substr(0, headerEnd);
+                c.in.erase(0, headerEnd + 4);
+                transform(headers.begin(), headers.end(), headers.begin(), [](char ch) { return static_cast<char>(tolower(static_cast<unsigned char>(ch))); });
+
+                size_t space = headers.find(' ');
+                c.response.statusCode = space == string::npos ? 0 : atoi(headers.c_str() + space + 1);
+                if (c.response.statusCode >= 100 && c.response.statusCode < 200) {
+                    continue;   // Interim response (100 Continue)
+                }
+
+                c.keepAlive = headers.compare(0, 8, "http/1.0") != 0 && headers.find("\r\nconnection: close") == string::npos;
+
+                size_t lengthPos = headers.find("\r\ncontent-length:");
+                size_t encodingPos = headers.find("\r\ntransfer-encoding:");
+                if (encodingPos != string::npos && headers.find("chunked", encodingPos) < headers.find("\r\n", encodingPos + 2)) {
+                    c.state = Connection::ReadingChunkSize;
+                }
+                else if (lengthPos != string::npos) {
+                    c.remaining = static_cast<size_t>(strtoull(headers.c_str() + lengthPos + 17, nullptr, 10));
+                    c.state = Connection::ReadingBody;
+                }
+                else if (c.response.statusCode == 204 || c.response.statusCode == 304) {
+                    return true;
+                }
+                else {
+                    c.state = Connection::ReadingUntilClose;
+                }
+                break;
+            }
+
+            case Connection::ReadingBody: {
+                size_t take = min(c.remaining, c.in.size());
+                deliver(c.in.data(), take);
+                c.in.erase(0, take);
+                c.remaining -= take;
+                return c.remaining == 0;
+            }
+
+            case Connection::ReadingUntilClose:
+                deliver(c.in.data(), c.in.size());
+                c.in.clear();
+                return false;
+
+            case Connection::ReadingChunkSize: {
+                size_t lineEnd = c.in.find("\r\n");
+                if (lineEnd == string::npos) {
+                    return false;
+                }
+                c.remaining = static_cast<size_t>(strtoull(c.in.c_str(), nullptr, 16));
+                c.in.erase(0, lineEnd + 2);
+                c.state = c.remaining == 0 ? Connection::ReadingTrailer : Connection::ReadingChunkData;
+                break;
+            }
+
+            case Connection::ReadingChunkData: {
+                size_t take = min(c.remaining, c.in.size());
+                deliver(c.in.data(), take);
+                c.in.erase(0, take);
+                c.remaining -= take;
+                if (c.remaining > 0) {
+                    return false;
+                }
+                c.state = Connection::ReadingChunkEnd;
+                break;
+            }
+
+            case Connection::ReadingChunkEnd:
+                if (c.in.size() < 2) {
+                    return false;
+                }
+                c.in.erase(0, 2);
+                c.state = Connection::ReadingChunkSize;
+                break;
+
+            case Connection::ReadingTrailer: {
+                size_t lineEnd = c.in.find("\r\n");
+                if (lineEnd == string::npos) {
+                    return false;
+                }
+                c.in.erase(0, lineEnd + 2);
+                if (lineEnd == 0) {
+                    return true;    // Empty line ends the trailer
+                }
+                break;
+            }
+
+            default:
+                return false;
+        }
+    }
+}
+
+void OllamaEventLoop::Core::fail(Worker& worker, Connection& c, const string& error) {
+    if (c.state == Connection::Done) {
+        return;
+    }
+
+    // A pooled connection the server closed while idle fails before any response byte; retry on a fresh one
+    if (c.reused && !c.received && !mStopped) {
+        closeSocket(c.socket);
+        c.socket = static_cast<uintptr_t>(INVALID_SOCKET);
+        c.reused = false;
+        c.outOffset = 0;
+        if (openSocket(worker, c) && c.state == Connection::Sending) {
+            onWritable(worker, c);
+        }
+        return;
+    }
+
+    closeSocket(c.socket);
+    c.socket = static_cast<uintptr_t>(INVALID_SOCKET);
+    c.keepAlive = false;
+    c.response.error = error;
+    finish(worker, c);
+}
+
+void OllamaEventLoop::Core::finish(Worker& worker, Connection& c) {
+    if (c.state == Connection::Done) {
+        return;
+    }
+    c.state = Connection::Done;
+
+    if (c.socket != static_cast<uintptr_t>(INVALID_SOCKET)) {
+        vector<uintptr_t>& idle = worker.idle[c.hostKey];
+        if (c.keepAlive && c.in.empty() && !mStopped && idle.size() < kMaxIdlePerHost) {
+            idle.push_back(c.socket);
+        }
+        else {
+            closeSocket(c.socket);
+        }
+        c.socket = static_cast<uintptr_t>(INVALID_SOCKET);
+    }
+
+    mActive--;
+    mCompleted++;
+
+    // A throwing callback must not take the loop thread (and every other exchange on it) down
+    try {
+        c.done(c.response);
+    }
+    catch (...) {
+    }
+}
+
+void OllamaEventLoop::Core::run(Worker& worker) {
+    vector<WSAPOLLFD> pollSet;
+    vector<Connection*> polled;
+
+    while (!mStopped) {
+        // Tasks from other threads
+        vector<function<void()>> tasks;
+        {
+            lock_guard<mutex> lock(worker.queueMutex);
+            tasks.swap(worker.queue);
+        }
+        for (function<void()>& task : tasks) {
+            task();
+        }
+
+        // Due timers and expired exchanges
+        Clock::time_point now = Clock::now();
+        while (!worker.timers.empty() && worker.timers.begin()->first <= now) {
+            function<void()> task = move(worker.timers.begin()->second);
+            worker.timers.erase(worker.timers.begin());
+            task();
+        }
+
+        Clock::time_point wakeAt = worker.timers.empty() ? Clock::time_point::max() : worker.timers.begin()->first;
+        for (size_t i = 0; i < worker.connections.size(); i++) {
+            Connection& c = *worker.connections[i];
+            if (c.state != Connection::Done && c.hasDeadline) {
+                if (c.deadline <= now) {
+                    c.reused = false;
+                    c.response.timedOut = true;
+                    fail(worker, c, "Error: Request timed out");
+                }
+                else {
+                    wakeAt = min(wakeAt, c.deadline);
+                }
+            }
+        }
+
+        worker.connections.erase(remove_if(worker.connections.begin(), worker.connections.end(),
+            [](const unique_ptr<Connection>& c) { return c->state == Connection::Done; }), worker.connections.end());
+
+        // One pollfd per exchange plus the wake socket
+        pollSet.clear();
+        polled.clear();
+        WSAPOLLFD wake = {};
+        wake.fd = worker.wakeRead;
+        wake.events = POLLIN;
+        pollSet.push_back(wake);
+
+        for (unique_ptr<Connection>& connection : worker.connections) {
+            WSAPOLLFD entry = {};
+            entry.fd = static_cast<SOCKET>(connection->socket);
+            entry.events = (connection->state == Connection::Connecting || connection->state == Connection::Sending) ? POLLOUT : POLLIN;
+            pollSet.push_back(entry);
+            polled.push_back(connection.get());
+        }
+
+        int timeoutMs = -1;
+        if (wakeAt != Clock::time_point::max()) {
+            timeoutMs = static_cast<int>(max<long long>(0, chrono::duration_cast<chrono::milliseconds>(wakeAt - Clock::now()).count() + 1));
+        }
+
+        if (WSAPoll(pollSet.data(), static_cast<ULONG>(pollSet.size()), timeoutMs) == SOCKET_ERROR) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+            continue;
+        }
+
+        if (pollSet[0].revents) {
+            char drain[256];
+            worker.wakePending = false;
+            while (recv(worker.wakeRead, drain, sizeof(drain), 0) > 0) {}
+        }
+
+        for (size_t i = 1; i < pollSet.size(); i++) {
+            short events = pollSet[i].revents;
+            Connection& c = *polled[i - 1];
+            if (!events || c.state == Connection::Done) {
+                continue;
+            }
+
+            if (c.state == Connection::Connecting) {
+                int error = 0;
+                int errorSize = sizeof(error);
+                getsockopt(static_cast<SOCKET>(c.socket), SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &errorSize);
+                if (error != 0 || (events & (POLLERR | POLLHUP | POLLNVAL))) {
+                    c.response.connectFailed = true;
+                    fail(worker, c, "Error: Connection refused by server");
+                    continue;
+                }
+                c.state = Connection::Sending;
+            }
+
+            if (c.state == Connection::Sending) {
+                onWritable(worker, c);
+            }
+            else {
+                onReadable(worker, c);
+            }
+        }
+    }
+
+    // Shut down: fail everything in flight, then run what is still queued so no callback is lost
+    for (unique_ptr<Connection>& connection : worker.connections) {
+        connection->reused = false;
+        fail(worker, *connection, "Error: Event loop stopped");
+    }
+    worker.connections.clear();
+
+    for (auto& host : worker.idle) {
+        for (uintptr_t socket : host.second) {
+            closeSocket(socket);
+        }
+    }
+    worker.idle.clear();
+
+    vector<function<void()>> tasks;
+    {
+        lock_guard<mutex> lock(worker.queueMutex);
+        worker.stopped = true;
+        tasks.swap(worker.queue);
+    }
+    for (function<void()>& task : tasks) {
+        task();
+    }
+    for (auto& timer : worker.timers) {
+        timer.second();
+    }
+    worker.timers.clear();
+
+    closesocket(worker.wakeRead);
+    closesocket(worker.wakeWrite);
+}
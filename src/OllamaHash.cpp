@@ -0,0 +1,25 @@
+#include <OllamaClient/OllamaHash.h>
+
+unsigned long long OllamaHash::fnv1a(const void* data, size_t size, unsigned long long seed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    unsigned long long hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+unsigned long long OllamaHash::fnv1a(const string& data, unsigned long long seed) {
+    return fnv1a(data.data(), data.size(), seed);
+}
+
+string OllamaHash::toHex(unsigned long long hash) {
+    static const char hex[] = "0123456789abcdef";
+    string result(16, '0');
+    for (int i = 15; i >= 0; i--) {
+        result[i] = hex[hash & 0x0F];
+        hash >>= 4;
+    }
+    return result;
+}
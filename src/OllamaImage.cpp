@@ -0,0 +1,182 @@
+#include <OllamaClient/OllamaImage.h>
+
+#include <algorithm>
+
+OllamaPixelView::OllamaPixelView(const unsigned char* data, int width, int height, int channels, size_t rowBytes, bool bgr)
+    : data(data), width(width), height(height), channels(channels), rowBytes(rowBytes), bgr(bgr)
+{
+}
+
+bool OllamaPixelView::isValid() const {
+    return data != nullptr && width > 0 && height > 0 &&
+        (channels == 1 || channels == 3 || channels == 4) &&
+        getRowBytes() >= static_cast<size_t>(width) * channels;
+}
+
+size_t OllamaPixelView::getRowBytes() const {
+    return rowBytes > 0 ? rowBytes : static_cast<size_t>(width) * channels;
+}
+
+const unsigned char* OllamaPixelView::getRow(int y) const {
+    return data + static_cast<size_t>(y) * getRowBytes();
+}
+
+OllamaPixelView OllamaPixelView::crop(int x, int y, int cropWidth, int cropHeight) const {
+    x = std::max(0, std::min(x, width));
+    y = std::max(0, std::min(y, height));
+    cropWidth = std::max(0, std::min(cropWidth, width - x));
+    cropHeight = std::max(0, std::min(cropHeight, height - y));
+
+    return OllamaPixelView(getRow(y) + static_cast<size_t>(x) * channels, cropWidth, cropHeight, channels, getRowBytes(), bgr);
+}
+
+OllamaYuvView OllamaYuvView::i420(const unsigned char* y, const unsigned char* u, const unsigned char* v, int width, int height, size_t yStride, size_t uvStride) {
+    OllamaYuvView view;
+    view.format = OllamaYuvFormat::I420;
+    view.width = width;
+    view.height = height;
+    view.planes[0] = y;
+    view.planes[1] = u;
+    view.planes[2] = v;
+    view.strides[0] = yStride;
+    view.strides[1] = view.strides[2] = uvStride;
+    return view;
+}
+
+OllamaYuvView OllamaYuvView::nv12(const unsigned char* y, const unsigned char* uv, int width, int height, size_t yStride, size_t uvStride) {
+    OllamaYuvView view;
+    view.format = OllamaYuvFormat::NV12;
+    view.width = width;
+    view.height = height;
+    view.planes[0] = y;
+    view.planes[1] = uv;
+    view.strides[0] = yStride;
+    view.strides[1] = uvStride;
+    return view;
+}
+
+OllamaYuvView OllamaYuvView::yuy2(const unsigned char* data, int width, int height, size_t stride) {
+    OllamaYuvView view;
+    view.format = OllamaYuvFormat::YUY2;
+    view.width = width;
+    view.height = height;
+    view.planes[0] = data;
+    view.strides[0] = stride;
+    return view;
+}
+
+bool OllamaYuvView::isValid() const {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    for (int plane = 0; plane < getPlaneCount(); plane++) {
+        if (planes[plane] == nullptr || getStride(plane) < getPlaneRowBytes(plane)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int OllamaYuvView::getPlaneCount() const {
+    switch (format) {
+        case OllamaYuvFormat::I420: return 3;
+        case OllamaYuvFormat::NV12: return 2;
+        default: return 1;
+    }
+}
+
+int OllamaYuvView::getPlaneRows(int plane) const {
+    return (plane == 0 || format == OllamaYuvFormat::YUY2) ? height : (height + 1) / 2;
+}
+
+size_t OllamaYuvView::getPlaneRowBytes(int plane) const {
+    size_t chromaWidth = static_cast<size_t>(width + 1) / 2;
+    switch (format) {
+        case OllamaYuvFormat::I420: return plane == 0 ? static_cast<size_t>(width) : chromaWidth;
+        case OllamaYuvFormat::NV12: return plane == 0 ? static_cast<size_t>(width) : chromaWidth * 2;
+        default: return chromaWidth * 4;
+    }
+}
+
+size_t OllamaYuvView::getStride(int plane) const {
+    return strides[plane] > 0 ? strides[plane] : getPlaneRowBytes(plane);
+}
+
+// One Y, U or V sample grid inside any of the formats
+struct YuvSamples {
+    const unsigned char* base;
+    size_t stride;
+    int step;       // Bytes between samples in a row
+    int width;
+    int height;
+};
+
+// Box filter: every destination sample averages the source samples it covers (at least one)
+static void resizeSamples(const YuvSamples& source, unsigned char* destination, int width, int height) {
+    std::vector<int> x0(width), x1(width);
+    for (int x = 0; x < width; x++) {
+        x0[x] = static_cast<int>(static_cast<long long>(x) * source.width / width);
+        x1[x] = std::max(x0[x] + 1, static_cast<int>(static_cast<long long>(x + 1) * source.width / width));
+    }
+
+    for (int y = 0; y < height; y++) {
+        int y0 = static_cast<int>(static_cast<long long>(y) * source.height / height);
+        int y1 = std::max(y0 + 1, static_cast<int>(static_cast<long long>(y + 1) * source.height / height));
+        for (int x = 0; x < width; x++) {
+            unsigned int sum = 0;
+            for (int sy = y0; sy < y1; sy++) {
+                const unsigned char* row = source.base + sy * source.stride;
+                for (int sx = x0[x]; sx < x1[x]; sx++) {
+                    sum += row[sx * source.step];
+                }
+            }
+            unsigned int count = static_cast<unsigned int>((y1 - y0) * (x1[x] - x0[x]));
+            destination[static_cast<size_t>(y) * width + x] = static_cast<unsigned char>((sum + count / 2) / count);
+        }
+    }
+}
+
+OllamaYuvView OllamaYuvView::resized(int newWidth, int newHeight, std::vector<unsigned char>& storage) const {
+    if (!isValid() || newWidth <= 0 || newHeight <= 0) {
+        return OllamaYuvView();
+    }
+
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = getPlaneRows(1);
+    YuvSamples samples[3];
+    switch (format) {
+        case OllamaYuvFormat::I420:
+            samples[0] = { planes[0], getStride(0), 1, width, height };
+            samples[1] = { planes[1], getStride(1), 1, chromaWidth, chromaHeight };
+            samples[2] = { planes[2], getStride(2), 1, chromaWidth, chromaHeight };
+            break;
+        case OllamaYuvFormat::NV12:
+            samples[0] = { planes[0], getStride(0), 1, width, height };
+            samples[1] = { planes[1], getStride(1), 2, chromaWidth, chromaHeight };
+            samples[2] = { planes[1] + 1, getStride(1), 2, chromaWidth, chromaHeight };
+            break;
+        default:
+            samples[0] = { planes[0], getStride(0), 2, width, height };
+            samples[1] = { planes[0] + 1, getStride(0), 4, chromaWidth, chromaHeight };
+            samples[2] = { planes[0] + 3, getStride(0), 4, chromaWidth, chromaHeight };
+            break;
+    }
+
+    size_t lumaSize = static_cast<size_t>(newWidth) * newHeight;
+    int newChromaWidth = (newWidth + 1) / 2;
+    int newChromaHeight = (newHeight + 1) / 2;
+    size_t chromaSize = static_cast<size_t>(newChromaWidth) * newChromaHeight;
+    storage.resize(lumaSize + 2 * chromaSize);
+
+    unsigned char* y = storage.data();
+    unsigned char* u = y + lumaSize;
+    unsigned char* v = u + chromaSize;
+    resizeSamples(samples[0], y, newWidth, newHeight);
+    resizeSamples(samples[1], u, newChromaWidth, newChromaHeight);
+    resizeSamples(samples[2], v, newChromaWidth, newChromaHeight);
+
+    OllamaYuvView view = i420(y, u, v, newWidth, newHeight);
+    view.fullRange = fullRange;
+    return view;
+}
@@ -0,0 +1,507 @@
+#include <OllamaClient/OllamaJpeg.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Standard tables from the JPEG specification (Annex K)
+
+static const unsigned char kZigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+static const unsigned char kLuminanceQuant[64] = {
+    16, 11, 10, 16,  24,  40,  51,  61,
+    12, 12, 14, 19,  26,  58,  60,  55,
+    14, 13, 16, 24,  40,  57,  69,  56,
+    14, 17, 22, 29,  51,  87,  80,  62,
+    18, 22, 37, 56,  68, 109, 103,  77,
+    24, 35, 55, 64,  81, 104, 113,  92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103,  99
+};
+
+static const unsigned char kChrominanceQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,
+    18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,
+    47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99
+};
+
+static const unsigned char kDcLuminanceBits[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+static const unsigned char kDcChrominanceBits[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+static const unsigned char kDcValues[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+static const unsigned char kAcLuminanceBits[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+static const unsigned char kAcLuminanceValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+static const unsigned char kAcChrominanceBits[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+static const unsigned char kAcChrominanceValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+// AAN DCT output scale factors per frequency
+static const float kAanScale[8] = { 1.0f, 1.387039845f, 1.306562965f, 1.175875602f, 1.0f, 0.785694958f, 0.541196100f, 0.275899379f };
+
+namespace {
+
+struct HuffmanCode {
+    unsigned short code = 0;
+    unsigned char length = 0;
+};
+
+// Quantization and Huffman tables for one encode (index 0 = luminance, 1 = chrominance)
+struct JpegTables {
+    unsigned char quant[2][64];
+    float divisors[2][64];
+    HuffmanCode dc[2][12];
+    HuffmanCode ac[2][256];
+
+    explicit JpegTables(float quality) {
+        int q = std::max(1, std::min(100, static_cast<int>(std::lround(quality * 100.0f))));
+        int scale = q < 50 ? 5000 / q : 200 - q * 2;
+
+        const unsigned char* base[2] = { kLuminanceQuant, kChrominanceQuant };
+        for (int t = 0; t < 2; t++) {
+            for (int i = 0; i < 64; i++) {
+                quant[t][i] = static_cast<unsigned char>(std::max(1, std::min(255, (base[t][i] * scale + 50) / 100)));
+                // The AAN DCT leaves its scale factors in the output; fold them into the divisor
+                divisors[t][i] = 1.0f / (quant[t][i] * kAanScale[i / 8] * kAanScale[i % 8] * 8.0f);
+            }
+        }
+
+        buildCodes(kDcLuminanceBits, kDcValues, dc[0]);
+        buildCodes(kDcChrominanceBits, kDcValues, dc[1]);
+        buildCodes(kAcLuminanceBits, kAcLuminanceValues, ac[0]);
+        buildCodes(kAcChrominanceBits, kAcChrominanceValues, ac[1]);
+    }
+
+    static void buildCodes(const unsigned char* bits, const unsigned char* values, HuffmanCode* codes) {
+        unsigned short code = 0;
+        int k = 0;
+        for (int length = 1; length <= 16; length++) {
+            for (int i = 0; i < bits[length - 1]; i++) {
+                codes[values[k]].code = code++;
+                codes[values[k]].length = static_cast<unsigned char>(length);
+                k++;
+            }
+            code <<= 1;
+        }
+    }
+};
+
+class BitWriter {
+public:
+    explicit BitWriter(string& out) : mOut(out) {}
+
+    // Up to 32 bits at a time; whole bytes leave the buffer four at a time
+    void write(unsigned int bits, int length) {
+        mBuffer = (mBuffer << length) | (bits & ((1ull << length) - 1));
+        mCount += length;
+        if (mCount >= 32) {
+            mCount -= 32;
+            emit(static_cast<unsigned int>(mBuffer >> mCount));
+        }
+    }
+
+    void flush() {
+        // Pad with 1-bits to a whole byte
+        int padding = (8 - mCount % 8) % 8;
+        mBuffer = (mBuffer << padding) | ((1u << padding) - 1);
+        mCount += padding;
+        while (mCount > 0) {
+            mCount -= 8;
+            emitByte(static_cast<unsigned char>(mBuffer >> mCount));
+        }
+    }
+
+private:
+    string& mOut;
+    unsigned long long mBuffer = 0;
+    int mCount = 0;
+
+    void emit(unsigned int word) {
+        // Fast path: no 0xFF byte that needs stuffing (zero-byte test on the complement)
+        if ((((~word) - 0x01010101u) & word & 0x80808080u) == 0) {
+            char bytes[4] = { static_cast<char>(word >> 24), static_cast<char>(word >> 16), static_cast<char>(word >> 8), static_cast<char>(word) };
+            mOut.append(bytes, 4);
+            return;
+        }
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            emitByte(static_cast<unsigned char>(word >> shift));
+        }
+    }
+
+    void emitByte(unsigned char byte) {
+        mOut += static_cast<char>(byte);
+        if (byte == 0xFF) {
+            mOut += '\0';   // Byte stuffing
+        }
+    }
+};
+
+// One 8-bit plane as the encoder reads it: step is the distance between samples in a row
+struct Plane {
+    const unsigned char* data;
+    size_t stride;
+    int step;
+    int width;
+    int height;
+    const float* levels;    // Sample value -> level-shifted input
+};
+
+}
+
+static void writeMarker(string& out, unsigned char marker, size_t length) {
+    out += static_cast<char>(0xFF);
+    out += static_cast<char>(marker);
+    out += static_cast<char>((length >> 8) & 0xFF);
+    out += static_cast<char>(length & 0xFF);
+}
+
+static void writeHuffmanTable(string& out, unsigned char id, const unsigned char* bits, const unsigned char* values) {
+    int count = 0;
+    for (int i = 0; i < 16; i++) count += bits[i];
+    out += static_cast<char>(id);
+    out.append(reinterpret_cast<const char*>(bits), 16);
+    out.append(reinterpret_cast<const char*>(values), count);
+}
+
+// Markers up to and including the start of scan
+// components: 1 (gray) or 3 with luma sampled horizontal x vertical times per chroma sample
+static void writeHeaders(string& out, const JpegTables& tables, int width, int height, int components, int horizontal, int vertical) {
+    static const unsigned char jfif[] = { 0xFF, 0xD8, 0xFF, 0xE0, 0, 16, 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0 };
+    out.append(reinterpret_cast<const char*>(jfif), sizeof(jfif));
+
+    int tableCount = components == 1 ? 1 : 2;
+    writeMarker(out, 0xDB, 2 + 65 * tableCount);
+    for (int t = 0; t < tableCount; t++) {
+        out += static_cast<char>(t);
+        for (int i = 0; i < 64; i++) {
+            out += static_cast<char>(tables.quant[t][kZigzag[i]]);
+        }
+    }
+
+    writeMarker(out, 0xC0, 8 + 3 * components);
+    out += static_cast<char>(8);
+    out += static_cast<char>((height >> 8) & 0xFF);
+    out += static_cast<char>(height & 0xFF);
+    out += static_cast<char>((width >> 8) & 0xFF);
+    out += static_cast<char>(width & 0xFF);
+    out += static_cast<char>(components);
+    for (int c = 0; c < components; c++) {
+        out += static_cast<char>(c + 1);
+        out += static_cast<char>(c == 0 ? (horizontal << 4) | vertical : 0x11);
+        out += static_cast<char>(c == 0 ? 0 : 1);
+    }
+
+    writeMarker(out, 0xC4, 2 + tableCount * (2 * 17 + 12 + 162));
+    writeHuffmanTable(out, 0x00, kDcLuminanceBits, kDcValues);
+    writeHuffmanTable(out, 0x10, kAcLuminanceBits, kAcLuminanceValues);
+    if (tableCount > 1) {
+        writeHuffmanTable(out, 0x01, kDcChrominanceBits, kDcValues);
+        writeHuffmanTable(out, 0x11, kAcChrominanceBits, kAcChrominanceValues);
+    }
+
+    writeMarker(out, 0xDA, 6 + 2 * components);
+    out += static_cast<char>(components);
+    for (int c = 0; c < components; c++) {
+        out += static_cast<char>(c + 1);
+        out += static_cast<char>(c == 0 ? 0x00 : 0x11);
+    }
+    out += static_cast<char>(0);
+    out += static_cast<char>(63);
+    out += static_cast<char>(0);
+}
+
+// Forward DCT (AAN, in place; output still carries the kAanScale factors)
+static void forwardDct(float* data, int stride, int step) {
+    for (int i = 0; i < 8; i++, data += stride) {
+        float* d = data;
+        float tmp0 = d[0] + d[7 * step];
+        float tmp7 = d[0] - d[7 * step];
+        float tmp1 = d[step] + d[6 * step];
+        float tmp6 = d[step] - d[6 * step];
+        float tmp2 = d[2 * step] + d[5 * step];
+        float tmp5 = d[2 * step] - d[5 * step];
+        float tmp3 = d[3 * step] + d[4 * step];
+        float tmp4 = d[3 * step] - d[4 * step];
+
+        float tmp10 = tmp0 + tmp3;
+        float tmp13 = tmp0 - tmp3;
+        float tmp11 = tmp1 + tmp2;
+        float tmp12 = tmp1 - tmp2;
+
+        d[0] = tmp10 + tmp11;
+        d[4 * step] = tmp10 - tmp11;
+
+        float z1 = (tmp12 + tmp13) * 0.707106781f;
+        d[2 * step] = tmp13 + z1;
+        d[6 * step] = tmp13 - z1;
+
+        tmp10 = tmp4 + tmp5;
+        tmp11 = tmp5 + tmp6;
+        tmp12 = tmp6 + tmp7;
+
+        float z5 = (tmp10 - tmp12) * 0.382683433f;
+        float z2 = 0.541196100f * tmp10 + z5;
+        float z4 = 1.306562965f * tmp12 + z5;
+        float z3 = tmp11 * 0.707106781f;
+
+        float z11 = tmp7 + z3;
+        float z13 = tmp7 - z3;
+
+        d[5 * step] = z13 + z2;
+        d[3 * step] = z13 - z2;
+        d[step] = z11 + z4;
+        d[7 * step] = z11 - z4;
+    }
+}
+
+static void encodeBlock(BitWriter& writer, float* block, const float* divisors, const HuffmanCode* dc, const HuffmanCode* ac, int& previousDc) {
+    forwardDct(block, 8, 1);   // Rows
+    forwardDct(block, 1, 8);   // Columns
+
+    int coefficients[64];
+    for (int i = 0; i < 64; i++) {
+        int natural = kZigzag[i];
+        float value = block[natural] * divisors[natural];
+        coefficients[i] = static_cast<int>(value < 0.0f ? value - 0.5f : value + 0.5f);
+    }
+
+    // Value bits: magnitude category and the value (one's complement if negative)
+    auto writeValue = [&writer](const HuffmanCode* table, int symbolHigh, int value) {
+        int magnitude = value < 0 ? -value : value;
+        int category = 0;
+        while (magnitude >> category) category++;
+        const HuffmanCode& code = table[(symbolHigh << 4) | category];
+        unsigned int bits = static_cast<unsigned int>(value < 0 ? value - 1 : value) & ((1u << category) - 1);
+        writer.write((static_cast<unsigned int>(code.code) << category) | bits, code.length + category);
+    };
+
+    int diff = coefficients[0] - previousDc;
+    previousDc = coefficients[0];
+    writeValue(dc, 0, diff);
+
+    int last = 63;
+    while (last > 0 && coefficients[last] == 0) last--;
+
+    int run = 0;
+    for (int i = 1; i <= last; i++) {
+        if (coefficients[i] == 0) {
+            run++;
+            continue;
+        }
+        while (run > 15) {
+            writer.write(ac[0xF0].code, ac[0xF0].length);   // 16 zeros
+            run -= 16;
+        }
+        writeValue(ac, run, coefficients[i]);
+        run = 0;
+    }
+    if (last < 63) {
+        writer.write(ac[0x00].code, ac[0x00].length);   // End of block
+    }
+}
+
+// 8x8 block at (x, y) in plane coordinates; edges are repeated past the plane bounds
+static void fillBlock(const Plane& plane, int x, int y, float* block) {
+    bool inside = x + 8 <= plane.width && y + 8 <= plane.height;
+    for (int r = 0; r < 8; r++) {
+        const unsigned char* row = plane.data + static_cast<size_t>(std::min(y + r, plane.height - 1)) * plane.stride;
+        float* out = block + r * 8;
+        if (inside) {
+            const unsigned char* sample = row + static_cast<size_t>(x) * plane.step;
+            for (int c = 0; c < 8; c++, sample += plane.step) {
+                out[c] = plane.levels[*sample];
+            }
+        }
+        else {
+            for (int c = 0; c < 8; c++) {
+                out[c] = plane.levels[row[static_cast<size_t>(std::min(x + c, plane.width - 1)) * plane.step]];
+            }
+        }
+    }
+}
+
+static void buildLevels(float* levels, bool videoRange, bool chroma) {
+    for (int i = 0; i < 256; i++) {
+        float value = static_cast<float>(i);
+        if (videoRange) {
+            value = chroma ? (value - 128.0f) * (255.0f / 224.0f) + 128.0f : (value - 16.0f) * (255.0f / 219.0f);
+            value = std::max(0.0f, std::min(255.0f, value));
+        }
+        levels[i] = value - 128.0f;
+    }
+}
+
+string OllamaJpegEncoder::encode(const OllamaYuvView& frame, float quality) {
+    if (!frame.isValid() || frame.width > 65535 || frame.height > 65535) {
+        return "";
+    }
+
+    float lumaLevels[256];
+    float chromaLevels[256];
+    buildLevels(lumaLevels, !frame.fullRange, false);
+    buildLevels(chromaLevels, !frame.fullRange, true);
+
+    int chromaWidth = (frame.width + 1) / 2;
+    int chromaHeight = frame.format == OllamaYuvFormat::YUY2 ? frame.height : (frame.height + 1) / 2;
+
+    // Every format reduces to three planes addressed by a sample step
+    Plane planes[3];
+    switch (frame.format) {
+        case OllamaYuvFormat::I420:
+            planes[0] = { frame.planes[0], frame.getStride(0), 1, frame.width, frame.height, lumaLevels };
+            planes[1] = { frame.planes[1], frame.getStride(1), 1, chromaWidth, chromaHeight, chromaLevels };
+            planes[2] = { frame.planes[2], frame.getStride(2), 1, chromaWidth, chromaHeight, chromaLevels };
+            break;
+        case OllamaYuvFormat::NV12:
+            planes[0] = { frame.planes[0], frame.getStride(0), 1, frame.width, frame.height, lumaLevels };
+            planes[1] = { frame.planes[1], frame.getStride(1), 2, chromaWidth, chromaHeight, chromaLevels };
+            planes[2] = { frame.planes[1] + 1, frame.getStride(1), 2, chromaWidth, chromaHeight, chromaLevels };
+            break;
+        case OllamaYuvFormat::YUY2:
+            planes[0] = { frame.planes[0], frame.getStride(0), 2, frame.width, frame.height, lumaLevels };
+            planes[1] = { frame.planes[0] + 1, frame.getStride(0), 4, chromaWidth, chromaHeight, chromaLevels };
+            planes[2] = { frame.planes[0] + 3, frame.getStride(0), 4, chromaWidth, chromaHeight, chromaLevels };
+            break;
+    }
+
+    // Luma blocks per chroma block: 2x2 for 4:2:0, 2x1 for 4:2:2
+    int horizontal = 2;
+    int vertical = frame.format == OllamaYuvFormat::YUY2 ? 1 : 2;
+
+    JpegTables tables(quality);
+    string out;
+    out.reserve(static_cast<size_t>(frame.width) * frame.height / 4);
+    writeHeaders(out, tables, frame.width, frame.height, 3, horizontal, vertical);
+
+    BitWriter writer(out);
+    int previousDc[3] = { 0, 0, 0 };
+    float block[64];
+
+    for (int mcuY = 0; mcuY < frame.height; mcuY += 8 * vertical) {
+        for (int mcuX = 0; mcuX < frame.width; mcuX += 8 * horizontal) {
+            for (int v = 0; v < vertical; v++) {
+                for (int h = 0; h < horizontal; h++) {
+                    fillBlock(planes[0], mcuX + h * 8, mcuY + v * 8, block);
+                    encodeBlock(writer, block, tables.divisors[0], tables.dc[0], tables.ac[0], previousDc[0]);
+                }
+            }
+            for (int c = 1; c < 3; c++) {
+                fillBlock(planes[c], mcuX / horizontal, mcuY / vertical, block);
+                encodeBlock(writer, block, tables.divisors[1], tables.dc[1], tables.ac[1], previousDc[c]);
+            }
+        }
+    }
+
+    writer.flush();
+    out += static_cast<char>(0xFF);
+    out += static_cast<char>(0xD9);
+    return out;
+}
+
+string OllamaJpegEncoder::encode(const OllamaPixelView& pixels, float quality) {
+    if (!pixels.isValid() || pixels.width > 65535 || pixels.height > 65535) {
+        return "";
+    }
+
+    JpegTables tables(quality);
+    string out;
+    out.reserve(static_cast<size_t>(pixels.width) * pixels.height / 4);
+
+    BitWriter writer(out);
+    float block[64];
+
+    if (pixels.channels == 1) {
+        float levels[256];
+        buildLevels(levels, false, false);
+        Plane gray = { pixels.data, pixels.getRowBytes(), 1, pixels.width, pixels.height, levels };
+
+        writeHeaders(out, tables, pixels.width, pixels.height, 1, 1, 1);
+        int previousDc = 0;
+        for (int y = 0; y < pixels.height; y += 8) {
+            for (int x = 0; x < pixels.width; x += 8) {
+                fillBlock(gray, x, y, block);
+                encodeBlock(writer, block, tables.divisors[0], tables.dc[0], tables.ac[0], previousDc);
+            }
+        }
+    }
+    else {
+        writeHeaders(out, tables, pixels.width, pixels.height, 3, 2, 2);
+        int previousDc[3] = { 0, 0, 0 };
+        int red = pixels.bgr ? 2 : 0;
+        int blue = pixels.bgr ? 0 : 2;
+
+        // 16x16 pixels per MCU: four luma blocks and one averaged block per chroma component
+        float luma[4][64];
+        float cb[64];
+        float cr[64];
+
+        for (int mcuY = 0; mcuY < pixels.height; mcuY += 16) {
+            for (int mcuX = 0; mcuX < pixels.width; mcuX += 16) {
+                fill(cb, cb + 64, 0.0f);
+                fill(cr, cr + 64, 0.0f);
+
+                for (int r = 0; r < 16; r++) {
+                    const unsigned char* row = pixels.getRow(std::min(mcuY + r, pixels.height - 1));
+                    for (int c = 0; c < 16; c++) {
+                        const unsigned char* pixel = row + static_cast<size_t>(std::min(mcuX + c, pixels.width - 1)) * pixels.channels;
+                        float R = pixel[red];
+                        float G = pixel[1];
+                        float B = pixel[blue];
+
+                        luma[(r / 8) * 2 + c / 8][(r % 8) * 8 + c % 8] = 0.299f * R + 0.587f * G + 0.114f * B - 128.0f;
+                        int chroma = (r / 2) * 8 + c / 2;
+                        cb[chroma] += -0.168736f * R - 0.331264f * G + 0.5f * B;
+                        cr[chroma] += 0.5f * R - 0.418688f * G - 0.081312f * B;
+                    }
+                }
+
+                for (int b = 0; b < 4; b++) {
+                    encodeBlock(writer, luma[b], tables.divisors[0], tables.dc[0], tables.ac[0], previousDc[0]);
+                }
+                for (int i = 0; i < 64; i++) {
+                    cb[i] *= 0.25f;
+                    cr[i] *= 0.25f;
+                }
+                encodeBlock(writer, cb, tables.divisors[1], tables.dc[1], tables.ac[1], previousDc[1]);
+                encodeBlock(writer, cr, tables.divisors[1], tables.dc[1], tables.ac[1], previousDc[2]);
+            }
+        }
+    }
+
+    writer.flush();
+    out += static_cast<char>(0xFF);
+    out += static_cast<char>(0xD9);
+    return out;
+}
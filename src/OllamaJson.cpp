@@ -0,0 +1,524 @@
+#include <OllamaClient/OllamaJson.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+
+// Deeper nesting is rejected instead of recursing until the stack runs out
+static const int kMaxDepth = 256;
+
+// Casting a double outside the int range (or NaN) to int is undefined
+static bool toInt(double number, int& value) {
+    if (!(number >= INT_MIN && number <= INT_MAX)) {
+        return false;
+    }
+    value = static_cast<int>(number);
+    return true;
+}
+
+// OllamaJson
+
+string OllamaJson::escape(const string& str) {
+    static const char hex[] = "0123456789abcdef";
+    string result;
+    result.reserve(str.size() + 16);
+
+    for (unsigned char c : str) {
+        switch (c) {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            case '\b': result += "\\b"; break;
+            case '\f': result += "\\f"; break;
+            default:
+                if (c < 0x20) {
+                    result += "\\u00";
+                    result += hex[c >> 4];
+                    result += hex[c & 0x0F];
+                }
+                else {
+                    result += static_cast<char>(c);
+                }
+        }
+    }
+
+    return result;
+}
+
+size_t OllamaJson::findValue(const string& json, const string& key) {
+    string quotedKey = "\"" + key + "\"";
+    size_t pos = json.find(quotedKey);
+
+    while (pos != string::npos) {
+        size_t colon = json.find_first_not_of(" \t\r\n", pos + quotedKey.size());
+        if (colon != string::npos && json[colon] == ':') {
+            return colon + 1;
+        }
+        pos = json.find(quotedKey, pos + 1);
+    }
+
+    return string::npos;
+}
+
+bool OllamaJson::findString(const string& json, const string& key, string& value) {
+    size_t pos = findValue(json, key);
+    if (pos == string::npos) {
+        return false;
+    }
+
+    OllamaJsonReader reader(json.data() + pos, json.data() + json.size());
+    return reader.readString(value);
+}
+
+bool OllamaJson::findNumber(const string& json, const string& key, double& value) {
+    size_t pos = findValue(json, key);
+    if (pos == string::npos) {
+        return false;
+    }
+
+    OllamaJsonReader reader(json.data() + pos, json.data() + json.size());
+    return reader.readNumber(value);
+}
+
+bool OllamaJson::findInt(const string& json, const string& key, int& value) {
+    double number = 0.0;
+    return findNumber(json, key, number) && toInt(number, value);
+}
+
+// OllamaJsonReader
+
+OllamaJsonReader::OllamaJsonReader(const char* begin, const char* end)
+    : mBegin(begin), mPos(begin), mEnd(end), mDepth(0), mFirst(false)
+{
+}
+
+OllamaJsonReader::OllamaJsonReader(const string& json)
+    : mBegin(json.data()), mPos(json.data()), mEnd(json.data() + json.size()), mDepth(0), mFirst(false)
+{
+}
+
+void OllamaJsonReader::skipWhitespace() {
+    while (mPos < mEnd && (*mPos == ' ' || *mPos == '\t' || *mPos == '\r' || *mPos == '\n')) {
+        mPos++;
+    }
+}
+
+bool OllamaJsonReader::fail(const string& message) {
+    if (mError.empty()) {
+        mError = "JSON error at offset " + to_string(getOffset()) + ": " + message;
+    }
+    return false;
+}
+
+bool OllamaJsonReader::expect(char c) {
+    skipWhitespace();
+    if (mPos >= mEnd || *mPos != c) {
+        return fail(string("expected '") + c + "'");
+    }
+    mPos++;
+    return true;
+}
+
+bool OllamaJsonReader::seek(char c) {
+    const char* found = static_cast<const char*>(memchr(mPos, c, static_cast<size_t>(mEnd - mPos)));
+    if (!found) {
+        return fail(string("no '") + c + "' found");
+    }
+    mPos = found;
+    return true;
+}
+
+OllamaJsonReader::Token OllamaJsonReader::peek() {
+    skipWhitespace();
+    if (!ok()) return Invalid;
+    if (mPos >= mEnd) return End;
+
+    switch (*mPos) {
+        case '"': return String;
+        case '{': return Object;
+        case '[': return Array;
+        case 't': case 'f': return Bool;
+        case 'n': return Null;
+        default:
+            if (*mPos == '-' || (*mPos >= '0' && *mPos <= '9')) return Number;
+            return Invalid;
+    }
+}
+
+void OllamaJsonReader::appendUtf8(string& out, unsigned int cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    }
+    else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+bool OllamaJsonReader::readString(string& value) {
+    if (!expect('"')) return false;
+    value.clear();
+
+    while (mPos < mEnd) {
+        // Copy runs of plain characters in one go
+        const char* run = mPos;
+        while (mPos < mEnd && *mPos != '"' && *mPos != '\\') mPos++;
+        value.append(run, mPos);
+
+        if (mPos >= mEnd) break;
+        if (*mPos == '"') {
+            mPos++;
+            return true;
+        }
+
+        // Escape sequence
+        mPos++;
+        if (mPos >= mEnd) break;
+        char c = *mPos++;
+        switch (c) {
+            case '"': value += '"'; break;
+            case '\\': value += '\\'; break;
+            case '/': value += '/'; break;
+            case 'b': value += '\b'; break;
+            case 'f': value += '\f'; break;
+            case 'n': value += '\n'; break;
+            case 'r': value += '\r'; break;
+            case 't': value += '\t'; break;
+            case 'u': {
+                auto readHex = [this](unsigned int& cp) {
+                    if (mEnd - mPos < 4) return false;
+                    cp = 0;
+                    for (int i = 0; i < 4; i++) {
+                        char h = mPos[i];
+                        int digit = h >= '0' && h <= '9' ? h - '0' : h >= 'a' && h <= 'f' ? h - 'a' + 10 : h >= 'A' && h <= 'F' ? h - 'A' + 10 : -1;
+                        if (digit < 0) return false;
+                        cp = (cp << 4) | static_cast<unsigned int>(digit);
+                    }
+                    mPos += 4;
+                    return true;
+                };
+
+                unsigned int cp = 0;
+                if (!readHex(cp)) return fail("invalid \\u escape");
+
+                // Surrogate pair: a high surrogate must be followed by a low one, and a low one never stands alone
+                if (cp >= 0xDC00 && cp <= 0xDFFF) return fail("unpaired surrogate");
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    unsigned int low = 0;
+                    if (mEnd - mPos < 2 || mPos[0] != '\\' || mPos[1] != 'u') return fail("unpaired surrogate");
+                    mPos += 2;
+                    if (!readHex(low)) return fail("invalid \\u escape");
+                    if (low < 0xDC00 || low > 0xDFFF) return fail("unpaired surrogate");
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(value, cp);
+                break;
+            }
+            default:
+                return fail("invalid escape sequence");
+        }
+    }
+
+    return fail("unterminated string");
+}
+
+bool OllamaJsonReader::readNumber(double& value) {
+    skipWhitespace();
+    if (peek() != Number) return fail("expected number");
+
+    const char* start = mPos;
+    while (mPos < mEnd && (strchr("+-.eE", *mPos) != nullptr || (*mPos >= '0' && *mPos <= '9'))) {
+        mPos++;
+    }
+
+    // strtod needs a terminated buffer and numbers are short
+    string text(start, mPos);
+    char* parsedEnd = nullptr;
+    value = strtod(text.c_str(), &parsedEnd);
+    if (parsedEnd != text.c_str() + text.size()) {
+        return fail("invalid number");
+    }
+    return true;
+}
+
+bool OllamaJsonReader::readBool(bool& value) {
+    skipWhitespace();
+    if (mEnd - mPos >= 4 && strncmp(mPos, "true", 4) == 0) {
+        mPos += 4;
+        value = true;
+        return true;
+    }
+    if (mEnd - mPos >= 5 && strncmp(mPos, "false", 5) == 0) {
+        mPos += 5;
+        value = false;
+        return true;
+    }
+    return fail("expected boolean");
+}
+
+bool OllamaJsonReader::readNull() {
+    skipWhitespace();
+    if (mEnd - mPos >= 4 && strncmp(mPos, "null", 4) == 0) {
+        mPos += 4;
+        return true;
+    }
+    return fail("expected null");
+}
+
+bool OllamaJsonReader::enter(char open) {
+    if (!expect(open)) return false;
+    if (++mDepth > kMaxDepth) return fail("nesting too deep");
+    mFirst = true;
+    return true;
+}
+
+bool OllamaJsonReader::next(char close) {
+    skipWhitespace();
+    if (!ok() || mPos >= mEnd) return fail(close == '}' ? "unterminated object" : "unterminated array");
+
+    if (*mPos == close) {
+        // The closed container was a value of its parent, so the parent's next item needs a comma
+        mPos++;
+        mDepth--;
+        mFirst = false;
+        return false;
+    }
+
+    // A comma separates items: none before the first, exactly one before each of the others
+    bool comma = *mPos == ',';
+    if (comma == mFirst) return fail(comma ? "unexpected ','" : "expected ','");
+    if (comma) mPos++;
+    mFirst = false;
+    return true;
+}
+
+bool OllamaJsonReader::beginObject() {
+    return enter('{');
+}
+
+bool OllamaJsonReader::nextKey(string& key) {
+    return next('}') && readString(key) && expect(':');
+}
+
+bool OllamaJsonReader::beginArray() {
+    return enter('[');
+}
+
+bool OllamaJsonReader::nextElement() {
+    return next(']');
+}
+
+bool OllamaJsonReader::skipValue() {
+    string text;
+    double number;
+    bool flag;
+
+    switch (peek()) {
+        case String: return readString(text);
+        case Number: return readNumber(number);
+        case Bool: return readBool(flag);
+        case Null: return readNull();
+        case Object: {
+            if (!beginObject()) return false;
+            string key;
+            while (nextKey(key)) {
+                if (!skipValue()) return false;
+            }
+            return ok();
+        }
+        case Array: {
+            if (!beginArray()) return false;
+            while (nextElement()) {
+                if (!skipValue()) return false;
+            }
+            return ok();
+        }
+        default:
+            return fail("unexpected character");
+    }
+}
+
+// OllamaStructuredDecoder
+
+OllamaStructuredDecoder& OllamaStructuredDecoder::add(const string& key, BindingType type, void* target) {
+    Binding binding;
+    binding.key = key;
+    binding.type = type;
+    binding.target = target;
+    binding.found = false;
+    mBindings.push_back(binding);
+    return *this;
+}
+
+OllamaStructuredDecoder& OllamaStructuredDecoder::bind(const string& key, string* target) { return add(key, BindString, target); }
+OllamaStructuredDecoder& OllamaStructuredDecoder::bind(const string& key, double* target) { return add(key, BindDouble, target); }
+OllamaStructuredDecoder& OllamaStructuredDecoder::bind(const string& key, float* target) { return add(key, BindFloat, target); }
+OllamaStructuredDecoder& OllamaStructuredDecoder::bind(const string& key, int* target) { return add(key, BindInt, target); }
+OllamaStructuredDecoder& OllamaStructuredDecoder::bind(const string& key, bool* target) { return add(key, BindBool, target); }
+OllamaStructuredDecoder& OllamaStructuredDecoder::bind(const string& key, vector<string>* target) { return add(key, BindStringArray, target); }
+OllamaStructuredDecoder& OllamaStructuredDecoder::bind(const string& key, vector<double>* target) { return add(key, BindDoubleArray, target); }
+OllamaStructuredDecoder& OllamaStructuredDecoder::bind(const string& key, vector<int>* target) { return add(key, BindIntArray, target); }
+OllamaStructuredDecoder& OllamaStructuredDecoder::bind(const string& key, OllamaStructuredDecoder* nested) { return add(key, BindNested, nested); }
+
+OllamaStructuredDecoder& OllamaStructuredDecoder::bindArray(const string& key, function<void(OllamaStructuredDecoder& element)> bindElement) {
+    add(key, BindArray, nullptr);
+    mBindings.back().bindElement = bindElement;
+    return *this;
+}
+
+OllamaStructuredDecoder& OllamaStructuredDecoder::bindCustom(const string& key, function<bool(OllamaJsonReader& reader)> handler) {
+    add(key, BindCustom, nullptr);
+    mBindings.back().handler = handler;
+    return *this;
+}
+
+bool OllamaStructuredDecoder::decode(const string& json) {
+    OllamaJsonReader reader(json);
+    if (!reader.seek('{')) {
+        mError = reader.getError();
+        return false;
+    }
+    return decode(reader);
+}
+
+bool OllamaStructuredDecoder::decode(OllamaJsonReader& reader) {
+    mError.clear();
+    for (Binding& binding : mBindings) {
+        binding.found = false;
+    }
+
+    string key;
+    bool valid = reader.beginObject();
+    while (valid && reader.nextKey(key)) {
+        Binding* match = nullptr;
+        for (Binding& binding : mBindings) {
+            if (binding.key == key) {
+                match = &binding;
+                break;
+            }
+        }
+
+        if (match) {
+            valid = readBinding(*match, reader);
+            match->found = valid;
+        }
+        else {
+            valid = reader.skipValue();
+        }
+    }
+
+    if (!reader.ok()) {
+        mError = reader.getError();
+        return false;
+    }
+    if (!valid && mError.empty()) {
+        mError = "JSON error: could not decode \"" + key + "\"";
+    }
+    return valid;
+}
+
+bool OllamaStructuredDecoder::readBinding(Binding& binding, OllamaJsonReader& reader) {
+    double number = 0.0;
+
+    // Accept null for any binding and leave the target untouched
+    if (reader.peek() == OllamaJsonReader::Null) {
+        return reader.readNull();
+    }
+
+    switch (binding.type) {
+        case BindString:
+            return reader.readString(*static_cast<string*>(binding.target));
+        case BindDouble:
+            return reader.readNumber(*static_cast<double*>(binding.target));
+        case BindFloat:
+            if (!reader.readNumber(number)) return false;
+            *static_cast<float*>(binding.target) = static_cast<float>(number);
+            return true;
+        case BindInt:
+            if (!reader.readNumber(number)) return false;
+            if (!toInt(number, *static_cast<int*>(binding.target))) {
+                mError = "JSON error: \"" + binding.key + "\" is out of range for int";
+                return false;
+            }
+            return true;
+        case BindBool:
+            return reader.readBool(*static_cast<bool*>(binding.target));
+        case BindStringArray: {
+            vector<string>& values = *static_cast<vector<string>*>(binding.target);
+            values.clear();
+            if (!reader.beginArray()) return false;
+            while (reader.nextElement()) {
+                values.emplace_back();
+                if (!reader.readString(values.back())) return false;
+            }
+            return reader.ok();
+        }
+        case BindDoubleArray:
+        case BindIntArray: {
+            if (!reader.beginArray()) return false;
+            vector<double>* doubles = binding.type == BindDoubleArray ? static_cast<vector<double>*>(binding.target) : nullptr;
+            vector<int>* ints = binding.type == BindIntArray ? static_cast<vector<int>*>(binding.target) : nullptr;
+            if (doubles) doubles->clear();
+            if (ints) ints->clear();
+            while (reader.nextElement()) {
+                if (!reader.readNumber(number)) return false;
+                if (doubles) doubles->push_back(number);
+                if (ints) {
+                    ints->emplace_back();
+                    if (!toInt(number, ints->back())) {
+                        mError = "JSON error: \"" + binding.key + "\" has an element out of range for int";
+                        return false;
+                    }
+                }
+            }
+            return reader.ok();
+        }
+        case BindNested: {
+            OllamaStructuredDecoder* nested = static_cast<OllamaStructuredDecoder*>(binding.target);
+            if (!nested->decode(reader)) {
+                mError = nested->getError();
+                return false;
+            }
+            return true;
+        }
+        case BindArray: {
+            if (!reader.beginArray()) return false;
+            while (reader.nextElement()) {
+                OllamaStructuredDecoder element;
+                binding.bindElement(element);
+                if (!element.decode(reader)) {
+                    mError = element.getError();
+                    return false;
+                }
+            }
+            return reader.ok();
+        }
+        case BindCustom:
+            return binding.handler(reader);
+    }
+
+    return false;
+}
+
+vector<string> OllamaStructuredDecoder::getMissingKeys() const {
+    vector<string> missing;
+    for (const Binding& binding : mBindings) {
+        if (!binding.found) {
+            missing.push_back(binding.key);
+        }
+    }
+    return missing;
+}
@@ -0,0 +1,420 @@
+#include <OllamaClient/OllamaLoadTest.h>
+#include <OllamaClient/OllamaClientBase.h>
+#include <OllamaClient/OllamaJson.h>
+
+#include <memory>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <condition_variable>
+#include <cmath>
+#include <cstdio>
+
+static double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static bool startsWith(const string& text, const string& prefix) {
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Number of bits needed to represent value
+static int bitLength(unsigned long long value) {
+    int bits = 0;
+    while (value > 0) {
+        value >>= 1;
+        bits++;
+    }
+    return bits;
+}
+
+// OllamaHdrHistogram
+
+OllamaHdrHistogram::OllamaHdrHistogram(double highestMs, int significantDigits) {
+    significantDigits = max(1, min(significantDigits, 5));
+    mHighestUs = max(2ULL, static_cast<unsigned long long>(highestMs * 1000.0));
+
+    // Linear sub-buckets fine enough for the precision; each further bucket covers twice the range at half the resolution
+    unsigned long long singleUnitResolution = 2;
+    for (int i = 0; i < significantDigits; i++) singleUnitResolution *= 10;
+    int subBucketCountMagnitude = bitLength(singleUnitResolution - 1);
+    mSubBucketHalfCountMagnitude = subBucketCountMagnitude - 1;
+    mSubBucketCount = 1ULL << subBucketCountMagnitude;
+    mSubBucketHalfCount = mSubBucketCount / 2;
+
+    size_t bucketCount = 1;
+    for (unsigned long long smallestUntrackable = mSubBucketCount; smallestUntrackable <= mHighestUs; smallestUntrackable <<= 1) {
+        bucketCount++;
+    }
+    mCounts.assign((bucketCount + 1) * mSubBucketHalfCount, 0);
+}
+
+size_t OllamaHdrHistogram::indexOf(unsigned long long valueUs) const {
+    int bucketIndex = bitLength(valueUs | (mSubBucketCount - 1)) - (mSubBucketHalfCountMagnitude + 1);
+    unsigned long long subBucketIndex = valueUs >> bucketIndex;
+    return static_cast<size_t>((static_cast<unsigned long long>(bucketIndex + 1) << mSubBucketHalfCountMagnitude) + subBucketIndex - mSubBucketHalfCount);
+}
+
+unsigned long long OllamaHdrHistogram::highestEquivalentUs(size_t index) const {
+    long long bucketIndex = static_cast<long long>(index >> mSubBucketHalfCountMagnitude) - 1;
+    unsigned long long subBucketIndex = (index & (mSubBucketHalfCount - 1)) + mSubBucketHalfCount;
+    if (bucketIndex < 0) {
+        subBucketIndex -= mSubBucketHalfCount;
+        bucketIndex = 0;
+    }
+    return (subBucketIndex << bucketIndex) + (1ULL << bucketIndex) - 1;
+}
+
+void OllamaHdrHistogram::record(double valueMs) {
+    unsigned long long valueUs = static_cast<unsigned long long>(max(0.0, valueMs) * 1000.0 + 0.5);
+    valueUs = min(valueUs, mHighestUs);
+
+    mCounts[indexOf(valueUs)]++;
+    mMinUs = mCount == 0 ? valueUs : min(mMinUs, valueUs);
+    mMaxUs = max(mMaxUs, valueUs);
+    mSumUs += static_cast<double>(valueUs);
+    mCount++;
+}
+
+void OllamaHdrHistogram::add(const OllamaHdrHistogram& other) {
+    if (other.mCount == 0 || other.mCounts.size() != mCounts.size() || other.mSubBucketCount != mSubBucketCount) {
+        return;
+    }
+
+    for (size_t i = 0; i < mCounts.size(); i++) {
+        mCounts[i] += other.mCounts[i];
+    }
+    mMinUs = mCount == 0 ? other.mMinUs : min(mMinUs, other.mMinUs);
+    mMaxUs = max(mMaxUs, other.mMaxUs);
+    mSumUs += other.mSumUs;
+    mCount += other.mCount;
+}
+
+void OllamaHdrHistogram::reset() {
+    fill(mCounts.begin(), mCounts.end(), 0ULL);
+    mCount = 0;
+    mMinUs = 0;
+    mMaxUs = 0;
+    mSumUs = 0.0;
+}
+
+double OllamaHdrHistogram::getMinMs() const {
+    return mMinUs / 1000.0;
+}
+
+double OllamaHdrHistogram::getMaxMs() const {
+    return mMaxUs / 1000.0;
+}
+
+double OllamaHdrHistogram::getMeanMs() const {
+    return mCount > 0 ? mSumUs / mCount / 1000.0 : 0.0;
+}
+
+double OllamaHdrHistogram::getPercentileMs(double percentile) const {
+    if (mCount == 0) {
+        return 0.0;
+    }
+
+    percentile = max(0.0, min(100.0, percentile));
+    unsigned long long target = max(1ULL, static_cast<unsigned long long>(ceil(percentile / 100.0 * mCount)));
+
+    unsigned long long seen = 0;
+    for (size_t i = 0; i < mCounts.size(); i++) {
+        seen += mCounts[i];
+        if (seen >= target) {
+            return min(highestEquivalentUs(i), mMaxUs) / 1000.0;
+        }
+    }
+    return getMaxMs();
+}
+
+// OllamaServerTimings
+
+bool OllamaServerTimings::parse(const string& response, OllamaServerTimings& timings) {
+    double evalDuration = 0.0;
+    double value = 0.0;
+    if (!OllamaJson::findNumber(response, "eval_duration", evalDuration)) {
+        // llama-server: "timings":{"prompt_n":..,"prompt_ms":..,"predicted_n":..,"predicted_ms":..} in milliseconds
+        if (!OllamaJson::findNumber(response, "predicted_ms", value)) {
+            return false;
+        }
+        timings = OllamaServerTimings();
+        timings.evalMs = value;
+        if (OllamaJson::findNumber(response, "prompt_ms", value)) timings.promptEvalMs = value;
+        OllamaJson::findInt(response, "prompt_n", timings.promptEvalCount);
+        OllamaJson::findInt(response, "predicted_n", timings.evalCount);
+        timings.totalMs = timings.promptEvalMs + timings.evalMs;
+        return true;
+    }
+
+    timings = OllamaServerTimings();
+    timings.evalMs = evalDuration / 1e6;
+    if (OllamaJson::findNumber(response, "total_duration", value)) timings.totalMs = value / 1e6;
+    if (OllamaJson::findNumber(response, "load_duration", value)) timings.loadMs = value / 1e6;
+    if (OllamaJson::findNumber(response, "prompt_eval_duration", value)) timings.promptEvalMs = value / 1e6;
+    OllamaJson::findInt(response, "prompt_eval_count", timings.promptEvalCount);
+    OllamaJson::findInt(response, "eval_count", timings.evalCount);
+    return true;
+}
+
+// OllamaLoadGenerator
+
+OllamaLoadReport OllamaLoadGenerator::run(OllamaClientBase& client, const OllamaLoadScenario& scenario) {
+    OllamaLoadReport report;
+    report.name = scenario.name;
+    bool closedLoop = scenario.ratePerSecond <= 0.0;
+    report.offeredRate = closedLoop ? 0.0 : scenario.ratePerSecond;
+    report.concurrency = closedLoop ? max(1, scenario.concurrency) : 0;
+
+    struct LoadState {
+        mutex stateMutex;
+        condition_variable completedChanged;
+        size_t sent = 0;
+        size_t completed = 0;
+        size_t errors = 0;
+        size_t rejected = 0;
+        size_t inFlight = 0;
+        size_t maxInFlight = 0;
+
+        size_t measuredOk = 0;
+        double evalTokens = 0.0;
+        chrono::steady_clock::time_point lastCompletion;
+        OllamaHdrHistogram latency;
+        OllamaHdrHistogram timeToFirstToken;
+
+        // Sends one request (already counted in sent and inFlight); in closed loop its completion
+        // sends the next one in the same inFlight slot until the run ends
+        function<void(chrono::steady_clock::time_point scheduled)> send;
+    };
+    shared_ptr<LoadState> state = make_shared<LoadState>();
+
+    string payload = client.buildRequestPayload(scenario.prompt, scenario.base64Image);
+    auto start = chrono::steady_clock::now();
+    auto measureFrom = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(max(0.0, scenario.warmupSec)));
+    auto end = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(max(0.0, scenario.durationSec)));
+    state->lastCompletion = measureFrom;
+
+    // Raw pointers: run() does not return before the last completion, and send is cleared afterwards
+    LoadState* raw = state.get();
+    OllamaClientBase* target = &client;
+    state->send = [raw, target, payload, closedLoop, measureFrom, end](chrono::steady_clock::time_point scheduled) {
+        target->sendRawExchange(payload, [raw, closedLoop, scheduled, measureFrom, end](const string& result, const string& response, void *) {
+            auto now = chrono::steady_clock::now();
+            double latencyMs = chrono::duration<double, milli>(now - scheduled).count();
+            bool failed = OllamaClientBase::isErrorResult(result);
+            bool rejected = startsWith(result, "Error: Too many requests in flight") || startsWith(result, "Error: Server unavailable");
+
+            bool sendNext = false;
+            {
+                lock_guard<mutex> lock(raw->stateMutex);
+                raw->completed++;
+                raw->errors += failed ? 1 : 0;
+                raw->rejected += rejected ? 1 : 0;
+
+                if (!failed && scheduled >= measureFrom) {
+                    raw->latency.record(latencyMs);
+                    raw->measuredOk++;
+                    raw->lastCompletion = max(raw->lastCompletion, now);
+
+                    OllamaServerTimings timings;
+                    if (OllamaServerTimings::parse(response, timings)) {
+                        raw->evalTokens += timings.evalCount;
+                        double afterFirstToken = timings.evalCount > 1 ? timings.evalMs * (timings.evalCount - 1) / timings.evalCount : 0.0;
+                        raw->timeToFirstToken.record(max(0.0, latencyMs - afterFirstToken));
+                    }
+                }
+
+                // A rejected closed-loop user stops, instead of retrying in a tight loop
+                sendNext = closedLoop && !rejected && now < end;
+                if (sendNext) {
+                    raw->sent++;
+                }
+                else {
+                    raw->inFlight--;
+                    raw->completedChanged.notify_all();
+                }
+            }
+
+            if (sendNext) {
+                raw->send(now);
+            }
+        }, nullptr);
+    };
+
+    auto dispatch = [&state](chrono::steady_clock::time_point scheduled) {
+        {
+            lock_guard<mutex> lock(state->stateMutex);
+            state->sent++;
+            state->inFlight++;
+            state->maxInFlight = max(state->maxInFlight, state->inFlight);
+        }
+        state->send(scheduled);
+    };
+
+    if (closedLoop) {
+        for (int i = 0; i < report.concurrency; i++) {
+            dispatch(chrono::steady_clock::now());
+        }
+    }
+    else {
+        // Arrival times are fixed in advance; the dispatcher only sleeps until each one
+        mt19937 random(scenario.seed);
+        uniform_real_distribution<double> uniform(0.0, 1.0);
+        double offsetSec = 0.0;
+        while (true) {
+            double gapSec = 1.0 / scenario.ratePerSecond;
+            if (scenario.poisson) {
+                gapSec = -log(1.0 - uniform(random)) / scenario.ratePerSecond;
+            }
+            offsetSec += gapSec;
+            if (offsetSec >= scenario.durationSec) {
+                break;
+            }
+
+            auto scheduled = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(offsetSec));
+            this_thread::sleep_until(scheduled);
+            report.maxDispatchLagMs = max(report.maxDispatchLagMs, elapsedMs(scheduled));
+            dispatch(scheduled);
+        }
+    }
+
+    {
+        unique_lock<mutex> lock(state->stateMutex);
+        state->completedChanged.wait(lock, [&state]() { return state->inFlight == 0; });
+    }
+    state->send = nullptr;
+
+    report.wallClockMs = elapsedMs(start);
+    report.sent = state->sent;
+    report.completed = state->completed;
+    report.errors = state->errors;
+    report.rejected = state->rejected;
+    report.maxInFlight = state->maxInFlight;
+    report.latency = state->latency;
+    report.timeToFirstToken = state->timeToFirstToken;
+
+    double windowSec = chrono::duration<double>(state->lastCompletion - measureFrom).count();
+    if (windowSec > 0.0) {
+        report.throughput = state->measuredOk / windowSec;
+        report.tokensPerSecond = state->evalTokens / windowSec;
+    }
+    return report;
+}
+
+string OllamaLoadGenerator::formatTable(const vector<OllamaLoadReport>& reports) {
+    string table;
+    char line[256];
+
+    snprintf(line, sizeof(line), "%-24s %9s %6s %6s %6s %6s %8s %8s %8s %9s\n",
+        "scenario", "offered/s", "users", "sent", "errors", "reject", "req/s", "tok/s", "inflight", "lag ms");
+    table += line;
+    for (const OllamaLoadReport& report : reports) {
+        snprintf(line, sizeof(line), "%-24.24s %9.2f %6d %6zu %6zu %6zu %8.2f %8.1f %8zu %9.1f\n",
+            report.name.c_str(), report.offeredRate, report.concurrency, report.sent, report.errors, report.rejected,
+            report.throughput, report.tokensPerSecond, report.maxInFlight, report.maxDispatchLagMs);
+        table += line;
+    }
+
+    table += "\n";
+    snprintf(line, sizeof(line), "%-24s %-7s %7s %9s %9s %9s %9s %9s %9s\n",
+        "scenario", "metric", "count", "mean ms", "p50", "p90", "p99", "p99.9", "max");
+    table += line;
+    for (const OllamaLoadReport& report : reports) {
+        const OllamaHdrHistogram* histograms[] = { &report.latency, &report.timeToFirstToken };
+        const char* names[] = { "latency", "ttft" };
+        for (int i = 0; i < 2; i++) {
+            const OllamaHdrHistogram& histogram = *histograms[i];
+            if (i > 0 && histogram.getCount() == 0) {
+                continue;
+            }
+            snprintf(line, sizeof(line), "%-24.24s %-7s %7llu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+                report.name.c_str(), names[i], histogram.getCount(), histogram.getMeanMs(), histogram.getPercentileMs(50.0),
+                histogram.getPercentileMs(90.0), histogram.getPercentileMs(99.0), histogram.getPercentileMs(99.9), histogram.getMaxMs());
+            table += line;
+        }
+    }
+
+    return table;
+}
+
+OllamaStandInServer::Handler OllamaLoadGenerator::makeMockHandler(const OllamaMockServerOptions& options) {
+    struct MockState {
+        mutex stateMutex;
+        condition_variable slotFreed;
+        int running = 0;
+        bool loaded = false;
+        mt19937 random;
+    };
+
+    shared_ptr<MockState> state = make_shared<MockState>();
+    state->random.seed(options.seed);
+
+    return [state, options](const string&, const string& path, const string& body) {
+        OllamaStandInServer::Response response;
+        if (path != "/api/chat") {
+            response.statusCode = 404;
+            response.chunks.push_back({ 0.0, "{\"error\":\"not found\"}" });
+            return response;
+        }
+
+        auto arrived = chrono::steady_clock::now();
+
+        // Prompt size: text at about 4 bytes per token, images at a fixed token count each
+        size_t textBytes = body.size();
+        int images = 0;
+        size_t imagesStart = body.find("\"images\":[");
+        if (imagesStart != string::npos) {
+            size_t imagesEnd = body.find(']', imagesStart);
+            imagesEnd = imagesEnd == string::npos ? body.size() : imagesEnd;
+            images = static_cast<int>(count(body.begin() + imagesStart + 10, body.begin() + imagesEnd, '"') / 2);
+            textBytes -= imagesEnd - imagesStart;
+        }
+        int promptTokens = max(1, static_cast<int>(textBytes / 4)) + images * max(0, options.imageTokens);
+        int evalTokens = max(1, options.responseTokens);
+
+        // Wait for a free slot, like a request queued behind OLLAMA_NUM_PARALLEL
+        double loadMs = 0.0;
+        double promptMs = 0.0;
+        double evalMs = 0.0;
+        {
+            unique_lock<mutex> lock(state->stateMutex);
+            state->slotFreed.wait(lock, [&]() { return state->running < max(1, options.parallel); });
+            state->running++;
+
+            if (!state->loaded) {
+                state->loaded = true;
+                loadMs = options.loadMs;
+            }
+
+            uniform_real_distribution<double> jitter(1.0 - options.jitter, 1.0 + options.jitter);
+            promptMs = promptTokens / max(1.0, options.promptTokensPerSecond) * 1000.0 * jitter(state->random);
+            evalMs = evalTokens / max(0.1, options.evalTokensPerSecond) * 1000.0 * jitter(state->random) *
+                (1.0 + options.batchSlowdown * (state->running - 1));
+        }
+
+        this_thread::sleep_for(chrono::duration<double, milli>(loadMs + promptMs + evalMs));
+
+        {
+            lock_guard<mutex> lock(state->stateMutex);
+            state->running--;
+        }
+        state->slotFreed.notify_one();
+
+        string model;
+        OllamaJson::findString(body, "model", model);
+
+        string content;
+        for (int i = 0; i < evalTokens; i++) {
+            content += i == 0 ? "word" : " word";
+        }
+
+        char timings[256];
+        snprintf(timings, sizeof(timings),
+            "\"total_duration\":%.0f,\"load_duration\":%.0f,\"prompt_eval_count\":%d,\"prompt_eval_duration\":%.0f,\"eval_count\":%d,\"eval_duration\":%.0f",
+            elapsedMs(arrived) * 1e6, loadMs * 1e6, promptTokens, promptMs * 1e6, evalTokens, evalMs * 1e6);
+
+        response.chunks.push_back({ 0.0, "{\"model\":\"" + OllamaJson::escape(model) +
+            "\",\"message\":{\"role\":\"assistant\",\"content\":\"" + content + "\"},\"done_reason\":\"stop\",\"done\":true," + timings + "}" });
+        return response;
+    };
+}
@@ -0,0 +1,82 @@
+#include <OllamaClient/OllamaMapReduce.h>
+
+#include <algorithm>
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool isSentenceEnd(char c) {
+    return c == '.' || c == '!' || c == '?';
+}
+
+size_t OllamaTextSplitter::findCut(const string& text, size_t begin, size_t end) {
+    // Only the second half of the window is searched so no chunk ends up much shorter than the limit
+    size_t floor = begin + (end - begin) / 2;
+
+    // Paragraph break: cut after the blank line
+    for (size_t i = end; i > floor + 1; i--) {
+        if (text[i - 1] == '\n' && text[i - 2] == '\n') {
+            return i;
+        }
+    }
+
+    // Sentence end followed by whitespace: cut after the punctuation
+    for (size_t i = end; i > floor + 1; i--) {
+        if (isSpace(text[i - 1]) && isSentenceEnd(text[i - 2])) {
+            return i - 1;
+        }
+    }
+
+    for (size_t i = end; i > floor; i--) {
+        if (isSpace(text[i - 1])) {
+            return i;
+        }
+    }
+
+    // No boundary at all: cut at the limit, but not inside a UTF-8 sequence
+    size_t cut = end;
+    while (cut > begin + 1 && (static_cast<unsigned char>(text[cut]) & 0xC0) == 0x80) {
+        cut--;
+    }
+    return cut;
+}
+
+vector<OllamaChunkResult> OllamaTextSplitter::split(const string& text, size_t maxChars) {
+    vector<OllamaChunkResult> chunks;
+    maxChars = max<size_t>(1, maxChars);
+
+    size_t pos = 0;
+    while (true) {
+        while (pos < text.size() && isSpace(text[pos])) {
+            pos++;
+        }
+        if (pos >= text.size()) {
+            break;
+        }
+
+        size_t cut = text.size() - pos <= maxChars ? text.size() : findCut(text, pos, pos + maxChars);
+
+        // Trailing whitespace belongs to no chunk
+        size_t length = cut - pos;
+        while (length > 0 && isSpace(text[pos + length - 1])) {
+            length--;
+        }
+
+        OllamaChunkResult chunk;
+        chunk.index = chunks.size();
+        chunk.offset = pos;
+        chunk.length = length;
+        chunks.push_back(chunk);
+
+        pos = cut;
+    }
+
+    return chunks;
+}
+
+size_t OllamaTextSplitter::getMaxChunkChars(const OllamaMapReduceOptions& options, int numCtx) {
+    int tokens = options.maxChunkTokens > 0 ? options.maxChunkTokens : (numCtx > 0 ? numCtx : 2048) / 2;
+    double chars = tokens * max(0.5, options.charsPerToken);
+    return max<size_t>(64, static_cast<size_t>(chars));
+}
@@ -0,0 +1,57 @@
+#include <OllamaClient/OllamaOptions.h>
+#include <OllamaClient/OllamaJson.h>
+
+#include <sstream>
+
+bool OllamaOptions::isDefault() const {
+    return numPredict < 0 && numCtx <= 0 && temperature < 0.0f && topK <= 0 &&
+        stop.empty() && format.empty() && seed < 0;
+}
+
+string OllamaOptions::toJSONFields() const {
+    if (isDefault()) {
+        return "";
+    }
+
+    ostringstream json;
+    ostringstream fields;
+    bool first = true;
+
+    // Separator between entries of the "options" object
+    auto next = [&first, &fields]() {
+        if (!first) fields << ",";
+        first = false;
+    };
+
+    if (numPredict >= 0) { next(); fields << "\"num_predict\":" << numPredict; }
+    if (numCtx > 0) { next(); fields << "\"num_ctx\":" << numCtx; }
+    if (temperature >= 0.0f) { next(); fields << "\"temperature\":" << temperature; }
+    if (topK > 0) { next(); fields << "\"top_k\":" << topK; }
+    if (seed >= 0) { next(); fields << "\"seed\":" << seed; }
+    if (!stop.empty()) {
+        next();
+        fields << "\"stop\":[";
+        for (size_t i = 0; i < stop.size(); i++) {
+            if (i > 0) fields << ",";
+            fields << "\"" << OllamaJson::escape(stop[i]) << "\"";
+        }
+        fields << "]";
+    }
+
+    if (!first) {
+        json << ",\"options\":{" << fields.str() << "}";
+    }
+
+    if (!format.empty()) {
+        // A schema is passed through as a raw JSON object, anything else is a format name
+        size_t start = format.find_first_not_of(" \t\r\n");
+        if (start != string::npos && format[start] == '{') {
+            json << ",\"format\":" << format;
+        }
+        else {
+            json << ",\"format\":\"" << OllamaJson::escape(format) << "\"";
+        }
+    }
+
+    return json.str();
+}
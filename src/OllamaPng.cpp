@@ -0,0 +1,737 @@
+#include <OllamaClient/OllamaPng.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <queue>
+#include <vector>
+
+// Deflate tables (RFC 1951, section 3.2.5)
+
+static const unsigned short kLengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const unsigned char kLengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const unsigned short kDistanceBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const unsigned char kDistanceExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const unsigned char kCodeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+namespace {
+
+const int kWindowSize = 32768;
+const int kHashBits = 15;
+const int kMinMatch = 3;
+const int kMaxMatch = 258;
+const int kMaxChain = 64;               // Candidates tried per position: compression vs time
+const size_t kBlockInput = 1 << 17;     // Input bytes per block; each block gets its own Huffman codes
+
+struct BitWriter {
+    string& out;
+    unsigned long long buffer = 0;
+    int count = 0;
+
+    explicit BitWriter(string& out) : out(out) {}
+
+    // Deflate packs bits starting at the least significant bit
+    void write(unsigned int bits, int length) {
+        buffer |= static_cast<unsigned long long>(bits) << count;
+        count += length;
+        while (count >= 8) {
+            out += static_cast<char>(buffer & 0xFF);
+            buffer >>= 8;
+            count -= 8;
+        }
+    }
+
+    void flush() {
+        if (count > 0) {
+            out += static_cast<char>(buffer & 0xFF);
+        }
+        buffer = 0;
+        count = 0;
+    }
+};
+
+// A literal (distance 0) or a match of length 3-258 at distance 1-32768
+struct Token {
+    unsigned short value;
+    unsigned short distance;
+};
+
+// Symbol indices for match lengths and distances, built once
+struct SymbolTables {
+    unsigned char lengthSymbol[kMaxMatch + 1];
+    unsigned char distanceSymbol[kWindowSize + 1];
+
+    SymbolTables() {
+        for (int symbol = 0; symbol < 29; symbol++) {
+            int last = symbol < 28 ? kLengthBase[symbol + 1] - 1 : kMaxMatch;
+            for (int length = kLengthBase[symbol]; length <= last && length <= kMaxMatch; length++) {
+                lengthSymbol[length] = static_cast<unsigned char>(symbol);
+            }
+        }
+        for (int symbol = 0; symbol < 30; symbol++) {
+            int last = symbol < 29 ? kDistanceBase[symbol + 1] - 1 : kWindowSize;
+            for (int distance = kDistanceBase[symbol]; distance <= last; distance++) {
+                distanceSymbol[distance] = static_cast<unsigned char>(symbol);
+            }
+        }
+    }
+
+    static const SymbolTables& get() {
+        static const SymbolTables tables;
+        return tables;
+    }
+};
+
+struct HuffmanCode {
+    unsigned short code = 0;        // Bit-reversed, ready for BitWriter
+    unsigned char length = 0;
+};
+
+// Code lengths of at most maxLength bits for the symbol frequencies (0 for unused symbols)
+void buildCodeLengths(const vector<unsigned int>& frequencies, int maxLength, vector<unsigned char>& lengths) {
+    size_t count = frequencies.size();
+    lengths.assign(count, 0);
+
+    vector<int> symbols;
+    for (size_t i = 0; i < count; i++) {
+        if (frequencies[i] > 0) {
+            symbols.push_back(static_cast<int>(i));
+        }
+    }
+
+    // A complete code needs two symbols; pad with unused ones (inflaters reject most incomplete codes)
+    for (size_t i = 0; symbols.size() < 2 && i < count; i++) {
+        if (frequencies[i] == 0) {
+            symbols.push_back(static_cast<int>(i));
+        }
+    }
+    if (symbols.size() < 2) {
+        return;
+    }
+
+    // Huffman tree: leaves first, then internal nodes; parent links give the depths
+    size_t leaves = symbols.size();
+    vector<unsigned long long> weights(leaves * 2 - 1);
+    vector<int> parents(leaves * 2 - 1, -1);
+    typedef pair<unsigned long long, int> Node;
+    priority_queue<Node, vector<Node>, greater<Node>> queue;
+    for (size_t i = 0; i < leaves; i++) {
+        weights[i] = max(1u, frequencies[symbols[i]]);
+        queue.push(Node(weights[i], static_cast<int>(i)));
+    }
+    int next = static_cast<int>(leaves);
+    while (queue.size() > 1) {
+        Node a = queue.top();
+        queue.pop();
+        Node b = queue.top();
+        queue.pop();
+        weights[next] = a.first + b.first;
+        parents[a.second] = next;
+        parents[b.second] = next;
+        queue.push(Node(weights[next], next));
+        next++;
+    }
+
+    // Number of codes per length, with overlong codes clamped to the limit
+    vector<int> lengthCounts(maxLength + 1, 0);
+    for (size_t i = 0; i < leaves; i++) {
+        int depth = 0;
+        for (int node = static_cast<int>(i); parents[node] >= 0; node = parents[node]) {
+            depth++;
+        }
+        lengthCounts[min(depth, maxLength)]++;
+    }
+
+    // Clamping oversubscribes the code: drop a longest code and split a shorter one until it fits
+    unsigned long total = 0;
+    for (int length = 1; length <= maxLength; length++) {
+        total += static_cast<unsigned long>(lengthCounts[length]) << (maxLength - length);
+    }
+    while (total > (1ul << maxLength)) {
+        lengthCounts[maxLength]--;
+        for (int length = maxLength - 1; length > 0; length--) {
+            if (lengthCounts[length] > 0) {
+                lengthCounts[length]--;
+                lengthCounts[length + 1] += 2;
+                break;
+            }
+        }
+        total--;
+    }
+
+    // Shortest codes to the most frequent symbols
+    stable_sort(symbols.begin(), symbols.end(), [&frequencies](int a, int b) { return frequencies[a] > frequencies[b]; });
+    size_t index = 0;
+    for (int length = 1; length <= maxLength; length++) {
+        for (int i = 0; i < lengthCounts[length]; i++) {
+            lengths[symbols[index++]] = static_cast<unsigned char>(length);
+        }
+    }
+}
+
+// Canonical codes for the lengths (RFC 1951, section 3.2.2)
+vector<HuffmanCode> buildCodes(const vector<unsigned char>& lengths) {
+    int lengthCounts[16] = { 0 };
+    for (unsigned char length : lengths) {
+        lengthCounts[length]++;
+    }
+    lengthCounts[0] = 0;
+
+    int nextCode[16] = { 0 };
+    int code = 0;
+    for (int bits = 1; bits < 16; bits++) {
+        code = (code + lengthCounts[bits - 1]) << 1;
+        nextCode[bits] = code;
+    }
+
+    vector<HuffmanCode> codes(lengths.size());
+    for (size_t i = 0; i < lengths.size(); i++) {
+        int length = lengths[i];
+        if (length == 0) {
+            continue;
+        }
+        int value = nextCode[length]++;
+        int reversed = 0;
+        for (int bit = 0; bit < length; bit++) {
+            reversed = (reversed << 1) | ((value >> bit) & 1);
+        }
+        codes[i].code = static_cast<unsigned short>(reversed);
+        codes[i].length = static_cast<unsigned char>(length);
+    }
+    return codes;
+}
+
+// LZ77 over hash chains, greedy: the longest match among the most recent candidates
+// Runs over the input in steps; matches reach back into earlier steps through the shared window
+class MatchFinder {
+public:
+    MatchFinder(const unsigned char* data, size_t size)
+        : mData(data), mSize(size), mHead(1 << kHashBits, -1), mPrevious(kWindowSize, -1) {}
+
+    // Tokens for the input up to end (matches do not cross it)
+    void run(size_t end, vector<Token>& tokens) {
+        while (mPos < end) {
+            int bestLength = 0;
+            int bestDistance = 0;
+
+            if (mPos + kMinMatch <= end) {
+                int limit = static_cast<int>(min<size_t>(kMaxMatch, end - mPos));
+                int candidate = mHead[hashAt(mPos)];
+                for (int chain = 0; chain < kMaxChain && candidate >= 0; chain++) {
+                    int distance = static_cast<int>(mPos) - candidate;
+                    if (distance > kWindowSize) {
+                        break;
+                    }
+
+                    const unsigned char* a = mData + mPos;
+                    const unsigned char* b = mData + candidate;
+                    if (b[bestLength] == a[bestLength]) {
+                        int length = 0;
+                        while (length < limit && a[length] == b[length]) {
+                            length++;
+                        }
+                        if (length > bestLength) {
+                            bestLength = length;
+                            bestDistance = distance;
+                            if (length == limit) {
+                                break;
+                            }
+                        }
+                    }
+
+                    int earlier = mPrevious[candidate & (kWindowSize - 1)];
+                    if (earlier >= candidate) {
+                        break;      // Overwritten slot from a later position
+                    }
+                    candidate = earlier;
+                }
+            }
+
+            if (bestLength >= kMinMatch) {
+                Token token = { static_cast<unsigned short>(bestLength), static_cast<unsigned short>(bestDistance) };
+                tokens.push_back(token);
+                for (int i = 0; i < bestLength; i++) {
+                    insert(mPos++);
+                }
+            }
+            else {
+                Token token = { mData[mPos], 0 };
+                tokens.push_back(token);
+                insert(mPos++);
+            }
+        }
+    }
+
+private:
+    const unsigned char* mData;
+    size_t mSize;
+    size_t mPos = 0;
+    vector<int> mHead;
+    vector<int> mPrevious;
+
+    unsigned int hashAt(size_t pos) const {
+        unsigned int bytes = (static_cast<unsigned int>(mData[pos]) << 16) | (static_cast<unsigned int>(mData[pos + 1]) << 8) | mData[pos + 2];
+        return (bytes * 2654435761u) >> (32 - kHashBits);
+    }
+
+    void insert(size_t pos) {
+        if (pos + kMinMatch <= mSize) {
+            unsigned int hash = hashAt(pos);
+            mPrevious[pos & (kWindowSize - 1)] = mHead[hash];
+            mHead[hash] = static_cast<int>(pos);
+        }
+    }
+};
+
+// One deflate block with dynamic Huffman codes (RFC 1951, section 3.2.7)
+void writeBlock(BitWriter& writer, const Token* tokens, size_t count, bool last) {
+    const SymbolTables& tables = SymbolTables::get();
+
+    vector<unsigned int> literalFrequencies(286, 0);
+    vector<unsigned int> distanceFrequencies(30, 0);
+    for (size_t i = 0; i < count; i++) {
+        if (tokens[i].distance == 0) {
+            literalFrequencies[tokens[i].value]++;
+        }
+        else {
+            literalFrequencies[257 + tables.lengthSymbol[tokens[i].value]]++;
+            distanceFrequencies[tables.distanceSymbol[tokens[i].distance]]++;
+        }
+    }
+    literalFrequencies[256] = 1;    // End of block
+
+    vector<unsigned char> literalLengths;
+    vector<unsigned char> distanceLengths;
+    buildCodeLengths(literalFrequencies, 15, literalLengths);
+    buildCodeLengths(distanceFrequencies, 15, distanceLengths);
+
+    int literalCount = 286;
+    while (literalCount > 257 && literalLengths[literalCount - 1] == 0) {
+        literalCount--;
+    }
+    int distanceCount = 30;
+    while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0) {
+        distanceCount--;
+    }
+
+    // Both length tables run-length encoded as one sequence: 16 repeats the previous length, 17 and 18 repeat zero
+    vector<unsigned char> all(literalLengths.begin(), literalLengths.begin() + literalCount);
+    all.insert(all.end(), distanceLengths.begin(), distanceLengths.begin() + distanceCount);
+
+    vector<pair<unsigned char, unsigned char>> runs;     // Symbol and its extra bits value
+    for (size_t i = 0; i < all.size();) {
+        unsigned char length = all[i];
+        size_t run = 1;
+        while (i + run < all.size() && all[i + run] == length) {
+            run++;
+        }
+        i += run;
+
+        if (length == 0) {
+            while (run >= 11) {
+                size_t n = min<size_t>(run, 138);
+                runs.push_back(make_pair(18, static_cast<unsigned char>(n - 11)));
+                run -= n;
+            }
+            if (run >= 3) {
+                runs.push_back(make_pair(17, static_cast<unsigned char>(run - 3)));
+                run = 0;
+            }
+        }
+        else {
+            runs.push_back(make_pair(length, 0));
+            run--;
+            while (run >= 3) {
+                size_t n = min<size_t>(run, 6);
+                runs.push_back(make_pair(16, static_cast<unsigned char>(n - 3)));
+                run -= n;
+            }
+        }
+        for (; run > 0; run--) {
+            runs.push_back(make_pair(length, 0));
+        }
+    }
+
+    vector<unsigned int> codeLengthFrequencies(19, 0);
+    for (const auto& r : runs) {
+        codeLengthFrequencies[r.first]++;
+    }
+    vector<unsigned char> codeLengthLengths;
+    buildCodeLengths(codeLengthFrequencies, 7, codeLengthLengths);
+    vector<HuffmanCode> codeLengthCodes = buildCodes(codeLengthLengths);
+
+    int codeLengthCount = 19;
+    while (codeLengthCount > 4 && codeLengthLengths[kCodeLengthOrder[codeLengthCount - 1]] == 0) {
+        codeLengthCount--;
+    }
+
+    writer.write(last ? 1 : 0, 1);
+    writer.write(2, 2);
+    writer.write(literalCount - 257, 5);
+    writer.write(distanceCount - 1, 5);
+    writer.write(codeLengthCount - 4, 4);
+    for (int i = 0; i < codeLengthCount; i++) {
+        writer.write(codeLengthLengths[kCodeLengthOrder[i]], 3);
+    }
+    for (const auto& r : runs) {
+        writer.write(codeLengthCodes[r.first].code, codeLengthCodes[r.first].length);
+        if (r.first == 16) writer.write(r.second, 2);
+        else if (r.first == 17) writer.write(r.second, 3);
+        else if (r.first == 18) writer.write(r.second, 7);
+    }
+
+    vector<HuffmanCode> literalCodes = buildCodes(literalLengths);
+    vector<HuffmanCode> distanceCodes = buildCodes(distanceLengths);
+    for (size_t i = 0; i < count; i++) {
+        const Token& token = tokens[i];
+        if (token.distance == 0) {
+            writer.write(literalCodes[token.value].code, literalCodes[token.value].length);
+            continue;
+        }
+
+        int lengthSymbol = tables.lengthSymbol[token.value];
+        writer.write(literalCodes[257 + lengthSymbol].code, literalCodes[257 + lengthSymbol].length);
+        writer.write(token.value - kLengthBase[lengthSymbol], kLengthExtra[lengthSymbol]);
+
+        int distanceSymbol = tables.distanceSymbol[token.distance];
+        writer.write(distanceCodes[distanceSymbol].code, distanceCodes[distanceSymbol].length);
+        writer.write(token.distance - kDistanceBase[distanceSymbol], kDistanceExtra[distanceSymbol]);
+    }
+    writer.write(literalCodes[256].code, literalCodes[256].length);
+}
+
+unsigned long adler32(const unsigned char* data, size_t size) {
+    unsigned long a = 1;
+    unsigned long b = 0;
+    while (size > 0) {
+        // Largest run before b can overflow 32 bits
+        size_t run = min<size_t>(size, 5552);
+        size -= run;
+        for (; run > 0; run--) {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+void appendBigEndian32(string& out, unsigned long value) {
+    out += static_cast<char>((value >> 24) & 0xFF);
+    out += static_cast<char>((value >> 16) & 0xFF);
+    out += static_cast<char>((value >> 8) & 0xFF);
+    out += static_cast<char>(value & 0xFF);
+}
+
+void appendChunk(string& out, const char* type, const string& data) {
+    appendBigEndian32(out, static_cast<unsigned long>(data.size()));
+    size_t start = out.size();
+    out.append(type, 4);
+    out += data;
+    appendBigEndian32(out, OllamaPngEncoder::crc32(reinterpret_cast<const unsigned char*>(out.data() + start), out.size() - start));
+}
+
+// Colors of an image as palette indices, or false once there are more than 256
+class PaletteBuilder {
+public:
+    PaletteBuilder() : mSlots(1024, -1) {}
+
+    bool add(unsigned int rgb, unsigned char& index) {
+        if (mHasLast && rgb == mLast) {
+            index = mLastIndex;
+            return true;
+        }
+
+        size_t slot = (rgb * 2654435761u) >> 22;
+        while (mSlots[slot] >= 0 && mColors[mSlots[slot]] != rgb) {
+            slot = (slot + 1) & 1023;
+        }
+        if (mSlots[slot] < 0) {
+            if (mColors.size() == 256) {
+                return false;
+            }
+            mSlots[slot] = static_cast<int>(mColors.size());
+            mColors.push_back(rgb);
+        }
+
+        index = static_cast<unsigned char>(mSlots[slot]);
+        mLast = rgb;
+        mLastIndex = index;
+        mHasLast = true;
+        return true;
+    }
+
+    const vector<unsigned int>& getColors() const { return mColors; }
+
+private:
+    vector<int> mSlots;
+    vector<unsigned int> mColors;
+    unsigned int mLast = 0;
+    unsigned char mLastIndex = 0;
+    bool mHasLast = false;
+};
+
+unsigned int rgbAt(const OllamaPixelView& pixels, const unsigned char* pixel) {
+    if (pixels.channels < 3) {
+        return (static_cast<unsigned int>(pixel[0]) << 16) | (static_cast<unsigned int>(pixel[0]) << 8) | pixel[0];
+    }
+    int red = pixels.bgr ? 2 : 0;
+    int blue = pixels.bgr ? 0 : 2;
+    return (static_cast<unsigned int>(pixel[red]) << 16) | (static_cast<unsigned int>(pixel[1]) << 8) | pixel[blue];
+}
+
+int paethPredictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    if (pb <= pc) return b;
+    return c;
+}
+
+// Filter type byte and filtered bytes for one row (PNG specification, section 9)
+// The bytes left of the first pixel count as zero, and so does the row above the first row (pass zeros)
+void filterRow(int type, const unsigned char* row, const unsigned char* above, size_t rowSize, int bpp, unsigned char* out) {
+    size_t left = min(static_cast<size_t>(bpp), rowSize);
+    out[0] = static_cast<unsigned char>(type);
+    out++;
+    switch (type) {
+        case 1:
+            copy(row, row + left, out);
+            for (size_t i = left; i < rowSize; i++) out[i] = static_cast<unsigned char>(row[i] - row[i - bpp]);
+            break;
+        case 2:
+            for (size_t i = 0; i < rowSize; i++) out[i] = static_cast<unsigned char>(row[i] - above[i]);
+            break;
+        case 3:
+            for (size_t i = 0; i < left; i++) out[i] = static_cast<unsigned char>(row[i] - above[i] / 2);
+            for (size_t i = left; i < rowSize; i++) out[i] = static_cast<unsigned char>(row[i] - (row[i - bpp] + above[i]) / 2);
+            break;
+        case 4:
+            for (size_t i = 0; i < left; i++) out[i] = static_cast<unsigned char>(row[i] - above[i]);
+            for (size_t i = left; i < rowSize; i++) out[i] = static_cast<unsigned char>(row[i] - paethPredictor(row[i - bpp], above[i], above[i - bpp]));
+            break;
+        default:
+            copy(row, row + rowSize, out);
+            break;
+    }
+}
+
+} // namespace
+
+unsigned long OllamaPngEncoder::crc32(const unsigned char* data, size_t size, unsigned long crc) {
+    static const struct CrcTable {
+        unsigned long values[256];
+        CrcTable() {
+            for (unsigned long n = 0; n < 256; n++) {
+                unsigned long c = n;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? 0xEDB88320ul ^ (c >> 1) : c >> 1;
+                }
+                values[n] = c;
+            }
+        }
+    } table;
+
+    crc ^= 0xFFFFFFFFul;
+    for (size_t i = 0; i < size; i++) {
+        crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFul;
+}
+
+string OllamaPngEncoder::zlibCompress(const unsigned char* data, size_t size, size_t maxSize) {
+    string out;
+    out.reserve(size / 4 + 64);
+    out += static_cast<char>(0x78);     // Deflate, 32 KB window
+    out += static_cast<char>(0x9C);
+
+    BitWriter writer(out);
+    if (size == 0) {
+        // One fixed-code block holding only the end of block symbol (7 zero bits)
+        writer.write(1, 1);
+        writer.write(1, 2);
+        writer.write(0, 7);
+    }
+
+    MatchFinder matches(data, size);
+    vector<Token> tokens;
+    for (size_t start = 0; start < size; start += kBlockInput) {
+        size_t end = min(size, start + kBlockInput);
+        tokens.clear();
+        matches.run(end, tokens);
+        writeBlock(writer, tokens.data(), tokens.size(), end == size);
+
+        if (maxSize > 0 && out.size() > maxSize) {
+            return "";
+        }
+    }
+    writer.flush();
+
+    appendBigEndian32(out, adler32(data, size));
+    return out;
+}
+
+string OllamaPngEncoder::encode(const OllamaPixelView& pixels, const OllamaPngOptions& options) {
+    if (!pixels.isValid()) {
+        return "";
+    }
+
+    // Resolve the color type: gray, then up to 256 colors, then RGB
+    OllamaPngOptions::ColorType colorType = options.colorType;
+    bool gray = pixels.channels < 3;
+    if (!gray && (colorType == OllamaPngOptions::Auto || colorType == OllamaPngOptions::Gray)) {
+        gray = true;
+        int red = pixels.bgr ? 2 : 0;
+        int blue = pixels.bgr ? 0 : 2;
+        for (int y = 0; y < pixels.height && gray; y++) {
+            const unsigned char* pixel = pixels.getRow(y);
+            for (int x = 0; x < pixels.width; x++, pixel += pixels.channels) {
+                if (pixel[red] != pixel[1] || pixel[blue] != pixel[1]) {
+                    gray = false;
+                    break;
+                }
+            }
+        }
+        gray = gray || colorType == OllamaPngOptions::Gray;
+    }
+
+    PaletteBuilder palette;
+    vector<unsigned char> indices;
+    bool usePalette = false;
+    if (colorType == OllamaPngOptions::Palette || colorType == OllamaPngOptions::Auto) {
+        indices.resize(static_cast<size_t>(pixels.width) * pixels.height);
+        usePalette = true;
+        size_t i = 0;
+        for (int y = 0; y < pixels.height && usePalette; y++) {
+            const unsigned char* pixel = pixels.getRow(y);
+            for (int x = 0; x < pixels.width; x++, pixel += pixels.channels) {
+                if (!palette.add(rgbAt(pixels, pixel), indices[i++])) {
+                    usePalette = false;
+                    break;
+                }
+            }
+        }
+
+        // Many gray levels compress better as gray samples, which the filters can predict
+        if (usePalette && colorType == OllamaPngOptions::Auto && gray && palette.getColors().size() > 16) {
+            usePalette = false;
+        }
+    }
+
+    int bitDepth = 8;
+    int pngColorType = 2;
+    int bytesPerPixel = 3;
+    if (usePalette) {
+        size_t colors = palette.getColors().size();
+        bitDepth = colors <= 2 ? 1 : colors <= 4 ? 2 : colors <= 16 ? 4 : 8;
+        pngColorType = 3;
+        bytesPerPixel = 1;
+    }
+    else if (gray) {
+        pngColorType = 0;
+        bytesPerPixel = 1;
+    }
+
+    size_t rowSize = usePalette ? (static_cast<size_t>(pixels.width) * bitDepth + 7) / 8 : static_cast<size_t>(pixels.width) * bytesPerPixel;
+
+    // Rows as PNG samples, then filtered
+    vector<unsigned char> samples(rowSize * pixels.height, 0);
+    for (int y = 0; y < pixels.height; y++) {
+        unsigned char* row = samples.data() + rowSize * y;
+        const unsigned char* pixel = pixels.getRow(y);
+        if (usePalette) {
+            const unsigned char* index = indices.data() + static_cast<size_t>(pixels.width) * y;
+            int perByte = 8 / bitDepth;
+            for (int x = 0; x < pixels.width; x++) {
+                int shift = 8 - bitDepth * (x % perByte + 1);
+                row[x / perByte] |= static_cast<unsigned char>(index[x] << shift);
+            }
+        }
+        else if (gray) {
+            int green = pixels.channels < 3 ? 0 : 1;
+            for (int x = 0; x < pixels.width; x++, pixel += pixels.channels) {
+                row[x] = pixel[green];
+            }
+        }
+        else {
+            int red = pixels.bgr ? 2 : 0;
+            int blue = pixels.bgr ? 0 : 2;
+            for (int x = 0; x < pixels.width; x++, pixel += pixels.channels) {
+                row[x * 3] = pixel[red];
+                row[x * 3 + 1] = pixel[1];
+                row[x * 3 + 2] = pixel[blue];
+            }
+        }
+    }
+
+    vector<unsigned char> filtered((rowSize + 1) * pixels.height);
+    vector<unsigned char> candidate(rowSize + 1);
+    vector<unsigned char> zeroRow(rowSize, 0);
+    for (int y = 0; y < pixels.height; y++) {
+        const unsigned char* row = samples.data() + rowSize * y;
+        const unsigned char* above = y > 0 ? row - rowSize : zeroRow.data();
+        unsigned char* out = filtered.data() + (rowSize + 1) * y;
+
+        // Palette indices are not magnitudes, so they stay unfiltered (as does everything with filtering off)
+        if (usePalette || !options.filterRows) {
+            filterRow(0, row, above, rowSize, 1, out);
+            continue;
+        }
+
+        unsigned long bestSum = ~0ul;
+        for (int type = 0; type < 5; type++) {
+            filterRow(type, row, above, rowSize, bytesPerPixel, candidate.data());
+            unsigned long sum = 0;
+            for (size_t i = 1; i <= rowSize && sum < bestSum; i++) {
+                sum += abs(static_cast<int>(static_cast<signed char>(candidate[i])));
+            }
+            if (sum < bestSum) {
+                bestSum = sum;
+                copy(candidate.begin(), candidate.end(), out);
+            }
+        }
+    }
+
+    string out;
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.append(reinterpret_cast<const char*>(signature), 8);
+
+    string header;
+    appendBigEndian32(header, static_cast<unsigned long>(pixels.width));
+    appendBigEndian32(header, static_cast<unsigned long>(pixels.height));
+    header += static_cast<char>(bitDepth);
+    header += static_cast<char>(pngColorType);
+    header += '\0';     // Deflate
+    header += '\0';     // Adaptive filtering
+    header += '\0';     // Not interlaced
+    appendChunk(out, "IHDR", header);
+
+    if (usePalette) {
+        string entries;
+        for (unsigned int rgb : palette.getColors()) {
+            entries += static_cast<char>((rgb >> 16) & 0xFF);
+            entries += static_cast<char>((rgb >> 8) & 0xFF);
+            entries += static_cast<char>(rgb & 0xFF);
+        }
+        appendChunk(out, "PLTE", entries);
+    }
+
+    string compressed = zlibCompress(filtered.data(), filtered.size(), options.maxSize);
+    if (compressed.empty() || (options.maxSize > 0 && out.size() + compressed.size() + 24 > options.maxSize)) {
+        return "";
+    }
+    appendChunk(out, "IDAT", compressed);
+    appendChunk(out, "IEND", "");
+    return out;
+}
@@ -0,0 +1,118 @@
+#include <OllamaClient/OllamaResilience.h>
+
+#include <algorithm>
+
+// OllamaAdmissionController
+
+bool OllamaAdmissionController::acquire(int maxInFlight, int maxWaitMs) {
+    unique_lock<mutex> lock(mMutex);
+
+    if (maxInFlight > 0 && mInFlight >= maxInFlight) {
+        bool freed = maxWaitMs > 0 && mSlotFreed.wait_for(lock, chrono::milliseconds(maxWaitMs),
+            [this, maxInFlight]() { return mInFlight < maxInFlight; });
+        if (!freed) {
+            mRejected++;
+            return false;
+        }
+    }
+
+    mInFlight++;
+    mAdmitted++;
+    return true;
+}
+
+void OllamaAdmissionController::release() {
+    {
+        lock_guard<mutex> lock(mMutex);
+        mInFlight--;
+    }
+    mSlotFreed.notify_one();
+}
+
+int OllamaAdmissionController::getInFlight() {
+    lock_guard<mutex> lock(mMutex);
+    return mInFlight;
+}
+
+// OllamaCircuitBreaker
+
+bool OllamaCircuitBreaker::allowRequest(const OllamaResilienceOptions& options, unsigned long long& probe) {
+    lock_guard<mutex> lock(mMutex);
+    probe = 0;
+
+    if (mState == Open) {
+        if (chrono::steady_clock::now() - mOpenedAt < chrono::milliseconds(options.breakerOpenMs)) {
+            mRejected++;
+            return false;
+        }
+        // Cool-down elapsed: let probes through to test recovery
+        mState = HalfOpen;
+        mProbesInFlight = 0;
+        mHalfOpenPeriod++;
+    }
+
+    if (mState == HalfOpen) {
+        if (mProbesInFlight >= max(1, options.breakerHalfOpenProbes)) {
+            mRejected++;
+            return false;
+        }
+        mProbesInFlight++;
+        probe = mHalfOpenPeriod;
+    }
+
+    return true;
+}
+
+void OllamaCircuitBreaker::recordSuccess(unsigned long long probe) {
+    lock_guard<mutex> lock(mMutex);
+
+    // A probe from an earlier half-open period no longer counts
+    if (probe != 0 && probe == mHalfOpenPeriod && mState == HalfOpen) {
+        mProbesInFlight--;
+        mState = Closed;
+    }
+    mConsecutiveFailures = 0;
+}
+
+void OllamaCircuitBreaker::recordFailure(const OllamaResilienceOptions& options, unsigned long long probe) {
+    lock_guard<mutex> lock(mMutex);
+
+    if (probe != 0) {
+        // Probe failed: server is still unhealthy
+        if (probe == mHalfOpenPeriod && mState == HalfOpen) {
+            mProbesInFlight--;
+            open();
+        }
+        return;
+    }
+
+    // Admitted before the breaker opened: it is already open or probing
+    if (mState != Closed) {
+        return;
+    }
+
+    mConsecutiveFailures++;
+    if (options.breakerFailureThreshold > 0 && mConsecutiveFailures >= options.breakerFailureThreshold) {
+        open();
+    }
+}
+
+void OllamaCircuitBreaker::open() {
+    mState = Open;
+    mOpenedAt = chrono::steady_clock::now();
+    mConsecutiveFailures = 0;
+}
+
+OllamaCircuitBreaker::State OllamaCircuitBreaker::getState() {
+    lock_guard<mutex> lock(mMutex);
+    return mState;
+}
+
+string OllamaCircuitBreaker::stateToString(State state) {
+    switch (state) {
+        case Closed: return "closed";
+        case Open: return "open";
+        case HalfOpen: return "half-open";
+        default: return "unknown";
+    }
+}
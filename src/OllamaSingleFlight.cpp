@@ -0,0 +1,75 @@
+#include <OllamaClient/OllamaSingleFlight.h>
+#include <OllamaClient/OllamaHash.h>
+
+#include <future>
+
+bool OllamaSingleFlight::join(const string& target, const string& payload, ResultCallback onResult, unsigned long long& key) {
+    lock_guard<mutex> lock(mMutex);
+
+    // Different requests with the same hash probe on to the next key
+    key = OllamaHash::fnv1a(payload, OllamaHash::fnv1a(target));
+    while (true) {
+        auto flight = mFlights.find(key);
+        if (flight == mFlights.end()) {
+            break;
+        }
+        if (flight->second.target == target && *flight->second.payload == payload) {
+            flight->second.waiters.push_back(move(onResult));
+            mMerged++;
+            return false;
+        }
+        key = OllamaHash::fnv1a(&key, sizeof(key), key);
+    }
+
+    Flight& flight = mFlights[key];
+    flight.target = target;
+    flight.payload = &payload;
+    flight.waiters.push_back(move(onResult));
+    mSent++;
+    return true;
+}
+
+void OllamaSingleFlight::complete(unsigned long long key, const string& result) {
+    vector<ResultCallback> waiters;
+    {
+        lock_guard<mutex> lock(mMutex);
+        auto flight = mFlights.find(key);
+        if (flight == mFlights.end()) {
+            return;
+        }
+        waiters.swap(flight->second.waiters);
+        mFlights.erase(flight);
+    }
+
+    for (ResultCallback& waiter : waiters) {
+        waiter(result);
+    }
+}
+
+string OllamaSingleFlight::run(const string& target, const string& payload, function<string()> send) {
+    shared_ptr<promise<string>> result = make_shared<promise<string>>();
+    future<string> pending = result->get_future();
+
+    unsigned long long key = 0;
+    if (join(target, payload, [result](const string& value) { result->set_value(value); }, key)) {
+        string value;
+        try {
+            value = send();
+        }
+        catch (const exception& e) {
+            value = "Error: " + string(e.what());
+        }
+        complete(key, value);
+    }
+
+    return pending.get();
+}
+
+OllamaSingleFlightStats OllamaSingleFlight::getStats() {
+    OllamaSingleFlightStats stats;
+    stats.sent = mSent;
+    stats.merged = mMerged;
+    lock_guard<mutex> lock(mMutex);
+    stats.inFlight = mFlights.size();
+    return stats;
+}
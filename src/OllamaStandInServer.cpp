@@ -0,0 +1,234 @@
+#include <OllamaClient/OllamaStandInServer.h>
+
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+// Windows specific includes - prevent winsock.h inclusion
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#pragma comment(lib, "ws2_32.lib")
+
+static string statusText(int statusCode) {
+    switch (statusCode) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "Status";
+    }
+}
+
+OllamaStandInServer::OllamaStandInServer(Handler handler)
+    : mHandler(handler), mListenSocket(static_cast<uintptr_t>(INVALID_SOCKET))
+{
+}
+
+OllamaStandInServer::~OllamaStandInServer() {
+    stop();
+}
+
+bool OllamaStandInServer::start(int port) {
+    if (mRunning) {
+        return true;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        return false;
+    }
+
+    SOCKET listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSocket == INVALID_SOCKET) {
+        WSACleanup();
+        return false;
+    }
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<unsigned short>(port));
+
+    if (bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+        listen(listenSocket, SOMAXCONN) == SOCKET_ERROR) {
+        closesocket(listenSocket);
+        WSACleanup();
+        return false;
+    }
+
+    // Find out which port was assigned when port 0 was requested
+    int addressSize = sizeof(address);
+    getsockname(listenSocket, reinterpret_cast<sockaddr*>(&address), &addressSize);
+    mPort = ntohs(address.sin_port);
+
+    mListenSocket = static_cast<uintptr_t>(listenSocket);
+    mRunning = true;
+    mAcceptThread = thread([this]() { acceptLoop(); });
+    return true;
+}
+
+void OllamaStandInServer::stop() {
+    if (!mRunning.exchange(false)) {
+        return;
+    }
+
+    // Closing the listening socket makes the blocked accept() fail
+    closesocket(static_cast<SOCKET>(mListenSocket));
+    if (mAcceptThread.joinable()) {
+        mAcceptThread.join();
+    }
+    mListenSocket = static_cast<uintptr_t>(INVALID_SOCKET);
+
+    // Wake up connection threads blocked in recv; each closes its own socket
+    vector<thread> connectionThreads;
+    {
+        lock_guard<mutex> lock(mConnectionsMutex);
+        for (uintptr_t connection : mConnections) {
+            shutdown(static_cast<SOCKET>(connection), SD_BOTH);
+        }
+        connectionThreads.swap(mConnectionThreads);
+    }
+    for (thread& connectionThread : connectionThreads) {
+        connectionThread.join();
+    }
+
+    WSACleanup();
+}
+
+void OllamaStandInServer::acceptLoop() {
+    while (mRunning) {
+        SOCKET connection = accept(static_cast<SOCKET>(mListenSocket), nullptr, nullptr);
+        if (connection == INVALID_SOCKET) {
+            continue;
+        }
+
+        // Responses are small and latency matters more than packet count
+        int noDelay = 1;
+        setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+        lock_guard<mutex> lock(mConnectionsMutex);
+        if (!mRunning) {
+            closesocket(connection);
+            break;
+        }
+        mConnections.push_back(static_cast<uintptr_t>(connection));
+        mConnectionThreads.emplace_back([this, connection]() { serveConnection(static_cast<uintptr_t>(connection)); });
+    }
+}
+
+bool OllamaStandInServer::sendAll(uintptr_t socketHandle, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        int result = send(static_cast<SOCKET>(socketHandle), data.data() + sent, static_cast<int>(data.size() - sent), 0);
+        if (result <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+void OllamaStandInServer::serveConnection(uintptr_t socketHandle) {
+    SOCKET connection = static_cast<SOCKET>(socketHandle);
+    string buffer;
+    char readBuffer[16384];
+
+    auto readMore = [&]() {
+        int received = recv(connection, readBuffer, sizeof(readBuffer), 0);
+        if (received <= 0) {
+            return false;
+        }
+        buffer.append(readBuffer, static_cast<size_t>(received));
+        return true;
+    };
+
+    bool keepAlive = true;
+    while (mRunning && keepAlive) {
+        // Request line and headers
+        size_t headerEnd;
+        bool connected = true;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == string::npos && (connected = readMore())) {}
+        if (!connected) {
+            break;
+        }
+
+        string headers = buffer.substr(0, headerEnd);
+        string lowerHeaders = headers;
+        transform(lowerHeaders.begin(), lowerHeaders.end(), lowerHeaders.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+
+        istringstream requestLine(headers.substr(0, headers.find("\r\n")));
+        string method, path;
+        requestLine >> method >> path;
+
+        size_t contentLength = 0;
+        size_t lengthPos = lowerHeaders.find("\r\ncontent-length:");
+        if (lengthPos != string::npos) {
+            contentLength = static_cast<size_t>(strtoull(headers.c_str() + lengthPos + 17, nullptr, 10));
+        }
+        keepAlive = lowerHeaders.find("\r\nconnection: close") == string::npos;
+
+        // Body
+        size_t bodyStart = headerEnd + 4;
+        while (buffer.size() < bodyStart + contentLength && (connected = readMore())) {}
+        if (!connected) {
+            break;
+        }
+        string body = buffer.substr(bodyStart, contentLength);
+        buffer.erase(0, bodyStart + contentLength);
+        mRequestCount++;
+
+        Response response = mHandler(method, path, body);
+
+        ostringstream head;
+        head << "HTTP/1.1 " << response.statusCode << " " << statusText(response.statusCode) << "\r\n"
+            << "Content-Type: " << response.contentType << "\r\n"
+            << "Connection: " << (keepAlive ? "keep-alive" : "close") << "\r\n";
+
+        bool ok = true;
+        if (response.chunks.size() <= 1) {
+            Chunk chunk = response.chunks.empty() ? Chunk{ 0.0, "" } : response.chunks[0];
+            this_thread::sleep_for(chrono::duration<double, milli>(chunk.delayMs));
+            head << "Content-Length: " << chunk.data.size() << "\r\n\r\n" << chunk.data;
+            ok = sendAll(socketHandle, head.str());
+        }
+        else {
+            // Streamed response: headers go out with the first chunk, like a server that
+            // only answers once the first token exists
+            head << "Transfer-Encoding: chunked\r\n\r\n";
+            string pending = head.str();
+            for (size_t i = 0; i < response.chunks.size() && ok; i++) {
+                const Chunk& chunk = response.chunks[i];
+                this_thread::sleep_for(chrono::duration<double, milli>(chunk.delayMs));
+                if (chunk.data.empty()) {
+                    continue;   // An empty chunk would end the body early
+                }
+
+                ostringstream encoded;
+                encoded << hex << chunk.data.size() << "\r\n" << chunk.data << "\r\n";
+                pending += encoded.str();
+                ok = sendAll(socketHandle, pending);
+                pending.clear();
+            }
+            ok = ok && sendAll(socketHandle, pending + "0\r\n\r\n");
+        }
+
+        if (!ok) {
+            break;
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(mConnectionsMutex);
+        mConnections.erase(remove(mConnections.begin(), mConnections.end(), socketHandle), mConnections.end());
+    }
+    closesocket(connection);
+}
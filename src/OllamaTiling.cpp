@@ -0,0 +1,48 @@
+#include <OllamaClient/OllamaTiling.h>
+
+#include <algorithm>
+
+vector<int> OllamaTiler::computeOffsets(int length, int tileLength, int overlap) {
+    vector<int> offsets;
+    if (length <= 0) {
+        return offsets;
+    }
+
+    tileLength = max(1, min(tileLength, length));
+    int step = max(1, tileLength - max(0, overlap));
+
+    // Fewest tiles that cover the length with at least the requested overlap,
+    // spread evenly so the extra overlap is shared instead of piling up at the edge
+    int count = 1;
+    if (length > tileLength) {
+        count = 1 + (length - tileLength + step - 1) / step;
+    }
+
+    for (int i = 0; i < count; i++) {
+        long long offset = count > 1 ? static_cast<long long>(length - tileLength) * i / (count - 1) : 0;
+        offsets.push_back(static_cast<int>(offset));
+    }
+
+    return offsets;
+}
+
+vector<OllamaTileResult> OllamaTiler::computeTiles(int width, int height, const OllamaTileOptions& options) {
+    vector<OllamaTileResult> tiles;
+    vector<int> columns = computeOffsets(width, options.tileWidth, options.overlap);
+    vector<int> rows = computeOffsets(height, options.tileHeight, options.overlap);
+
+    for (size_t row = 0; row < rows.size(); row++) {
+        for (size_t column = 0; column < columns.size(); column++) {
+            OllamaTileResult tile;
+            tile.x = columns[column];
+            tile.y = rows[row];
+            tile.width = max(1, min(options.tileWidth, width));
+            tile.height = max(1, min(options.tileHeight, height));
+            tile.row = static_cast<int>(row);
+            tile.column = static_cast<int>(column);
+            tiles.push_back(tile);
+        }
+    }
+
+    return tiles;
+}
@@ -0,0 +1,411 @@
+#include <OllamaClient/OllamaTrace.h>
+#include <OllamaClient/OllamaClientBase.h>
+#include <OllamaClient/OllamaHash.h>
+
+#include <map>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <condition_variable>
+#include <cmath>
+#include <cstring>
+
+static const char kTraceMagic[] = "OLTR";
+static const unsigned char kTraceVersion = 1;
+static const char kBlobPrefix[] = "\"@blob:";
+
+// Seed of the second hash that confirms a blob id match (any value other than the FNV offset basis)
+static const unsigned long long kFingerprintSeed = 0x9E3779B97F4A7C15ULL;
+
+// Varint helpers (unsigned LEB128)
+static void appendVarint(string& out, unsigned long long value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+static bool readVarint(const string& in, size_t& pos, unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; pos < in.size() && shift < 64; shift += 7) {
+        unsigned char byte = static_cast<unsigned char>(in[pos++]);
+        value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool readBytes(const string& in, size_t& pos, string& out) {
+    unsigned long long length = 0;
+    if (!readVarint(in, pos, length) || length > in.size() - pos) {
+        return false;
+    }
+    out.assign(in, pos, static_cast<size_t>(length));
+    pos += static_cast<size_t>(length);
+    return true;
+}
+
+static bool readFile(const string& path, string& contents) {
+    ifstream file(path, ios::binary);
+    if (!file) {
+        return false;
+    }
+    contents.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    return true;
+}
+
+// Calls onRecord(type, payload) for every record; false if the header is invalid
+template<typename Callback>
+static bool forEachRecord(const string& contents, Callback onRecord) {
+    if (contents.size() < 5 || contents.compare(0, 4, kTraceMagic) != 0 || static_cast<unsigned char>(contents[4]) != kTraceVersion) {
+        return false;
+    }
+
+    size_t pos = 5;
+    while (pos < contents.size()) {
+        char type = contents[pos++];
+        string payload;
+        if (!readBytes(contents, pos, payload)) {
+            break;  // Truncated tail record (e.g. the process died mid-write)
+        }
+        onRecord(type, payload);
+    }
+    return true;
+}
+
+// OllamaTraceRecorder
+
+OllamaTraceRecorder::~OllamaTraceRecorder() {
+    close();
+}
+
+bool OllamaTraceRecorder::open(const string& path) {
+    lock_guard<mutex> lock(mMutex);
+    if (mFile.is_open()) {
+        mFile.close();
+    }
+    mBlobs.clear();
+    mRecordCount = 0;
+    mDedupedImages = 0;
+
+    // When continuing a trace, remember the stored blobs so images keep being deduplicated
+    string existing;
+    if (readFile(path, existing) && !existing.empty()) {
+        bool valid = forEachRecord(existing, [this](char type, const string& payload) {
+            if (type == 'B' && payload.size() >= 9) {
+                unsigned long long id = 0;
+                for (int i = 7; i >= 0; i--) {
+                    id = (id << 8) | static_cast<unsigned char>(payload[i]);
+                }
+                string bytes = payload.substr(9);
+                mBlobs[id] = fingerprint(payload[8] == 1 ?
+                    OllamaClientBase::base64_encode(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size()) : bytes);
+            }
+            else if (type == 'E') {
+                mRecordCount++;
+            }
+        });
+        if (!valid) {
+            return false;   // Not a trace file; refuse to append to it
+        }
+    }
+
+    mFile.open(path, ios::binary | ios::app);
+    if (!mFile) {
+        return false;
+    }
+
+    if (existing.empty()) {
+        mFile.write(kTraceMagic, 4);
+        mFile.put(static_cast<char>(kTraceVersion));
+        mFile.flush();
+    }
+    return true;
+}
+
+void OllamaTraceRecorder::close() {
+    lock_guard<mutex> lock(mMutex);
+    if (mFile.is_open()) {
+        mFile.close();
+    }
+}
+
+bool OllamaTraceRecorder::isOpen() {
+    lock_guard<mutex> lock(mMutex);
+    return mFile.is_open();
+}
+
+double OllamaTraceRecorder::nowMs() {
+    return chrono::duration<double, milli>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+pair<size_t, unsigned long long> OllamaTraceRecorder::fingerprint(const string& image) {
+    return make_pair(image.size(), OllamaHash::fnv1a(image, kFingerprintSeed));
+}
+
+void OllamaTraceRecorder::writeRecord(char type, const string& payload) {
+    string header(1, type);
+    appendVarint(header, payload.size());
+    mFile.write(header.data(), static_cast<streamsize>(header.size()));
+    mFile.write(payload.data(), static_cast<streamsize>(payload.size()));
+}
+
+void OllamaTraceRecorder::record(const OllamaTraceEntry& entry) {
+    lock_guard<mutex> lock(mMutex);
+    if (!mFile.is_open()) {
+        return;
+    }
+
+    // Replace every string inside "images":[...] with a blob reference
+    const string& request = entry.request;
+    const string imagesKey = "\"images\":[";
+    string stripped;
+    stripped.reserve(min(request.size(), static_cast<size_t>(4096)));
+
+    size_t pos = 0;
+    size_t found;
+    while ((found = request.find(imagesKey, pos)) != string::npos) {
+        size_t cursor = found + imagesKey.size();
+        stripped.append(request, pos, cursor - pos);
+
+        while (cursor < request.size() && request[cursor] != ']') {
+            if (request[cursor] != '"') {
+                stripped += request[cursor++];
+                continue;
+            }
+
+            // Base64 contains no escapes, so the next quote ends the image
+            size_t end = request.find('"', cursor + 1);
+            if (end == string::npos) {
+                break;
+            }
+            string image = request.substr(cursor + 1, end - cursor - 1);
+            unsigned long long id = OllamaHash::fnv1a(image);
+            pair<size_t, unsigned long long> print = fingerprint(image);
+
+            // Probe past ids taken by other images with the same hash
+            auto stored = mBlobs.find(id);
+            while (stored != mBlobs.end() && stored->second != print) {
+                stored = mBlobs.find(++id);
+            }
+
+            if (stored == mBlobs.end()) {
+                mBlobs[id] = print;
+
+                // Store the decoded bytes when the base64 round-trips exactly (25% smaller)
+                string decoded = OllamaClientBase::base64_decode(image);
+                bool binary = !decoded.empty() &&
+                    OllamaClientBase::base64_encode(reinterpret_cast<const unsigned char*>(decoded.data()), decoded.size()) == image;
+
+                string blob;
+                for (int i = 0; i < 8; i++) {
+                    blob += static_cast<char>((id >> (8 * i)) & 0xFF);
+                }
+                blob += static_cast<char>(binary ? 1 : 0);
+                blob += binary ? decoded : image;
+                writeRecord('B', blob);
+            }
+            else {
+                mDedupedImages++;
+            }
+
+            stripped += kBlobPrefix + OllamaHash::toHex(id) + "\"";
+            cursor = end + 1;
+        }
+        pos = cursor;
+    }
+    stripped.append(request, pos, string::npos);
+
+    string exchange;
+    appendVarint(exchange, static_cast<unsigned long long>(max(0.0, entry.arrivalMs) * 1000.0));
+    appendVarint(exchange, static_cast<unsigned long long>(max(0.0, entry.latencyMs) * 1000.0));
+    appendVarint(exchange, static_cast<unsigned long long>(max(0, entry.statusCode)));
+    appendVarint(exchange, stripped.size());
+    exchange += stripped;
+    appendVarint(exchange, entry.response.size());
+    exchange += entry.response;
+    writeRecord('E', exchange);
+
+    mFile.flush();
+    mRecordCount++;
+}
+
+// OllamaTraceReader
+
+bool OllamaTraceReader::read(const string& path, vector<OllamaTraceEntry>& entries, string* error) {
+    string contents;
+    if (!readFile(path, contents)) {
+        if (error) *error = "Error: Could not open trace " + path;
+        return false;
+    }
+
+    map<string, string> blobs;   // Hex hash -> base64 image
+    entries.clear();
+
+    bool valid = forEachRecord(contents, [&blobs, &entries](char type, const string& payload) {
+        if (type == 'B' && payload.size() >= 9) {
+            unsigned long long hash = 0;
+            for (int i = 7; i >= 0; i--) {
+                hash = (hash << 8) | static_cast<unsigned char>(payload[i]);
+            }
+            string bytes = payload.substr(9);
+            blobs[OllamaHash::toHex(hash)] = payload[8] == 1 ?
+                OllamaClientBase::base64_encode(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size()) : bytes;
+        }
+        else if (type == 'E') {
+            size_t pos = 0;
+            unsigned long long arrivalUs = 0, latencyUs = 0, statusCode = 0;
+            string request;
+            OllamaTraceEntry entry;
+            if (!readVarint(payload, pos, arrivalUs) || !readVarint(payload, pos, latencyUs) ||
+                !readVarint(payload, pos, statusCode) || !readBytes(payload, pos, request) ||
+                !readBytes(payload, pos, entry.response)) {
+                return;
+            }
+
+            // Restore blob references
+            size_t blobPrefixSize = strlen(kBlobPrefix);
+            size_t cursor = 0;
+            size_t found;
+            while ((found = request.find(kBlobPrefix, cursor)) != string::npos) {
+                entry.request.append(request, cursor, found - cursor);
+                auto blob = blobs.find(request.substr(found + blobPrefixSize, 16));
+                entry.request += "\"" + (blob != blobs.end() ? blob->second : string()) + "\"";
+                cursor = found + blobPrefixSize + 17;
+            }
+            entry.request.append(request, cursor, string::npos);
+
+            entry.arrivalMs = arrivalUs / 1000.0;
+            entry.latencyMs = latencyUs / 1000.0;
+            entry.statusCode = static_cast<int>(statusCode);
+            entries.push_back(move(entry));
+        }
+    });
+
+    if (!valid) {
+        if (error) *error = "Error: " + path + " is not a trace file";
+        return false;
+    }
+
+    stable_sort(entries.begin(), entries.end(), [](const OllamaTraceEntry& a, const OllamaTraceEntry& b) {
+        return a.arrivalMs < b.arrivalMs;
+    });
+    return true;
+}
+
+// OllamaReplayReport
+
+double OllamaReplayReport::getMeanLatencyMs() const {
+    if (latenciesMs.empty()) return 0.0;
+    double sum = 0.0;
+    for (double latency : latenciesMs) sum += latency;
+    return sum / latenciesMs.size();
+}
+
+double OllamaReplayReport::getPercentileLatencyMs(double percentile) const {
+    if (latenciesMs.empty()) return 0.0;
+    vector<double> sorted = latenciesMs;
+    sort(sorted.begin(), sorted.end());
+    size_t rank = static_cast<size_t>(ceil(percentile / 100.0 * sorted.size()));
+    return sorted[min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+// OllamaTraceReplayer
+
+OllamaReplayReport OllamaTraceReplayer::replay(OllamaClientBase& client, const vector<OllamaTraceEntry>& entries, const OllamaReplayOptions& options) {
+    OllamaReplayReport report;
+    size_t count = options.maxRequests > 0 ? min(options.maxRequests, entries.size()) : entries.size();
+    if (count == 0) {
+        return report;
+    }
+
+    struct ReplayState {
+        mutex stateMutex;
+        condition_variable completedChanged;
+        size_t completed = 0;
+        size_t errors = 0;
+        vector<double> latenciesMs;
+    };
+    shared_ptr<ReplayState> state = make_shared<ReplayState>();
+    state->latenciesMs.resize(count);
+
+    auto start = chrono::steady_clock::now();
+    double firstArrivalMs = entries[0].arrivalMs;
+
+    for (size_t i = 0; i < count; i++) {
+        double offsetMs = options.speed > 0.0 ? (entries[i].arrivalMs - firstArrivalMs) / options.speed : 0.0;
+        auto scheduled = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, milli>(offsetMs));
+        this_thread::sleep_until(scheduled);
+
+        auto sentAt = chrono::steady_clock::now();
+        report.maxDispatchLagMs = max(report.maxDispatchLagMs, chrono::duration<double, milli>(sentAt - scheduled).count());
+        report.traceDurationMs = offsetMs;
+
+        client.sendRawRequest(entries[i].request, [state, i, sentAt](const string& result, void *) {
+            double latencyMs = chrono::duration<double, milli>(chrono::steady_clock::now() - sentAt).count();
+            lock_guard<mutex> lock(state->stateMutex);
+            state->latenciesMs[i] = latencyMs;
+            if (OllamaClientBase::isErrorResult(result)) {
+                state->errors++;
+            }
+            state->completed++;
+            state->completedChanged.notify_all();
+        }, nullptr);
+        report.sent++;
+    }
+
+    unique_lock<mutex> lock(state->stateMutex);
+    state->completedChanged.wait(lock, [&state, count]() { return state->completed == count; });
+
+    report.wallClockMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    report.throughput = report.wallClockMs > 0.0 ? count / (report.wallClockMs / 1000.0) : 0.0;
+    report.errors = state->errors;
+    report.latenciesMs = state->latenciesMs;
+    return report;
+}
+
+OllamaStandInServer::Handler OllamaTraceReplayer::makeStandInHandler(const vector<OllamaTraceEntry>& entries, double speed) {
+    struct Recorded {
+        string response;
+        double latencyMs;
+        int statusCode;
+    };
+
+    struct HandlerState {
+        mutex stateMutex;
+        map<unsigned long long, vector<Recorded>> byRequest;
+        map<unsigned long long, size_t> nextIndex;
+    };
+
+    shared_ptr<HandlerState> state = make_shared<HandlerState>();
+    for (const OllamaTraceEntry& entry : entries) {
+        state->byRequest[OllamaHash::fnv1a(entry.request)].push_back({ entry.response, entry.latencyMs, entry.statusCode });
+    }
+
+    return [state, speed](const string&, const string&, const string& body) {
+        OllamaStandInServer::Response response;
+        Recorded recorded;
+        {
+            lock_guard<mutex> lock(state->stateMutex);
+            unsigned long long hash = OllamaHash::fnv1a(body);
+            auto match = state->byRequest.find(hash);
+            if (match == state->byRequest.end()) {
+                response.statusCode = 404;
+                response.chunks.push_back({ 0.0, "{\"error\":\"request not found in trace\"}" });
+                return response;
+            }
+
+            // Identical requests get their recorded responses in turn
+            size_t& next = state->nextIndex[hash];
+            recorded = match->second[next++ % match->second.size()];
+        }
+
+        // A recorded failure without a response is served as 503
+        response.statusCode = recorded.statusCode > 0 ? recorded.statusCode : 503;
+        response.chunks.push_back({ speed > 0.0 ? recorded.latencyMs / speed : 0.0, recorded.response });
+        return response;
+    };
+}